@@ -31,6 +31,12 @@
 #include <cm4.h>
 #include <sys_clock.h>
 #include <syscall.h>
+#include <kprobe.h>
+#include <ktrace.h>
+#include <kirqlat.h>
+#include <kreplay.h>
+#include <schedule.h>
+#include <kdata.h>
 
 // A global variable to hold the tick count.
 // 'volatile' is crucial here. It tells the compiler that this variable can change
@@ -52,8 +58,8 @@ void __SysTick_init(uint32_t reload)
     // The value is (reload - 1) because the countdown includes 0.
     SYSTICK->LOAD = reload - 1;
 
-    // 3. Set the interrupt priority to the lowest level
-    NVIC_SetPriority(SysTick_IRQn, 15); // 15 is the lowest interrupt value
+    // 3. One above PendSV and SVCall (15): ms_delay works inside a syscall
+    NVIC_SetPriority(SysTick_IRQn, 14);
     
     // 4. Reset the current SYSTICK counter value
     SYSTICK->VAL = 0;
@@ -149,8 +155,20 @@ uint32_t __get__Hour(void){
 void SysTick_Handler(void)
 {
     // This is the core of the tick timer. Every time the interrupt fires,
-    // we increment our global tick counter.
+    // we increment our global tick counter. A tick pended by the latency
+    // test (no COUNTFLAG) only takes the timestamp. CTRL is read on every
+    // entry so that each wrap clears COUNTFLAG and counts once.
+    uint32_t ctrl = __SysTick_ctrl();
+    if(KIRQLAT_ENTRY(SysTick_IRQn) && !(ctrl & SysTick_CTRL_COUNTFLAG_Msk))
+        return;
+    KTRACE_ISR_ENTER(SysTick_IRQn);
+    KPROBE_ENTER(KPROBE_SYSTICK);
     g_sys_tick_count++;
+    kdata_tick(); // ticks and time for readers of the kernel data page
+    KREPLAY_TICK();
+    ksched_tick(); // time slice, sleepers and task accounting
+    KPROBE_EXIT(KPROBE_SYSTICK);
+    KTRACE_ISR_EXIT(SysTick_IRQn);
 }
 
 void __enable_fpu()
@@ -158,17 +176,36 @@ void __enable_fpu()
     // Enable the Floating Point Unit (FPU).
     // Required for any floating point operations.
     SCB->CPACR |= ((0xFUL<<20));
+    // Lazy stacking (also the reset value, set explicitly because the
+    // scheduler relies on it): an exception taken while the FPU is in use
+    // reserves room for S0-S15/FPSCR and clears EXC_RETURN bit 4, the
+    // registers are written only if the handler touches the FPU itself.
+    // Code that never used the FPU gets the short frame.
+    FPU->FPCCR |= FPU_FPCCR_ASPEN_Msk | FPU_FPCCR_LSPEN_Msk;
     
 }
 
+/************************************************************************************
+* __DWT_init(void) 
+* Function enables trace and starts the DWT cycle counter (CYCCNT) from zero.
+* CYCCNT counts core clock cycles and wraps every 2^32 cycles (~23.8 s at 180 MHz).
+**************************************************************************************/
+void __DWT_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
 uint8_t ms_delay(uint32_t delay)
 {
     uint32_t start_tick = g_sys_tick_count;
     // Wait until the elapsed time is greater than or equal to the delay
     while ((g_sys_tick_count - start_tick) < delay)
     {
-        // This is a blocking wait.
+        // This is a blocking wait, the core sleeps until the next interrupt.
         // The subtraction handles the rollover of g_sys_tick_count correctly.
+        SYS_SLEEP_WFI();
     }
     return 0;
 }
@@ -182,7 +219,10 @@ uint32_t wait_until(uint32_t delay)
 {
     // This function behaves identically to ms_delay
     uint32_t start_tick = g_sys_tick_count;
-    while ((g_sys_tick_count - start_tick) < delay) {}
+    while ((g_sys_tick_count - start_tick) < delay)
+    {
+        SYS_SLEEP_WFI();
+    }
     return 0;
 }
 
@@ -191,4 +231,76 @@ void SYS_SLEEP_WFI(void)
     // Wait For Interrupt: a low-power mode where the CPU stops until an
     // interrupt (like SysTick) occurs.
     __WFI();
-}
\ No newline at end of file
+}
+
+/************************************************************************************
+* __SysTick_sleep(uint32_t ticks)
+* Tickless idle. Stretches the current SysTick period over up to ticks periods
+* (LOAD is 24 bits: 93 periods at 180 MHz), enters SYS_SLEEP_WFI and on wakeup
+* adds the periods that passed to g_sys_tick_count. The SysTick interrupt of
+* the last period stays pending and counts itself. Another interrupt ends the
+* sleep early; the counter then restarts with the remainder of the current
+* period, so no time is lost either way. Call with interrupts disabled (they
+* still end WFI); returns the ticks added here.
+* The host keeps the periodic tick and only waits for the next interrupt.
+**************************************************************************************/
+uint32_t __SysTick_sleep(uint32_t ticks)
+{
+#ifndef HOST_SIM
+    uint32_t period = (SYSTICK->LOAD & SysTick_LOAD_RELOAD_Msk) + 1U;
+    uint32_t val, reload, next, done;
+    if (ticks > SysTick_LOAD_RELOAD_Msk / period)
+        ticks = SysTick_LOAD_RELOAD_Msk / period;
+    if (ticks < 2U)
+    {
+        SYS_SLEEP_WFI();
+        return 0;
+    }
+    SYSTICK->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    val = SYSTICK->VAL;
+    if (val == 0U || (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk))
+    {
+        // the tick is due right now, let it happen
+        SYSTICK->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        return 0;
+    }
+    reload = val + (ticks - 1U) * period;
+    SYSTICK->LOAD = reload - 1U;
+    SYSTICK->VAL = 0;
+    SYSTICK->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    __DSB();
+    SYS_SLEEP_WFI();
+    __ISB();
+    SYSTICK->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)
+    {
+        // the whole stretch elapsed; the counter reloaded and kept going
+        uint32_t over = (reload - 1U) - SYSTICK->VAL;
+        next = (over < period) ? period - over : period;
+        done = ticks - 1U;
+    }else
+    {
+        uint32_t elapsed = reload - SYSTICK->VAL;
+        done = elapsed / period;
+        next = period - (elapsed % period);
+    }
+    if (next < 2U)
+    {
+        // a LOAD of 0 stops SysTick: count that boundary now
+        next += period;
+        done++;
+    }
+    SYSTICK->LOAD = next - 1U;
+    SYSTICK->VAL = 0;
+    SYSTICK->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    g_sys_tick_count += done;
+    SYSTICK->LOAD = period - 1U; // taken at the next reload
+    return done;
+#else
+    (void)ticks;
+    host_sim_irq_enable();
+    SYS_SLEEP_WFI();
+    host_sim_irq_disable();
+    return 0;
+#endif
+}
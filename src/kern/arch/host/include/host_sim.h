@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#ifndef __HOST_SIM_H
+#define __HOST_SIM_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+* Host (x86-64 Linux) stand-in for the STM32F446RE register file.
+* The peripheral block is mapped at its real address (PERIPH_BASE) so the
+* layouts in sys_bus_matrix.h are used unchanged. The Cortex-M4 private
+* peripheral bus (SCS, NVIC, SCB, SysTick, DWT) is relocated to HOST_PPB_BASE
+* because 0xE0000000 collides with the sanitizer shadow on x86-64.
+* A background thread plays the part of the NVIC: it models SysTick, TIM2,
+* the RCC ready flags, USART TXE/RXNE and SPI loopback, and calls the real
+* handlers (SysTick_Handler, TIM2_Handler, USART2_Handler ...) when an
+* enabled interrupt becomes pending. PendSV is the exception: it runs on the
+* CPU thread (host_sim_set_cpu) so a task switch happens where the task runs.
+*/
+#include <stdint.h>
+
+#define HOST_PERIPH_BASE    0x40000000UL    /* same as PERIPH_BASE */
+#define HOST_PERIPH_SIZE    0x00030000UL    /* APB1, APB2 and AHB1 up to FLASH */
+#define HOST_PPB_BASE       0x60000000UL    /* stand-in for 0xE0000000 */
+#define HOST_PPB_SIZE       0x00100000UL
+
+#define HOST_SIM_HCLK       180000000UL     /* core clock after __init_sys_clock */
+#define HOST_SIM_APB1_TIMCLK 90000000UL     /* TIM2..TIM7 kernel clock */
+#define HOST_SIM_UART_IDLE  0xFFFFFFFFUL    /* DR value while no byte is in flight */
+
+typedef void (*host_irq_handler_t)(void);
+
+/* reset the register file to the STM32F446 reset values */
+void host_sim_init(void);
+/* start/stop the simulated interrupt source */
+void host_sim_start(void);
+void host_sim_stop(void);
+
+/* replace (or install) the handler for an exception/IRQ number */
+void host_sim_set_handler(int32_t irqn, host_irq_handler_t fn);
+/* make an IRQ pending exactly like NVIC_SetPendingIRQ / ICSR would */
+void host_sim_irq_raise(int32_t irqn);
+/* run every pending and enabled handler now, from the calling thread */
+void host_sim_irq_poll(void);
+
+/* PRIMASK stand-in: blocks the simulated interrupt source (nests) */
+void host_sim_irq_disable(void);
+void host_sim_irq_enable(void);
+
+/*
+* The calling thread now plays the CPU: PendSV is delivered to it (SIGUSR1)
+* and taken when its PRIMASK depth is 0. Used by the host scheduler port.
+*/
+void host_sim_set_cpu(void);
+/* 1 while the calling thread runs a handler, the IPSR != 0 of the host build */
+uint32_t host_sim_in_handler(void);
+/* "svc #no": frame holds r0-r3 (then r12, lr, pc, xpsr), results come back in it.
+   A handler that sets the pc slot to HOST_SIM_SVC_RESTART is called again (the
+   target rewinds the stacked pc onto the svc), after the pending PendSV */
+#define HOST_SIM_SVC_RESTART    1U
+void host_sim_svc(uint32_t no, uintptr_t *frame);
+/* for SVCall_Handler: the frame and number of the svc being taken */
+uintptr_t *host_sim_svc_args(uint32_t *no);
+
+/* WFI stand-in: sleeps until the next simulated interrupt or 1 ms */
+void host_sim_wfi(void);
+
+/* feed received bytes into a USART, they arrive through Uart_isr */
+void host_sim_uart_rx(void *usart, const uint8_t *data, uint32_t len);
+/* bytes fed with host_sim_uart_rx that Uart_isr has not taken yet */
+uint32_t host_sim_uart_rx_pending(void *usart);
+/* copy out bytes the kernel transmitted on a USART */
+uint32_t host_sim_uart_tx(void *usart, uint8_t *data, uint32_t len);
+/* echo every transmitted byte of a USART to a host file descriptor (-1 = off) */
+void host_sim_uart_attach(void *usart, int fd);
+
+/* nanoseconds on CLOCK_MONOTONIC */
+uint64_t host_sim_ns(void);
+
+/* kernel bring-up on the host (host_boot.c): __sys_init without board parts */
+void host_sys_init(void);
+/* wait until the console USART has sent everything queued */
+void host_console_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __HOST_SIM_H */
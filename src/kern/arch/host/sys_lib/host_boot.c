@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <host_sim.h>
+#include <cm4.h>
+#include <sys_clock.h>
+#include <sys_usart.h>
+#include <serial_lin.h>
+#include <timer.h>
+#include <UsartRingBuffer.h>
+#include <system_config.h>
+#include <kconsole.h>
+#include <kwork.h>
+#include <kring.h>
+#include <vfs.h>
+#include <kdata.h>
+#include <kprobe.h>
+#include <kprof.h>
+#include <ktrace.h>
+#include <kstrace.h>
+#include <kirqlat.h>
+#include <kboot.h>
+#include <kstack.h>
+#include <kreplay.h>
+#include <thread.h>
+#include <schedule.h>
+
+extern UART_HandleTypeDef huart6;
+
+/*
+* Host counterpart of __sys_init: the same driver bring-up sequence, without
+* the board-only parts (FPU enable, MCU information, RTC).
+*/
+void host_sys_init(void)
+{
+	__DWT_init();
+	KBOOT_STAMP(KBOOT_RESET);
+	__init_sys_clock();
+	__ISB();
+	NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);
+	kdata_init(); //time fields of the kernel data page, refreshed by SysTick
+	__SysTick_init(180000);
+	KBOOT_STAMP(KBOOT_SYSTICK);
+	SerialLin2_init(__CONSOLE,0);
+	KBOOT_STAMP(KBOOT_USART2);
+	SerialLin6_init(&huart6,0);
+	KBOOT_STAMP(KBOOT_USART6);
+	Ringbuf_init(__CONSOLE);
+	Ringbuf_init(&huart6);
+	KBOOT_STAMP(KBOOT_RINGBUF);
+	ConfigTimer2ForSystem();
+	__ISB();
+	KBOOT_STAMP(KBOOT_TIM2);
+	kconsole_init();
+	kworkq_sys_init();
+	kring_sys_init();
+	vfs_sys_init();
+	kprobe_init();
+	kprof_init();
+	ktrace_init();
+	kstrace_init();
+	kirqlat_init();
+	kboot_init();
+	kstack_init();
+	kreplay_init();
+	task_init();
+	ksched_init(); //idle task, PendSV priority; kmain starts the scheduler
+	KBOOT_STAMP(KBOOT_SERVICES);
+}
+
+/* wait until the TXE interrupt has drained the console ring */
+void host_console_flush(void)
+{
+	UART_HandleTypeDef *con = __CONSOLE;
+	while(con->pTxBuffPtr->head != con->pTxBuffPtr->tail)
+	{
+		__WFI();
+	}
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <host_sim.h>
+#include <cm4.h>
+#include <sys_usart.h>
+#include <kstdio.h>
+#include <timer.h>
+#include <UsartRingBuffer.h>
+#include <system_config.h>
+#include <kconsole.h>
+#include <kprof.h>
+#include <kreplay.h>
+
+/*
+* duos_sim: console on USART2 is wired to stdin/stdout. Input arrives through
+* USART2_Handler -> Uart_isr and is run by the kernel console (try "help").
+*/
+int main(void)
+{
+	uint8_t buf[128];
+	uint32_t t0;
+	ssize_t n;
+
+	host_sim_uart_attach(USART2, STDOUT_FILENO);
+	host_sim_start();
+	host_sys_init();
+	kprintf("DUOS host simulation, CPUID %x\n", SCB->CPUID);
+	t0 = __getTime();
+	ms_delay(10);
+	kprintf("SysTick: %d ms elapsed over ms_delay(10), TIM2 %d us\n", __getTime() - t0, getMicroseconds() % 1000);
+	kprintf(KCONSOLE_PROMPT);
+
+	while((n = read(STDIN_FILENO, buf, sizeof(buf))) > 0)
+	{
+		host_sim_uart_rx(USART2, buf, (uint32_t)n);
+		while(host_sim_uart_rx_pending(USART2) || IsDataAvailable(__CONSOLE))
+		{
+			kconsole_wait(0);
+			kprof_poll();
+			kreplay_poll();
+			__WFI();
+		}
+	}
+	kprintf("\n");
+	host_console_flush();
+	host_sim_stop();
+	return 0;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <host_sim.h>
+#include <cm4.h>
+#include <sys_usart.h>
+#include <kreplay.h>
+
+/*
+* duos_replay: replays a .cap file (src/tools/kreplay.py) into USART2 or
+* USART6 through the simulated Uart_isr and prints the kreplay CSV row.
+*
+*   duos_replay capture.cap parser port pattern [speed]
+*/
+static kreplay_cap *load_cap(const char *path, uint32_t *len)
+{
+	FILE *f = fopen(path, "rb");
+	uint8_t hdr[8], rec[6];
+	kreplay_cap *cap = NULL;
+	uint32_t n = 0, max = 0;
+	if(f == NULL) return NULL;
+	if(fread(hdr, 1, 8, f) != 8 || memcmp(hdr, "DUOSCAP1", 8) != 0)
+	{
+		fclose(f);
+		return NULL;
+	}
+	while(fread(rec, 1, 6, f) == 6)
+	{
+		if(n == max)
+		{
+			max = max ? max * 2U : 4096U;
+			cap = realloc(cap, max * sizeof(*cap));
+			if(cap == NULL) break;
+		}
+		cap[n].t_us = (uint32_t)rec[0] | ((uint32_t)rec[1] << 8) | ((uint32_t)rec[2] << 16) | ((uint32_t)rec[3] << 24);
+		cap[n].port = rec[4];
+		cap[n].byte = rec[5];
+		n++;
+	}
+	fclose(f);
+	*len = n;
+	return cap;
+}
+
+int main(int argc, char **argv)
+{
+	kreplay_result res;
+	kreplay_cap *cap;
+	uint32_t len = 0, port, speed;
+	kreplay_parser parser;
+
+	if(argc < 5)
+	{
+		fprintf(stderr, "usage: %s capture.cap wait_for|copy_upto|look_for_frame|getdata 2|6 pattern [speed]\n", argv[0]);
+		return 2;
+	}
+	cap = load_cap(argv[1], &len);
+	if(cap == NULL)
+	{
+		fprintf(stderr, "%s: not a DUOSCAP1 file\n", argv[1]);
+		return 1;
+	}
+	parser = kreplay_parser_by_name(argv[2]);
+	port = (uint32_t)strtoul(argv[3], NULL, 10);
+	speed = (argc > 5) ? (uint32_t)strtoul(argv[5], NULL, 10) : 1U;
+
+	host_sim_uart_attach(USART2, STDOUT_FILENO);
+	host_sim_start();
+	host_sys_init();
+	kreplay_load(cap, len);
+	if(kreplay_run((uint8_t)port, parser, argv[4], speed, &res) != SYS_OK)
+	{
+		fprintf(stderr, "bad parser, port, pattern or speed\n");
+		host_sim_stop();
+		return 2;
+	}
+	kreplay_report(argv[2], (uint8_t)port, speed, &res);
+	host_console_flush();
+	host_sim_stop();
+	free(cap);
+	return 0;
+}
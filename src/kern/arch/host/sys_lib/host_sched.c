@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+* Host port of the scheduler (thread/schedule.c). Every task runs on its own
+* pthread and holds a run semaphore; exactly one of them plays the CPU at any
+* time. PendSV_Handler is taken on that thread (see host_sim_set_cpu): it
+* picks the next task with ksched_switch, posts its semaphore and parks the
+* outgoing thread on its own. Preemption by SysTick therefore arrives as a
+* signal and is deferred while the task is inside __irq_save, like PRIMASK.
+* Task code must keep to the kernel API: a libc lock held across a switch
+* would stall every other task.
+*/
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <host_sim.h>
+#include <schedule.h>
+#include <thread.h>
+
+typedef struct host_task_t
+{
+	pthread_t thread;
+	sem_t run;
+	void (*entry)(void *);
+	void *arg;
+	uint8_t joinable;
+}host_task;
+
+static host_task host_tasks[MAX_TASKS];
+static uint32_t host_task_count;
+
+static void run_wait(host_task *h)
+{
+	while(sem_wait(&h->run) != 0); // EINTR only
+	host_sim_set_cpu();
+}
+
+static void *host_task_main(void *arg)
+{
+	host_task *h = (host_task*)arg;
+	sigset_t set;
+	sigemptyset(&set);
+	sigaddset(&set, SIGUSR1);
+	pthread_sigmask(SIG_UNBLOCK, &set, NULL);
+	run_wait(h);
+	h->entry(h->arg);
+	task_exit();
+	return NULL;
+}
+
+/* the TCB slot decides the host_task: reuse it once the old thread is gone */
+void ksched_port_init_stack(TCB_TypeDef *task, void (*entry)(void *), void *arg)
+{
+	host_task *h = (host_task*)task->arch;
+	if(h == NULL)
+	{
+		if(host_task_count == MAX_TASKS)
+		{
+			fprintf(stderr, "host_sched: out of task threads\n");
+			abort();
+		}
+		h = &host_tasks[host_task_count++];
+		task->arch = h;
+	}else if(h->joinable)
+	{
+		pthread_join(h->thread, NULL);
+		sem_destroy(&h->run);
+	}
+	h->entry = entry;
+	h->arg = arg;
+	sem_init(&h->run, 0, 0);
+	if(pthread_create(&h->thread, NULL, host_task_main, h) != 0)
+	{
+		fprintf(stderr, "host_sched: cannot start task %s\n", task->name);
+		abort();
+	}
+	h->joinable = 1;
+	pthread_setname_np(h->thread, task->name); // shows up in top -H and gdb
+}
+
+void PendSV_Handler(void)
+{
+	TCB_TypeDef *prev = ksched_current, *next;
+	uint8_t done;
+	if(!ksched_running()) return;
+	next = ksched_switch();
+	if(next == prev) return;
+	/* sample before the post: the next task may reuse prev's slot at once */
+	done = prev != NULL && prev->status == TASK_TERMINATED_STATE;
+	sem_post(&((host_task*)next->arch)->run);
+	if(prev == NULL) return; // ksched_port_start: main thread steps aside
+	if(done)
+	{
+		pthread_exit(NULL);
+	}
+	run_wait((host_task*)prev->arch);
+}
+
+void ksched_port_start(void)
+{
+	sigset_t set;
+	sigemptyset(&set);
+	sigaddset(&set, SIGUSR1);
+	pthread_sigmask(SIG_BLOCK, &set, NULL); // main never runs a task, a kick waits for the next CPU
+	host_sim_start();
+	host_sim_set_cpu();
+	ksched_pend(); // taken right here: the first task gets the CPU
+	for(;;)
+	{
+		pause();
+	}
+}
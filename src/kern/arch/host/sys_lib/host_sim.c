@@ -0,0 +1,688 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <host_sim.h>
+#include <cm4.h>
+#include <sys_bus_matrix.h>
+
+#define SIM_EXC_OFFSET  16
+#define SIM_NUM_VECTORS (SIM_EXC_OFFSET + 97)
+#define SIM_POLL_NS     20000UL     /* interrupt source granularity: 20 us */
+#define SIM_MAX_BURST   64          /* ticks caught up per poll before skipping ahead */
+#define SIM_UART_RXQ    4096U
+#define SIM_UART_TXQ    65536U
+
+/*
+* Handlers the kernel may provide. Weak references resolve to NULL when the
+* object that defines a handler is not linked into the host build.
+*/
+extern void SVCall_Handler(void) __attribute__((weak));
+extern void PendSV_Handler(void) __attribute__((weak));
+extern void SysTick_Handler(void) __attribute__((weak));
+extern void TIM2_Handler(void) __attribute__((weak));
+extern void TIM5_Handler(void) __attribute__((weak));
+extern void SPI1_Handler(void) __attribute__((weak));
+extern void USART1_Handler(void) __attribute__((weak));
+extern void USART2_Handler(void) __attribute__((weak));
+extern void USART3_Handler(void) __attribute__((weak));
+extern void USART6_Handler(void) __attribute__((weak));
+
+typedef struct sim_uart_t
+{
+	USART_TypeDef *inst;
+	int32_t irqn;
+	uint8_t rxq[SIM_UART_RXQ];
+	uint32_t rx_head, rx_tail;
+	uint8_t rx_inflight;
+	uint8_t txq[SIM_UART_TXQ];
+	uint32_t tx_head, tx_tail;
+	int fd;
+} sim_uart;
+
+typedef struct sim_timer_t
+{
+	TIM_TypeDef *inst;
+	int32_t irqn;
+	uint64_t base_ns;
+} sim_timer;
+
+static host_irq_handler_t vectors[SIM_NUM_VECTORS];
+static pthread_mutex_t sim_lock;
+static pthread_mutex_t wfi_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wfi_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t sim_thread;
+static volatile int sim_running = 0;
+static uint64_t systick_last_ns;
+/*
+* PendSV runs on the thread that plays the CPU (the running task, it calls
+* host_sim_set_cpu when it gets the CPU), not on the interrupt thread: the interrupt thread sends
+* it SIGUSR1 and the switch happens there once its PRIMASK depth is 0.
+*/
+static __thread uint32_t irq_depth;
+static __thread uint32_t handler_depth;    /* > 0 while this thread runs a handler (IPSR != 0) */
+static __thread uintptr_t *svc_frame;      /* host_sim_svc: what SVCall_Handler reads off the stack */
+static __thread uint32_t svc_no;
+static pthread_t cpu_thread;
+static volatile int cpu_valid = 0;
+static volatile int pendsv_kicked = 0;
+
+static sim_uart uarts[] = {
+	{ .inst = USART1, .irqn = USART1_IRQn, .fd = -1 },
+	{ .inst = USART2, .irqn = USART2_IRQn, .fd = -1 },
+	{ .inst = USART3, .irqn = USART3_IRQn, .fd = -1 },
+	{ .inst = USART6, .irqn = USART6_IRQn, .fd = -1 },
+};
+#define SIM_NUM_UARTS (sizeof(uarts)/sizeof(uarts[0]))
+
+static sim_timer timers[] = {
+	{ .inst = TIM2, .irqn = TIM2_IRQn },
+	{ .inst = TIM5, .irqn = TIM5_IRQn },
+};
+#define SIM_NUM_TIMERS (sizeof(timers)/sizeof(timers[0]))
+
+static void pendsv_take(void);
+
+/* PRIMASK set/clear for the calling thread; a PendSV left pending is taken on the way out */
+static void sim_enter(void)
+{
+	irq_depth++;
+	pthread_mutex_lock(&sim_lock);
+}
+
+static void sim_leave(void)
+{
+	pthread_mutex_unlock(&sim_lock);
+	if(--irq_depth == 0U && cpu_valid)
+	{
+		pendsv_take();
+	}
+}
+
+/*
+* Map the register file before any constructor or kernel code can touch it.
+*/
+static void __attribute__((constructor(101))) host_sim_map(void)
+{
+	pthread_mutexattr_t attr;
+	void *p = mmap((void*)HOST_PERIPH_BASE, HOST_PERIPH_SIZE, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+	void *q = mmap((void*)HOST_PPB_BASE, HOST_PPB_SIZE, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+	if(p != (void*)HOST_PERIPH_BASE || q != (void*)HOST_PPB_BASE)
+	{
+		fprintf(stderr, "host_sim: cannot map register file at 0x%lx/0x%lx\n",
+			HOST_PERIPH_BASE, HOST_PPB_BASE);
+		abort();
+	}
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&sim_lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+	host_sim_init();
+}
+
+uint64_t host_sim_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void host_sim_init(void)
+{
+	sim_enter();
+	memset((void*)HOST_PERIPH_BASE, 0, HOST_PERIPH_SIZE);
+	memset((void*)HOST_PPB_BASE, 0, HOST_PPB_SIZE);
+	/* reset values from RM0390 */
+	RCC->CR = RCC_CR_HSION | RCC_CR_HSIRDY;
+	RCC->PLLCFGR = 0x24003010UL;
+	SCB->CPUID = 0x410FC241UL;
+	for(uint32_t i = 0; i < SIM_NUM_UARTS; i++)
+	{
+		uarts[i].inst->SR = USART_SR_TXE | USART_SR_TC;
+		uarts[i].inst->DR = HOST_SIM_UART_IDLE;
+		uarts[i].rx_head = uarts[i].rx_tail = 0;
+		uarts[i].tx_head = uarts[i].tx_tail = 0;
+		uarts[i].rx_inflight = 0;
+	}
+	SPI1->SR = SPI_SR_TXE;
+	for(uint32_t i = 0; i < SIM_NUM_TIMERS; i++)
+	{
+		timers[i].base_ns = host_sim_ns();
+	}
+	systick_last_ns = host_sim_ns();
+	vectors[SIM_EXC_OFFSET + SVCall_IRQn] = SVCall_Handler;
+	vectors[SIM_EXC_OFFSET + PendSV_IRQn] = PendSV_Handler;
+	vectors[SIM_EXC_OFFSET + SysTick_IRQn] = SysTick_Handler;
+	vectors[SIM_EXC_OFFSET + TIM2_IRQn] = TIM2_Handler;
+	vectors[SIM_EXC_OFFSET + TIM5_IRQn] = TIM5_Handler;
+	vectors[SIM_EXC_OFFSET + SPI1_IRQn] = SPI1_Handler;
+	vectors[SIM_EXC_OFFSET + USART1_IRQn] = USART1_Handler;
+	vectors[SIM_EXC_OFFSET + USART2_IRQn] = USART2_Handler;
+	vectors[SIM_EXC_OFFSET + USART3_IRQn] = USART3_Handler;
+	vectors[SIM_EXC_OFFSET + USART6_IRQn] = USART6_Handler;
+	sim_leave();
+}
+
+void host_sim_set_handler(int32_t irqn, host_irq_handler_t fn)
+{
+	sim_enter();
+	vectors[SIM_EXC_OFFSET + irqn] = fn;
+	sim_leave();
+}
+
+void host_sim_irq_disable(void)
+{
+	sim_enter();
+}
+
+void host_sim_irq_enable(void)
+{
+	sim_leave();
+}
+
+void host_sim_irq_raise(int32_t irqn)
+{
+	sim_enter();
+	if(irqn >= 0)
+	{
+		NVIC->ISPR[((uint32_t)irqn) >> 5UL] |= (1UL << ((uint32_t)irqn & 0x1FUL));
+	}else if(irqn == SysTick_IRQn)
+	{
+		SCB->ICSR |= SCB_ICSR_PENDSTSET_Msk;
+	}else if(irqn == PendSV_IRQn)
+	{
+		SCB->ICSR |= SCB_ICSR_PENDSVSET_Msk;
+	}else if(vectors[SIM_EXC_OFFSET + irqn] != NULL)
+	{
+		/* synchronous exceptions (SVCall, faults) run immediately */
+		handler_depth++;
+		vectors[SIM_EXC_OFFSET + irqn]();
+		handler_depth--;
+	}
+	sim_leave();
+}
+
+/*
+* Clock tree: oscillators and the PLL lock as soon as they are switched on
+* and SWS follows SW, so __init_sys_clock runs to completion.
+*/
+static void rcc_model(void)
+{
+	uint32_t cr = RCC->CR;
+	if(cr & RCC_CR_HSION) cr |= RCC_CR_HSIRDY;
+	if(cr & RCC_CR_HSEON) cr |= RCC_CR_HSERDY;
+	if(cr & RCC_CR_PLLON) cr |= RCC_CR_PLLRDY;
+	RCC->CR = cr;
+	RCC->CFGR = (RCC->CFGR & ~(0x3UL << 2)) | ((RCC->CFGR & RCC_CFGR_SW) << 2);
+}
+
+static void systick_model(uint64_t now)
+{
+	uint64_t period;
+	uint32_t n = 0;
+	if(!(SYSTICK->CTRL & SysTick_CTRL_ENABLE_Msk))
+	{
+		systick_last_ns = now;
+		return;
+	}
+	period = ((uint64_t)(SYSTICK->LOAD & SysTick_LOAD_RELOAD_Msk) + 1ULL) * 1000000000ULL / HOST_SIM_HCLK;
+	if(period == 0) period = 1;
+	while(now - systick_last_ns >= period)
+	{
+		systick_last_ns += period;
+		SYSTICK->CTRL |= SysTick_CTRL_COUNTFLAG_Msk;
+		if(SYSTICK->CTRL & SysTick_CTRL_TICKINT_Msk)
+		{
+			SCB->ICSR |= SCB_ICSR_PENDSTSET_Msk;
+		}
+		if(++n == SIM_MAX_BURST)
+		{
+			systick_last_ns = now;
+			break;
+		}
+	}
+	SYSTICK->VAL = (uint32_t)(((period - (now - systick_last_ns)) * HOST_SIM_HCLK) / 1000000000ULL) & SysTick_VAL_CURRENT_Msk;
+}
+
+static void timer_model(sim_timer *t, uint64_t now)
+{
+	TIM_TypeDef *tim = t->inst;
+	uint64_t tick, counts, arr;
+	if(tim->EGR & TIM_EGR_UG)
+	{
+		tim->EGR = 0;
+		tim->SR |= TIM_SR_UIF;
+		t->base_ns = now;
+	}
+	if(!(tim->CR1 & TIM_CR1_CEN))
+	{
+		t->base_ns = now;
+		return;
+	}
+	tick = ((uint64_t)tim->PSC + 1ULL) * 1000000000ULL / HOST_SIM_APB1_TIMCLK;
+	if(tick == 0) tick = 1;
+	arr = (uint64_t)tim->ARR + 1ULL;
+	counts = (now - t->base_ns) / tick;
+	if(counts >= arr)
+	{
+		tim->SR |= TIM_SR_UIF;
+		if(tim->DIER & TIM_DIER_UIE)
+		{
+			NVIC->ISPR[((uint32_t)t->irqn) >> 5UL] |= (1UL << ((uint32_t)t->irqn & 0x1FUL));
+		}
+		t->base_ns = (counts / arr > SIM_MAX_BURST) ? now : t->base_ns + arr * tick;
+		counts = (now - t->base_ns) / tick;
+	}
+	tim->CNT = (uint32_t)(counts % arr);
+}
+
+static void uart_capture(sim_uart *u, uint8_t c)
+{
+	uint32_t next = (u->tx_head + 1U) % SIM_UART_TXQ;
+	if(next != u->tx_tail)
+	{
+		u->txq[u->tx_head] = c;
+		u->tx_head = next;
+	}
+	if(u->fd >= 0)
+	{
+		ssize_t r = write(u->fd, &c, 1);
+		(void)r;
+	}
+}
+
+static void uart_model(sim_uart *u)
+{
+	USART_TypeDef *us = u->inst;
+	/* a byte written to DR outside the ISR (noIntWrite) */
+	if(!u->rx_inflight && us->DR != HOST_SIM_UART_IDLE)
+	{
+		uart_capture(u, (uint8_t)us->DR);
+		us->DR = HOST_SIM_UART_IDLE;
+	}
+	us->SR |= USART_SR_TXE | USART_SR_TC;
+	if(!u->rx_inflight && u->rx_head != u->rx_tail)
+	{
+		us->DR = u->rxq[u->rx_tail];
+		u->rx_tail = (u->rx_tail + 1U) % SIM_UART_RXQ;
+		us->SR |= USART_SR_RXNE;
+		u->rx_inflight = 1;
+	}
+	if(((us->SR & USART_SR_RXNE) && (us->CR1 & USART_CR1_RXNEIE)) ||
+	   ((us->SR & USART_SR_TXE) && (us->CR1 & USART_CR1_TXEIE)))
+	{
+		NVIC->ISPR[((uint32_t)u->irqn) >> 5UL] |= (1UL << ((uint32_t)u->irqn & 0x1FUL));
+	}
+}
+
+/* bookkeeping once a USART handler returned: consumed RX and fresh TX */
+static void uart_after_isr(int32_t irqn)
+{
+	for(uint32_t i = 0; i < SIM_NUM_UARTS; i++)
+	{
+		sim_uart *u = &uarts[i];
+		if(u->irqn != irqn) continue;
+		if(u->rx_inflight && (u->inst->CR1 & USART_CR1_RXNEIE))
+		{
+			u->inst->SR &= ~USART_SR_RXNE;
+			u->inst->DR = HOST_SIM_UART_IDLE;
+			u->rx_inflight = 0;
+		}
+		if(!u->rx_inflight && u->inst->DR != HOST_SIM_UART_IDLE)
+		{
+			uart_capture(u, (uint8_t)u->inst->DR);
+			u->inst->DR = HOST_SIM_UART_IDLE;
+		}
+		/* the line is idle again: next RX byte or TXE right away */
+		uart_model(u);
+	}
+}
+
+static uint32_t exc_priority(int32_t irqn)
+{
+	if(irqn >= 0)
+	{
+		return NVIC->IP[irqn];
+	}
+	return SCB->SHP[(((uint32_t)irqn) & 0xFUL) - 4UL];
+}
+
+/* highest-priority pending and enabled exception, or 0 when none */
+static int32_t next_pending(int32_t *irqn)
+{
+	int32_t best = 0, found = 0;
+	uint32_t best_prio = 0x100;
+	if((SCB->ICSR & SCB_ICSR_PENDSVSET_Msk) && !cpu_valid)
+	{
+		best = PendSV_IRQn; best_prio = exc_priority(PendSV_IRQn); found = 1;
+	}
+	if((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) && (!found || exc_priority(SysTick_IRQn) < best_prio))
+	{
+		best = SysTick_IRQn; best_prio = exc_priority(SysTick_IRQn); found = 1;
+	}
+	for(uint32_t w = 0; w < 8; w++)
+	{
+		uint32_t bits = NVIC->ISPR[w] & NVIC->ISER[w];
+		while(bits)
+		{
+			int32_t n = (int32_t)(w * 32U + (uint32_t)__builtin_ctz(bits));
+			bits &= bits - 1U;
+			if(n >= SIM_NUM_VECTORS - SIM_EXC_OFFSET) continue;
+			if(!found || exc_priority(n) < best_prio)
+			{
+				best = n; best_prio = exc_priority(n); found = 1;
+			}
+		}
+	}
+	*irqn = best;
+	return found;
+}
+
+uint32_t host_sim_in_handler(void)
+{
+	return handler_depth != 0U;
+}
+
+/*
+* SVCall is not run under sim_lock: a syscall may wait for a device
+* interrupt (a full console ring), which the simulator thread has to be
+* able to deliver, as USART preempts SVCall on the core. PendSV stays
+* behind it until the handler returns.
+*/
+void host_sim_svc(uint32_t no, uintptr_t *frame)
+{
+	host_irq_handler_t fn = vectors[SIM_EXC_OFFSET + SVCall_IRQn];
+	do
+	{
+		frame[6] = 0;
+		svc_frame = frame;
+		svc_no = no;
+		irq_depth++;
+		handler_depth++;
+		if(fn != NULL) fn();
+		handler_depth--;
+		if(--irq_depth == 0U && cpu_valid)
+		{
+			pendsv_take();
+		}
+	}while(frame[6] == HOST_SIM_SVC_RESTART);
+}
+
+uintptr_t *host_sim_svc_args(uint32_t *no)
+{
+	*no = svc_no;
+	return svc_frame;
+}
+
+static void dispatch(void)
+{
+	int32_t irqn;
+	uint32_t guard = 0;
+	while(next_pending(&irqn) && guard++ < 256U)
+	{
+		host_irq_handler_t fn = vectors[SIM_EXC_OFFSET + irqn];
+		if(irqn == PendSV_IRQn)
+		{
+			SCB->ICSR &= ~SCB_ICSR_PENDSVSET_Msk;
+		}else if(irqn == SysTick_IRQn)
+		{
+			SCB->ICSR &= ~SCB_ICSR_PENDSTSET_Msk;
+		}else
+		{
+			NVIC->ISPR[((uint32_t)irqn) >> 5UL] &= ~(1UL << ((uint32_t)irqn & 0x1FUL));
+			NVIC->IABR[((uint32_t)irqn) >> 5UL] |= (1UL << ((uint32_t)irqn & 0x1FUL));
+		}
+		if(fn != NULL)
+		{
+			handler_depth++;
+			fn();
+			handler_depth--;
+		}
+		if(irqn >= 0)
+		{
+			NVIC->IABR[((uint32_t)irqn) >> 5UL] &= ~(1UL << ((uint32_t)irqn & 0x1FUL));
+			uart_after_isr(irqn);
+		}
+	}
+}
+
+void host_sim_irq_poll(void)
+{
+	uint64_t now = host_sim_ns();
+	sim_enter();
+	rcc_model();
+	systick_model(now);
+	for(uint32_t i = 0; i < SIM_NUM_TIMERS; i++)
+	{
+		timer_model(&timers[i], now);
+	}
+	for(uint32_t i = 0; i < SIM_NUM_UARTS; i++)
+	{
+		uart_model(&uarts[i]);
+	}
+	SPI1->SR = (SPI1->SR | SPI_SR_TXE | SPI_SR_RXNE) & ~SPI_SR_BSY;
+	dispatch();
+	if(cpu_valid && (SCB->ICSR & SCB_ICSR_PENDSVSET_Msk) && !pendsv_kicked)
+	{
+		pendsv_kicked = 1;
+		pthread_kill(cpu_thread, SIGUSR1);
+	}
+	sim_leave();
+	pthread_mutex_lock(&wfi_lock);
+	pthread_cond_broadcast(&wfi_cond);
+	pthread_mutex_unlock(&wfi_lock);
+}
+
+/*
+* PendSV on the CPU thread: only with PRIMASK clear and never nested, the
+* handler itself runs at depth 1 like any exception handler.
+*/
+static void pendsv_take(void)
+{
+	while(cpu_valid && irq_depth == 0U && pthread_equal(pthread_self(), cpu_thread))
+	{
+		host_irq_handler_t fn;
+		uint32_t pending;
+		irq_depth++;
+		pthread_mutex_lock(&sim_lock);
+		pending = SCB->ICSR & SCB_ICSR_PENDSVSET_Msk;
+		SCB->ICSR &= ~SCB_ICSR_PENDSVSET_Msk;
+		pendsv_kicked = 0;
+		fn = vectors[SIM_EXC_OFFSET + PendSV_IRQn];
+		pthread_mutex_unlock(&sim_lock);
+		if(pending && fn != NULL)
+		{
+			handler_depth++;
+			fn();
+			handler_depth--;
+		}
+		irq_depth--;
+		if(!pending) break;
+	}
+}
+
+static void pendsv_signal(int sig)
+{
+	(void)sig;
+	if(irq_depth == 0U)
+	{
+		pendsv_take();
+	}
+}
+
+void host_sim_set_cpu(void)
+{
+	static int installed = 0;
+	if(!installed)
+	{
+		struct sigaction sa;
+		memset(&sa, 0, sizeof(sa));
+		sa.sa_handler = pendsv_signal;
+		sa.sa_flags = SA_RESTART;
+		sigemptyset(&sa.sa_mask);
+		sigaction(SIGUSR1, &sa, NULL);
+		installed = 1;
+	}
+	sim_enter();
+	cpu_thread = pthread_self();
+	cpu_valid = 1;
+	sim_leave();
+}
+
+static void *sim_main(void *arg)
+{
+	struct timespec ts = { 0, SIM_POLL_NS };
+	(void)arg;
+	while(sim_running)
+	{
+		host_sim_irq_poll();
+		nanosleep(&ts, NULL);
+	}
+	return NULL;
+}
+
+void host_sim_start(void)
+{
+	if(sim_running) return;
+	sim_running = 1;
+	if(pthread_create(&sim_thread, NULL, sim_main, NULL) != 0)
+	{
+		sim_running = 0;
+		fprintf(stderr, "host_sim: cannot start interrupt thread\n");
+		abort();
+	}
+}
+
+void host_sim_stop(void)
+{
+	if(!sim_running) return;
+	sim_running = 0;
+	pthread_join(sim_thread, NULL);
+}
+
+void host_sim_wfi(void)
+{
+	struct timespec ts;
+	if(!sim_running)
+	{
+		host_sim_irq_poll();
+		return;
+	}
+	clock_gettime(CLOCK_REALTIME, &ts);
+	ts.tv_nsec += 1000000L;
+	if(ts.tv_nsec >= 1000000000L)
+	{
+		ts.tv_sec++;
+		ts.tv_nsec -= 1000000000L;
+	}
+	irq_depth++;
+	pthread_mutex_lock(&wfi_lock);
+	pthread_cond_timedwait(&wfi_cond, &wfi_lock, &ts);
+	pthread_mutex_unlock(&wfi_lock);
+	if(--irq_depth == 0U && cpu_valid)
+	{
+		pendsv_take();
+	}
+}
+
+static sim_uart *find_uart(void *usart)
+{
+	for(uint32_t i = 0; i < SIM_NUM_UARTS; i++)
+	{
+		if((void*)uarts[i].inst == usart) return &uarts[i];
+	}
+	return NULL;
+}
+
+void host_sim_uart_rx(void *usart, const uint8_t *data, uint32_t len)
+{
+	sim_uart *u = find_uart(usart);
+	if(u == NULL) return;
+	for(uint32_t i = 0; i < len; i++)
+	{
+		uint32_t next;
+		for(;;)
+		{
+			sim_enter();
+			next = (u->rx_head + 1U) % SIM_UART_RXQ;
+			if(next != u->rx_tail) break;
+			sim_leave();
+			host_sim_wfi();
+		}
+		u->rxq[u->rx_head] = data[i];
+		u->rx_head = next;
+		sim_leave();
+	}
+}
+
+uint32_t host_sim_uart_rx_pending(void *usart)
+{
+	sim_uart *u = find_uart(usart);
+	uint32_t n;
+	if(u == NULL) return 0;
+	sim_enter();
+	n = (u->rx_head + SIM_UART_RXQ - u->rx_tail) % SIM_UART_RXQ + u->rx_inflight;
+	sim_leave();
+	return n;
+}
+
+uint32_t host_sim_uart_tx(void *usart, uint8_t *data, uint32_t len)
+{
+	sim_uart *u = find_uart(usart);
+	uint32_t n = 0;
+	if(u == NULL) return 0;
+	sim_enter();
+	while(n < len && u->tx_tail != u->tx_head)
+	{
+		data[n++] = u->txq[u->tx_tail];
+		u->tx_tail = (u->tx_tail + 1U) % SIM_UART_TXQ;
+	}
+	sim_leave();
+	return n;
+}
+
+void host_sim_uart_attach(void *usart, int fd)
+{
+	sim_uart *u = find_uart(usart);
+	if(u == NULL) return;
+	sim_enter();
+	u->fd = fd;
+	sim_leave();
+}
@@ -39,22 +39,38 @@ extern "C" {
 #ifndef   __COMPILER_BARRIER
   #define __COMPILER_BARRIER()                  asm volatile("":::"memory")
 #endif
+#ifndef HOST_SIM
 #define __DSB()        asm volatile("dsb 0xf":::"memory")
 #define __ISB()        asm volatile("isb 0xf":::"memory")
 #define __DMB()        asm volatile("dmb 0xf":::"memory") 
 #define __NOP()        asm volatile("nop":::"memory")
 #define __NVIC_PRIO_BITS          4U
 #define __WFI()         asm volatile("wfi")
+#else
+/* host build: barriers and WFI map onto the simulator (see host_sim.h) */
+#include <host_sim.h>
+#define __DSB()        __sync_synchronize()
+#define __ISB()        __COMPILER_BARRIER()
+#define __DMB()        __sync_synchronize()
+#define __NOP()        __COMPILER_BARRIER()
+#define __NVIC_PRIO_BITS          4U
+#define __WFI()         host_sim_wfi()
+#endif
 /*
 * This file defines Cortex-M4 processor internal peripherals
 * NVIC, SCB, FPU and so on
 */
 /* Memory mapping of Core Hardware */
-#define SCS_BASE            (0xE000E000UL)                            /*!< System Control Space Base Address */
-#define ITM_BASE            (0xE0000000UL)                            /*!< ITM Base Address */
-#define DWT_BASE            (0xE0001000UL)                            /*!< DWT Base Address */
-#define TPI_BASE            (0xE0040000UL)                            /*!< TPI Base Address */
-#define CoreDebug_BASE      (0xE000EDF0UL)                            /*!< Core Debug Base Address */
+#ifndef HOST_SIM
+#define PPB_BASE            (0xE0000000UL)                            /*!< Private Peripheral Bus Base Address */
+#else
+#define PPB_BASE            HOST_PPB_BASE                             /*!< relocated by the host simulator */
+#endif
+#define SCS_BASE            (PPB_BASE + 0xE000UL)                     /*!< System Control Space Base Address */
+#define ITM_BASE            (PPB_BASE)                                /*!< ITM Base Address */
+#define DWT_BASE            (PPB_BASE + 0x1000UL)                     /*!< DWT Base Address */
+#define TPI_BASE            (PPB_BASE + 0x40000UL)                    /*!< TPI Base Address */
+#define CoreDebug_BASE      (PPB_BASE + 0xEDF0UL)                     /*!< Core Debug Base Address */
 #define SysTick_BASE        (SCS_BASE +  0x0010UL)                    /*!< SysTick Base Address */
 #define NVIC_BASE           (SCS_BASE +  0x0100UL)                    /*!< NVIC Base Address */
 #define SCB_BASE            (SCS_BASE +  0x0D00UL)                    /*!< System Control Block Base Address */
@@ -71,7 +87,7 @@ extern "C" {
 #endif
 
 #define FPU_BASE            (SCS_BASE +  0x0F30UL)                    /*!< Floating Point Unit */
-#define FPU                 ((FPU_Type       *)     FPU_BASE      )   /*!< Floating Point Unit */
+#define FPU                 ((FPU_TypeDef    *)     FPU_BASE      )   /*!< Floating Point Unit */
 
 #define SYSTICK ((SYSTICK_TypeDef*)SysTick_BASE)
 #define NVIC ((NVIC_TypeDef*)NVIC_BASE)
@@ -425,6 +441,46 @@ typedef struct __fpu_t
 
 }FPU_TypeDef;
 
+/*
+* Data Watchpoint and Trace (DWT) Data Structure
+*/
+typedef struct __dwt_t
+{
+  volatile uint32_t CTRL;                   /*!< Offset: 0x000 (R/W)  Control Register */
+  volatile uint32_t CYCCNT;                 /*!< Offset: 0x004 (R/W)  Cycle Count Register */
+  volatile uint32_t CPICNT;                 /*!< Offset: 0x008 (R/W)  CPI Count Register */
+  volatile uint32_t EXCCNT;                 /*!< Offset: 0x00C (R/W)  Exception Overhead Count Register */
+  volatile uint32_t SLEEPCNT;               /*!< Offset: 0x010 (R/W)  Sleep Count Register */
+  volatile uint32_t LSUCNT;                 /*!< Offset: 0x014 (R/W)  LSU Count Register */
+  volatile uint32_t FOLDCNT;                /*!< Offset: 0x018 (R/W)  Folded-instruction Count Register */
+  volatile uint32_t PCSR;                   /*!< Offset: 0x01C (R/ )  Program Counter Sample Register */
+  volatile uint32_t COMP0;                  /*!< Offset: 0x020 (R/W)  Comparator Register 0 */
+  volatile uint32_t MASK0;                  /*!< Offset: 0x024 (R/W)  Mask Register 0 */
+  volatile uint32_t FUNCTION0;              /*!< Offset: 0x028 (R/W)  Function Register 0 */
+}DWT_Type;
+
+/* DWT Control Register Definitions */
+#define DWT_CTRL_NOCYCCNT_Pos              25U                                            /*!< DWT CTRL: NOCYCCNT Position */
+#define DWT_CTRL_NOCYCCNT_Msk              (1UL << DWT_CTRL_NOCYCCNT_Pos)                 /*!< DWT CTRL: NOCYCCNT Mask */
+
+#define DWT_CTRL_CYCCNTENA_Pos              0U                                            /*!< DWT CTRL: CYCCNTENA Position */
+#define DWT_CTRL_CYCCNTENA_Msk             (1UL /*<< DWT_CTRL_CYCCNTENA_Pos*/)            /*!< DWT CTRL: CYCCNTENA Mask */
+
+/*
+* Core Debug Data Structure
+*/
+typedef struct __coredebug_t
+{
+  volatile uint32_t DHCSR;                  /*!< Offset: 0x000 (R/W)  Debug Halting Control and Status Register */
+  volatile uint32_t DCRSR;                  /*!< Offset: 0x004 ( /W)  Debug Core Register Selector Register */
+  volatile uint32_t DCRDR;                  /*!< Offset: 0x008 (R/W)  Debug Core Register Data Register */
+  volatile uint32_t DEMCR;                  /*!< Offset: 0x00C (R/W)  Debug Exception and Monitor Control Register */
+}CoreDebug_Type;
+
+/* Debug Exception and Monitor Control Register Definitions */
+#define CoreDebug_DEMCR_TRCENA_Pos         24U                                            /*!< CoreDebug DEMCR: TRCENA Position */
+#define CoreDebug_DEMCR_TRCENA_Msk         (1UL << CoreDebug_DEMCR_TRCENA_Pos)            /*!< CoreDebug DEMCR: TRCENA Mask */
+
 /* Floating-Point Context Control Register Definitions */
 #define FPU_FPCCR_ASPEN_Pos                31U                                            /*!< FPCCR: ASPEN bit Position */
 #define FPU_FPCCR_ASPEN_Msk                (1UL << FPU_FPCCR_ASPEN_Pos)                   /*!< FPCCR: ASPEN bit Mask */
@@ -565,14 +621,18 @@ static __inline void __NVIC_EnableIRQ(IRQn_Type IRQn)
   if((int32_t)(IRQn) >= 0)
   {
     __COMPILER_BARRIER();
+#ifndef HOST_SIM
     NVIC->ISER[((uint32_t)IRQn) >> 5UL] = (uint32_t)(1UL<<(IRQn & 0x1FUL));
+#else
+    NVIC->ISER[((uint32_t)IRQn) >> 5UL] |= (uint32_t)(1UL<<(IRQn & 0x1FUL));
+#endif
     __COMPILER_BARRIER();
   }
 }
 
 static __inline uint32_t __NVIC_GetEnableIRQ(IRQn_Type IRQn)
 {
-  if((uint32_t)(IRQn) >= 0)
+  if((int32_t)(IRQn) >= 0)
   {
     uint32_t reg_value = NVIC->ISER[((uint32_t)IRQn) >> 5UL];
     return (uint32_t)((reg_value & (1UL << ((uint32_t)(IRQn & 0x1FUL)))) != 0UL ? 1UL : 0UL);  
@@ -587,7 +647,11 @@ static __inline void __NVIC_DisableIRQ(IRQn_Type IRQn)
 {
   if((int32_t)(IRQn) >= 0 )
   {
+#ifndef HOST_SIM
     NVIC->ICER[((uint32_t)IRQn) >> 5UL] = (uint32_t)(1UL<<(IRQn & 0x1FUL));
+#else
+    NVIC->ISER[((uint32_t)IRQn) >> 5UL] &= ~(uint32_t)(1UL<<(IRQn & 0x1FUL));
+#endif
     __DSB();
     __ISB();
   }
@@ -595,7 +659,7 @@ static __inline void __NVIC_DisableIRQ(IRQn_Type IRQn)
 
 static __inline uint32_t __NVIC_GetPendingIRQ(IRQn_Type IRQn)
 {
-  if((uint32_t)(IRQn) >= 0)
+  if((int32_t)(IRQn) >= 0)
   {
     uint32_t reg_value = NVIC->ISPR[((uint32_t)IRQn) >> 5UL];
     return (uint32_t)((reg_value & (1UL << ((uint32_t)(IRQn & 0x1FUL)))) != 0UL ? 1UL : 0UL);  
@@ -607,24 +671,32 @@ static __inline uint32_t __NVIC_GetPendingIRQ(IRQn_Type IRQn)
 
 static __inline void __NVIC_SetPendingIRQ(IRQn_Type IRQn)
 {
-  if((uint32_t)(IRQn) >= 0)
+  if((int32_t)(IRQn) >= 0)
   {
+#ifndef HOST_SIM
     NVIC->ISPR[((uint32_t)IRQn) >> 5UL] = (uint32_t)(1UL<<(IRQn & 0x1FUL));
+#else
+    host_sim_irq_raise(IRQn);
+#endif
   }
 }
 
 static __inline void __NVIC_ClearPendingIRQ(IRQn_Type IRQn)
 {
-  if((uint32_t)(IRQn) >= 0)
+  if((int32_t)(IRQn) >= 0)
   {
+#ifndef HOST_SIM
     NVIC->ICPR[((uint32_t)IRQn) >> 5UL] = (uint32_t)(1UL<<(IRQn & 0x1FUL));
+#else
+    NVIC->ISPR[((uint32_t)IRQn) >> 5UL] &= ~(uint32_t)(1UL<<(IRQn & 0x1FUL));
+#endif
     __DSB();
     __DSB();
   }
 }
  static __inline uint32_t __NVIC_GetActive(IRQn_Type IRQn)
  {
-  if((uint32_t)IRQn >= 0)
+  if((int32_t)(IRQn) >= 0)
   {
     uint32_t reg_value = NVIC->IABR[((uint32_t)IRQn) >> 5UL];
     return (uint32_t)((reg_value & (1UL << ((uint32_t)(IRQn & 0x1FUL)))) != 0UL ? 1UL : 0UL);  
@@ -639,7 +711,7 @@ static __inline void __NVIC_ClearPendingIRQ(IRQn_Type IRQn)
 /// @param Priority 
 static __inline void __NVIC_SetPriority(IRQn_Type IRQn, uint32_t Priority)
 {
-  if((uint32_t)(IRQn) >= 0 )
+  if((int32_t)(IRQn) >= 0 )
   {
     NVIC->IP[((uint32_t)IRQn)] = (uint8_t) ((Priority << (8U - __NVIC_PRIO_BITS)) & (uint32_t)0xFFUL);
   }else
@@ -653,7 +725,7 @@ static __inline void __NVIC_SetPriority(IRQn_Type IRQn, uint32_t Priority)
 /// @return 
 static __inline uint32_t __NVIC_GetPriority(IRQn_Type IRQn)
 {
-  if((uint32_t)IRQn >= 0)
+  if((int32_t)(IRQn) >= 0)
   {
     return (((uint32_t)NVIC->IP[((uint32_t)IRQn)] >> (8U-__NVIC_PRIO_BITS))); 
   }
@@ -692,10 +764,80 @@ uint32_t wait_until(uint32_t);
 void SysTickIntDisable(void);
 void SysTickIntEnable(void);
 void SYS_SLEEP_WFI(void);
+uint32_t __SysTick_sleep(uint32_t ticks);
 /**
 * Functions on FPU
 **/
 void __enable_fpu(void);
+/**
+* Function related to the DWT cycle counter
+*/
+void __DWT_init(void);
+/*
+* __getCycleCount: free running core clock cycle count (wraps at 2^32).
+* On the host build it is derived from CLOCK_MONOTONIC at HOST_SIM_HCLK.
+*/
+static __inline uint32_t __getCycleCount(void)
+{
+#ifndef HOST_SIM
+  return DWT->CYCCNT;
+#else
+  return (uint32_t)((host_sim_ns() * (HOST_SIM_HCLK / 1000000UL)) / 1000UL);
+#endif
+}
+/*
+* __SysTick_ctrl: SYSTICK->CTRL; the read clears COUNTFLAG, which is set
+* when the counter wrapped since the last read. The host model clears it
+* the same way here.
+*/
+static __inline uint32_t __SysTick_ctrl(void)
+{
+#ifndef HOST_SIM
+  return SYSTICK->CTRL;
+#else
+  uint32_t ctrl = SYSTICK->CTRL;
+  SYSTICK->CTRL = ctrl & ~SysTick_CTRL_COUNTFLAG_Msk;
+  return ctrl;
+#endif
+}
+/*
+* __irq_save/__irq_restore: PRIMASK critical section that nests.
+* uint32_t pm = __irq_save(); ... __irq_restore(pm);
+*/
+static __inline uint32_t __irq_save(void)
+{
+#ifndef HOST_SIM
+  uint32_t primask;
+  asm volatile("mrs %0, primask\n\tcpsid i" : "=r"(primask) :: "memory");
+  return primask;
+#else
+  host_sim_irq_disable();
+  return 0U;
+#endif
+}
+
+static __inline void __irq_restore(uint32_t primask)
+{
+#ifndef HOST_SIM
+  asm volatile("msr primask, %0" :: "r"(primask) : "memory");
+#else
+  (void)primask;
+  host_sim_irq_enable();
+#endif
+}
+/*
+* __in_handler: 1 in an exception handler (IPSR != 0), 0 in thread mode.
+*/
+static __inline uint32_t __in_handler(void)
+{
+#ifndef HOST_SIM
+  uint32_t ipsr;
+  asm volatile("mrs %0, ipsr" : "=r"(ipsr));
+  return ipsr != 0U;
+#else
+  return host_sim_in_handler();
+#endif
+}
 #ifdef __cplusplus
 }
 #endif
@@ -48,6 +48,7 @@ extern uint32_t _edata;
 extern uint32_t _sbss;
 extern uint32_t _ebss;
 extern uint32_t _la_data;
+extern uint32_t _sstack;
 
 volatile uint32_t _bss_size=0;
 volatile uint32_t _data_size=0;
@@ -187,7 +187,9 @@ do{                                                \
 
 
 void SPI_Init(void);
-void spi_rw(uint8_t* data, uint8_t size);
+StatusTypeDef spi_rw(uint8_t* data, uint8_t size);
+/* from a handler: SYS_BUSY when a task has the bus */
+StatusTypeDef spi_rw_try(uint8_t* data, uint8_t size);
 uint8_t reverse_bit(uint8_t num);
 
 StatusTypeDef Init_SPI1(SPI_HandleTypeDef *);
@@ -60,6 +60,7 @@ typedef struct __ring_in_buffer_t
   unsigned char buffer[UART_BUFFER_SIZE];
   volatile unsigned int head;
   volatile unsigned int tail;
+  volatile unsigned int dropped; /* received bytes lost to a full buffer or an overrun */
 } ring_buffer;
 
 typedef struct __ring_in_buffer2_t
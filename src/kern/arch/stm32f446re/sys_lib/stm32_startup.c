@@ -29,6 +29,9 @@
  */
  
 #include <stm32_startup.h>
+#include <cm4.h>
+#include <kboot.h>
+#include <kstack.h>
 const uint32_t STACK_START = (uint32_t)SRAM_END;
 uint32_t NVIC_VECTOR[] __attribute__((section (".isr_vector")))={
 	STACK_START,
@@ -147,17 +150,27 @@ uint32_t NVIC_VECTOR[] __attribute__((section (".isr_vector")))={
 };
 
 void Reset_Handler(void){
+	/* start CYCCNT for the boot timeline, stamps stay in registers until .bss is clear */
+	__DWT_init();
+	uint32_t t_reset = __getCycleCount();
 	uint32_t size = (uint32_t)&_edata - (uint32_t)&_sdata;
 	uint8_t *pDst = (uint8_t*)&_sdata;
 	uint8_t *pSrc = (uint8_t*)&_la_data;
 	for(uint32_t i=0;i<size;i++){
 		*pDst++ = *pSrc++;
 	}
+	uint32_t t_data = __getCycleCount();
 	size = (uint32_t)&_ebss - (uint32_t)&_sbss;
 	pDst = (uint8_t*)&_sbss;
 	for(uint32_t i=0;i<size;i++){
 		*pDst++ = 0;
 	}
+	uint32_t t_bss = __getCycleCount();
+	kstack_paint_main(&_sstack);
+	kboot_set(KBOOT_RESET, t_reset);
+	kboot_set(KBOOT_DATA, t_data);
+	kboot_set(KBOOT_BSS, t_bss);
+	KBOOT_STAMP(KBOOT_STACK);
 	_text_size = (uint32_t)&_etext - (uint32_t)&_stext;
 	_data_size = (uint32_t)&_edata - (uint32_t)&_sdata;
 	_bss_size = (uint32_t)&_ebss - (uint32_t)&_sbss;
@@ -185,12 +198,3 @@ void BusFault_Handler(void)
 //	printf("Exception : BusFault\n");
 	while(1);
 }
-
-void SVCall_Handler(void){
-/* Write code for SVC handler */
-/* the handler function evntually call syscall function with a call number */
-
-
-}
-
-
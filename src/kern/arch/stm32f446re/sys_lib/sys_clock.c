@@ -28,6 +28,7 @@
  * SUCH DAMAGE.
  */
 #include <sys_clock.h>
+#include <kboot.h>
 
 const uint8_t AHBPrescTable[16] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 7, 8, 9};
 const uint8_t APBPrescTable[8]  = {0, 0, 0, 0, 1, 2, 3, 4};
@@ -37,6 +38,7 @@ void __init_sys_clock(void)
 RCC->CR |= RCC_CR_HSEON; // set CR bit 16 
 /** Check if clock is ready RCC CR register 17th bit set*/ 
 while(!(RCC->CR & RCC_CR_HSERDY)); //wait for the clock is enabled See RCC CR bit-17; HSE crystal is On
+KBOOT_STAMP(KBOOT_HSE);
 /* Set the POWER enable CLOCK and VOLTAGE REGULATOR */
 RCC->APB1ENR |= RCC_APB1ENR_PWREN; //power enable for APB1
 PWR->CR |=  PWR_CR_VOS; // PWR_CR_VOS; //VOS always correspond to reset value 
@@ -60,9 +62,11 @@ RCC->CR |= RCC_CR_PLLON; //1<<24;
 
 while(!(RCC->CR & RCC_CR_PLLRDY))
 	; //wait for PLL ready
+KBOOT_STAMP(KBOOT_PLL);
 //7. Select clock source and wait for it to be set
 RCC->CFGR |= RCC_CFGR_SW_PLL;
 while(!(RCC->CFGR &  RCC_CFGR_SWS_PLL));
+KBOOT_STAMP(KBOOT_CLOCK);
 
 }
 
@@ -4,6 +4,8 @@
 #include <stm32f446xx.h>
 #include <sys_gpio.h>
 #include <cm4.h>
+#include <kprobe.h>
+#include <ksync.h>
 
 #define _SPI_HARDWARE_LSB
 #define _SPI_TIMEOUT  10
@@ -12,10 +14,14 @@
 #define SET 1U
 #define RESET 0U
 
+/* tasks queue for the bus for a whole chip-select cycle, __SYS_LOCK still turns away handlers */
+static kmutex spi1_bus = KMUTEX_INIT;
+
 static StatusTypeDef SPI_WaitFlagStateUntilTimeout(uint32_t Flag, uint32_t State, uint32_t Timeout, uint32_t Tickstart);
 static StatusTypeDef SPI_CheckFlag_BSY(uint32_t Timeout, uint32_t Tickstart);
+static StatusTypeDef __SPI_TransmitReceive(uint8_t* pTxData,uint8_t* pRxData,uint8_t size,uint32_t timeout);
 static SPI_HandleTypeDef hSPI;
-Data_TypeDef errObj={SYS_SPI_t,0};
+static Data_TypeDef errObj={SYS_SPI_t,0};
 void SPI_Init(void)
 {
 	hSPI.Instance=SPI1;
@@ -99,25 +105,61 @@ StatusTypeDef Init_SPI1(SPI_HandleTypeDef *hSPI)
 	return SYS_OK;
 }
 
-void spi_rw(uint8_t* data, uint8_t size)
+/* one chip-select cycle, full duplex in place */
+static StatusTypeDef spi_cycle(uint8_t* data, uint8_t size)
 	{
+		StatusTypeDef status;
 		GPIO_WritePin(SS_GPIO_Port,SS_Pin,GPIO_PIN_RESET);
 		ms_delay(1);
 		#ifndef _SPI_HARDWARE_LSB
-		SPI_TransmitReceive(SPI1,data,data,size,_SPI_TIMEOUT);
+		status = SPI_TransmitReceive(SPI1,data,data,size,_SPI_TIMEOUT);
 		for (uint8_t i = 0; i < size; i++) {
         data[i] = reverse_bit(data[i]);
     }
     //kprintf("We are inside\n"); 
 		#else
     //kprintf("We are inside here before: %x\n",data);
-		SPI_TransmitReceive(data,data,size,_SPI_TIMEOUT);
+		status = SPI_TransmitReceive(data,data,size,_SPI_TIMEOUT);
     //kprintf("We are inside here: %d %x\n",status,data); 
 		#endif
 		ms_delay(1);
 		GPIO_WritePin(SS_GPIO_Port,SS_Pin,GPIO_PIN_SET);
+		return status;
+	}
+
+StatusTypeDef spi_rw(uint8_t* data, uint8_t size)
+	{
+		StatusTypeDef status;
+		uint8_t locked = kmutex_lock(&spi1_bus, KSYNC_FOREVER) == SYS_OK;
+		status = spi_cycle(data,size);
+		if(locked)
+			kmutex_unlock(&spi1_bus);
+		return status;
 	}
+
+/*
+* spi_rw for a handler (the svc), which cannot queue for the bus: no task
+* runs before it returns, so only a task preempted inside its own cycle
+* holds the mutex, and that gives SYS_BUSY instead. One that exited holding
+* it does not, kmutex_owner takes it for free.
+*/
+StatusTypeDef spi_rw_try(uint8_t* data, uint8_t size)
+	{
+		if(kmutex_owner(&spi1_bus) != NULL)
+			return SYS_BUSY;
+		return spi_cycle(data,size);
+	}
+
 StatusTypeDef SPI_TransmitReceive(uint8_t* pTxData,uint8_t* pRxData,uint8_t size,uint32_t timeout)
+	{
+		StatusTypeDef status;
+		KPROBE_ENTER(KPROBE_SPI_TXRX);
+		status = __SPI_TransmitReceive(pTxData,pRxData,size,timeout);
+		KPROBE_EXIT(KPROBE_SPI_TXRX);
+		return status;
+	}
+
+static StatusTypeDef __SPI_TransmitReceive(uint8_t* pTxData,uint8_t* pRxData,uint8_t size,uint32_t timeout)
 	{
 		uint32_t tmp = 0U, tmp1 = 0U;
 		uint32_t tickstart;
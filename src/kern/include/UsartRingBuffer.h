@@ -88,6 +88,10 @@ void GetDataFromBuffer (char *startString, char *endString, char *buffertocopyfr
 int Uart_peek(UART_HandleTypeDef *uart);
 
 
+/* Copy_upto, Get_after and Wait_for called from a task read the port as the owner of its node
+* (vfs_own, as read() does) and return -1 while another reader has it
+*/
+
 /* Copy the data from the Rx buffer into the buffer, Upto and including the entered string
 * This copying will take place in the blocking mode, so you won't be able to perform any other operations
 * Returns 1 on success and -1 otherwise
@@ -113,6 +117,9 @@ int look_for_frame(char *, UART_HandleTypeDef *,uint32_t,uint8_t*);
 /* the ISR for the uart. put it in the IRQ handler */
 void Uart_isr (UART_HandleTypeDef *huart);
 
+/* store a byte in the Rx buffer as if it had been received (UART replay) */
+void Uart_rx_inject(UART_HandleTypeDef *huart, unsigned char c);
+
 /*** Depreciated For now. This is not needed, try using other functions to meet the requirement ***/
 /* get the position of the given string within the incoming data.
  * It returns the position, where the string ends
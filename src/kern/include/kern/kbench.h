@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#ifndef __KBENCH_H
+#define __KBENCH_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+/*
+* Microbenchmarks for the kstring, kstdio and kfloat routines.
+* Every routine runs KBENCH_REPS batches of KBENCH_ITERS calls timed with
+* __getCycleCount() (DWT->CYCCNT on target, CLOCK_MONOTONIC on the host).
+* The cost of an empty call is measured first and subtracted.
+*/
+#define KBENCH_REPS     16
+#define KBENCH_ITERS    64
+#define KBENCH_MAX_LEN  1024
+
+/*
+* Print the results on the console as CSV, one routine per line:
+* name,bytes,cycles_min,cycles_mean,bytes_per_cycle
+* Lines starting with '#' are comments (clock source, skipped routines).
+*/
+void kbench_run(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KBENCH_H */
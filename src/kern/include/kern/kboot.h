@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#ifndef __KBOOT_H
+#define __KBOOT_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <cm4.h>
+/*
+* Boot timeline. Reset_Handler starts DWT->CYCCNT before touching RAM and
+* each boot stage stores the cycle count at its end with KBOOT_STAMP().
+* The core runs from HSI (16 MHz) until __init_sys_clock switches to the
+* PLL, so every stamp also keeps the clock it was taken at; a stage is
+* converted to time with the clock in effect when it started.
+* The "boot" console command prints the timeline.
+*/
+typedef enum
+{
+	KBOOT_RESET = 0,	/* Reset_Handler entry, CYCCNT started */
+	KBOOT_DATA,			/* .data copied from flash */
+	KBOOT_BSS,			/* .bss zeroed */
+	KBOOT_STACK,		/* main stack painted */
+	KBOOT_HSE,			/* HSE oscillator ready */
+	KBOOT_PLL,			/* prescalers set, PLL locked */
+	KBOOT_CLOCK,		/* SYSCLK switched to the PLL */
+	KBOOT_FPU,
+	KBOOT_SYSTICK,
+	KBOOT_USART2,
+	KBOOT_USART6,
+	KBOOT_RINGBUF,
+	KBOOT_TIM2,
+	KBOOT_SERVICES,		/* console, probes, profiler, trace */
+	KBOOT_SYSINFO,		/* show_system_info */
+	KBOOT_NUM_STAGES
+}kboot_stage;
+
+void kboot_set(kboot_stage stage, uint32_t cycles);
+
+__attribute__((always_inline)) static __inline void kboot_stamp(kboot_stage stage)
+{
+	kboot_set(stage, __getCycleCount());
+}
+
+#define KBOOT_STAMP(stage)	kboot_stamp(stage)
+
+/* nanoseconds from reset to now */
+uint32_t kboot_elapsed_ns(void);
+/* print stage,mhz,start_ns,cycles,ns for every stage reached */
+void kboot_report(void);
+/* registers the "boot" console command */
+void kboot_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KBOOT_H */
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#ifndef __KCONSOLE_H
+#define __KCONSOLE_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <types.h>
+#include <kwork.h>
+/*
+* Line oriented command console on __CONSOLE. A line is "name args...";
+* the handler registered for name gets the rest of the line (never NULL).
+*/
+#define KCONSOLE_MAX_CMDS   24
+#define KCONSOLE_LINE_MAX   80
+#define KCONSOLE_PROMPT     "# "
+
+typedef void (*kconsole_fn)(char *args);
+
+typedef struct kconsole_cmd_t
+{
+	char *name;
+	kconsole_fn fn;
+	char *help;
+}kconsole_cmd;
+
+void kconsole_init(void);
+StatusTypeDef kconsole_register(char *name, kconsole_fn fn, char *help);
+/* consume what is in the console ring without blocking, run complete lines; owns tty0 while a line is open */
+void kconsole_poll(void);
+/* from the USART handler: bytes arrived, kconsole_poll runs in kconsole_wait */
+void kconsole_rx_notify(void);
+/* run w in the task serving the console (kconsole_wait); safe from handlers */
+StatusTypeDef kconsole_queue(kwork *w);
+/* serve console input and queued work, waiting up to ms for it (kworkq_run), non-zero when work ran */
+uint32_t kconsole_wait(uint32_t ms);
+/* run one command line */
+void kconsole_exec(char *line);
+/* exact string compare, 1 when equal */
+uint8_t kconsole_match(char *a, char *b);
+/* split the first word off *args, NUL terminated ("" at the end); *args moves to the next one */
+char *kconsole_word(char **args);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KCONSOLE_H */
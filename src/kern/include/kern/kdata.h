@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef __KDATA_H
+#define __KDATA_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <stdint.h>
+#include <cm4.h>
+/*
+* Kernel data page: time and the running pid published for plain loads, so
+* the frequent queries (tick count, microseconds, getpid, wall time) need no
+* svc. Only the kernel writes it; readers go through KDATA, a pointer to
+* const volatile, and the kdata_* helpers below.
+*
+* SysTick_Handler refreshes the time fields under a sequence counter: odd
+* while it writes, bumped again when done. A reader that saw an odd value or
+* a changed count retries (kdata_read_begin/kdata_read_retry). pid is a
+* single word stored by the scheduler at each switch and read without it.
+*
+* The page is 64-byte aligned so an MPU region can make it read-only for
+* unprivileged code once tasks drop privileges.
+*/
+#define KDATA_ALIGN     64U
+
+typedef struct kdata_page_t
+{
+	volatile uint32_t seq;      /* odd while the kernel updates the fields below */
+	uint32_t ticks;             /* SysTick count, getmsTick() */
+	uint32_t tick_cycles;       /* CYCCNT when ticks was stored */
+	uint32_t cycles_per_us;     /* core clock in MHz */
+	uint32_t us_per_tick;
+	uint32_t rtc_valid;         /* 1 when the RTC runs and rtc_time/rtc_date hold it */
+	uint32_t rtc_time;          /* RTC TR, BCD hh:mm:ss, refreshed every second */
+	uint32_t rtc_date;          /* RTC DR, BCD yy:weekday:mm:dd */
+	volatile uint32_t pid;      /* task_id of the running task, 0 before the scheduler */
+}kdata_page;
+
+extern kdata_page kdata_area;
+#define KDATA   ((const volatile kdata_page *)&kdata_area)
+
+/* kernel side */
+void kdata_init(void);
+/* SysTick: ticks, cycle stamp and once a second the RTC */
+void kdata_tick(void);
+static __inline void kdata_set_pid(uint32_t pid) { kdata_area.pid = pid; }
+
+/* reader side */
+static __inline uint32_t kdata_read_begin(void)
+{
+	uint32_t s;
+	while((s = KDATA->seq) & 1U);
+	__DMB();
+	return s;
+}
+
+static __inline uint32_t kdata_read_retry(uint32_t s)
+{
+	__DMB();
+	return KDATA->seq != s;
+}
+
+static __inline uint32_t kdata_ticks(void)
+{
+	return KDATA->ticks; // one word, no sequence needed
+}
+
+static __inline uint32_t kdata_pid(void)
+{
+	return KDATA->pid;
+}
+
+/*
+* Microseconds since boot: the last tick plus the cycles counted since,
+* at most one tick period so the value does not run backwards when the
+* SysTick interrupt is taken late.
+*/
+static __inline uint64_t kdata_us(void)
+{
+	uint32_t s, ticks, stamp, mhz, upt, part;
+	do
+	{
+		s = kdata_read_begin();
+		ticks = KDATA->ticks;
+		stamp = KDATA->tick_cycles;
+		mhz = KDATA->cycles_per_us;
+		upt = KDATA->us_per_tick;
+	}while(kdata_read_retry(s));
+	part = (__getCycleCount() - stamp) / mhz;
+	return (uint64_t)ticks * upt + (part < upt ? part : upt - 1U);
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KDATA_H */
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef __KERN_FCNTL_H
+#define __KERN_FCNTL_H
+/* open() flags, the access mode is the low two bits */
+#define O_RDONLY      0x0     /* read only */
+#define O_WRONLY      0x1     /* write only */
+#define O_RDWR        0x2     /* read and write */
+#define O_ACCMODE     0x3
+
+/* lseek() whence */
+#define SEEK_SET      0       /* from the start */
+#define SEEK_CUR      1       /* from the current offset */
+#define SEEK_END      2       /* from the size of the node */
+
+/* ioctl() requests, IOC_SIZE works on every node */
+#define IOC_NREAD     1       /* *(uint32_t*)arg: bytes a read returns without waiting */
+#define IOC_SIZE      2       /* *(uint32_t*)arg: node size, 0 for a stream */
+#define IOC_RELEASE   3       /* the caller stops reading a VFS_NODE_TTY node (vfs_release) */
+#endif /* KERN_FCNTL_H */
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#ifndef __KIRQLAT_H
+#define __KIRQLAT_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <types.h>
+#include <cm4.h>
+/*
+* Interrupt entry latency test.
+* The test writes DWT->CYCCNT to kirqlat_t0, pends an interrupt in software
+* (NVIC_SetPendingIRQ, or ICSR.PENDSTSET for SysTick) and the handler stamps
+* CYCCNT again with KIRQLAT_ENTRY() as its first statement. The difference
+* minus the cost of the stamp itself is the entry latency in core cycles.
+*
+* Background load: for load% of the samples the trigger is issued inside a
+* PRIMASK critical section of random length, the way kernel code delays an
+* interrupt; the other samples are triggered from a busy loop of random
+* length. Other interrupts stay enabled, so SysTick, TIM2 and UART traffic
+* add their own preemption jitter.
+*/
+#define KIRQLAT_MAX_SAMPLES     1024U
+#define KIRQLAT_DEFAULT_SAMPLES 256U
+#define KIRQLAT_CRIT_MAX        2048U       /* cycles, longest critical section */
+#define KIRQLAT_TIMEOUT         1800000U    /* cycles (10 ms) to wait for a handler */
+
+/* exception number (irqn + 16) of the handler under test, 0 when idle */
+extern volatile uint32_t kirqlat_armed;
+extern volatile uint32_t kirqlat_t0;
+extern volatile uint32_t kirqlat_t1;
+
+/*
+* Returns 1 when this entry was triggered by the test. The check is one load
+* and compare while no test is running.
+*/
+__attribute__((always_inline)) static __inline uint32_t kirqlat_entry(int32_t irqn)
+{
+	if(kirqlat_armed != (uint32_t)(irqn + 16))
+		return 0;
+	kirqlat_t1 = __getCycleCount();
+	kirqlat_armed = 0;
+	return 1;
+}
+
+__attribute__((always_inline)) static __inline uint32_t kirqlat_none(int32_t irqn)
+{
+	(void)irqn;
+	return 0;
+}
+
+#ifndef KIRQLAT_DISABLE
+#define KIRQLAT_ENTRY(irqn)		kirqlat_entry(irqn)
+#else
+#define KIRQLAT_ENTRY(irqn)		kirqlat_none(irqn)
+#endif
+
+typedef struct kirqlat_result_t
+{
+	int32_t irqn;
+	uint32_t samples;
+	uint32_t missed;
+	uint32_t min;
+	uint32_t p50;
+	uint32_t p99;
+	uint32_t max;
+}kirqlat_result;
+
+/* registers the "irqlat" console command and calibrates the stamp cost */
+void kirqlat_init(void);
+/* measure one interrupt; load is the percentage of samples triggered in a critical section */
+StatusTypeDef kirqlat_run(int32_t irqn, uint32_t samples, uint32_t load, kirqlat_result *res);
+/* run SysTick, TIM2, USART2 and USART6 and print irq,samples,missed,load,min,p50,p99,max */
+void kirqlat_report(uint32_t samples, uint32_t load);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KIRQLAT_H */
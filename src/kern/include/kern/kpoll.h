@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef __KERN_POLL_H
+#define __KERN_POLL_H
+#include <stdint.h>
+/* pollfd.events and revents */
+#define POLLIN        0x01    /* a read returns data without waiting */
+#define POLLOUT       0x04    /* a write takes data without waiting */
+#define POLLERR       0x08    /* revents only */
+#define POLLHUP       0x10    /* revents only */
+#define POLLNVAL      0x20    /* revents only: fd is not open */
+
+struct pollfd
+{
+	int32_t fd;                 /* negative: skipped */
+	int16_t events;
+	int16_t revents;
+};
+
+/* select() descriptor sets, one bit per descriptor */
+#define FD_SETSIZE    32
+
+typedef struct fd_set_t
+{
+	uint32_t bits;
+}fd_set;
+
+#define FD_ZERO(s)        ((s)->bits = 0U)
+#define FD_SET(fd, s)     ((s)->bits |= 1UL << (fd))
+#define FD_CLR(fd, s)     ((s)->bits &= ~(1UL << (fd)))
+#define FD_ISSET(fd, s)   (((s)->bits >> (fd)) & 1UL)
+#endif /* KERN_POLL_H */
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#ifndef __KPROBE_H
+#define __KPROBE_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <cm4.h>
+/*
+* Cycle probes for hot paths. A site is a slot in the static kprobe_table;
+* KPROBE_ENTER/KPROBE_EXIT bracket the code to measure with DWT->CYCCNT reads
+* and fold the elapsed cycles into min/max/mean and a log2 histogram
+* (bin n counts durations in [2^n, 2^(n+1)) cycles, bin 0 also holds 0).
+* The probes stay compiled in; build with -DKPROBE_DISABLE to remove them.
+* Updates are not atomic: an interrupt that hits the same site in the middle
+* of a record can lose one sample, which is acceptable for statistics.
+*/
+#define KPROBE_HIST_BINS 32
+
+typedef enum
+{
+	KPROBE_UART_ISR = 0,
+	KPROBE_SYSTICK,
+	KPROBE_TIM2,
+	KPROBE_SPI_TXRX,
+	KPROBE_KPRINTF,
+	KPROBE_NUM_SITES
+}kprobe_id;
+
+typedef struct kprobe_site_t
+{
+	char *name;
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+	uint32_t hist[KPROBE_HIST_BINS];
+}kprobe_site;
+
+extern kprobe_site kprobe_table[KPROBE_NUM_SITES];
+
+__attribute__((always_inline)) static __inline void kprobe_record(kprobe_site *site, uint32_t cycles)
+{
+	site->count++;
+	site->sum += cycles;
+	if(cycles < site->min) site->min = cycles;
+	if(cycles > site->max) site->max = cycles;
+	site->hist[31U - __CLZ(cycles | 1U)]++;
+}
+
+#ifndef KPROBE_DISABLE
+#define KPROBE_ENTER(id)	uint32_t __kprobe_t0_##id = __getCycleCount()
+#define KPROBE_EXIT(id)		kprobe_record(&kprobe_table[id], __getCycleCount() - __kprobe_t0_##id)
+#else
+#define KPROBE_ENTER(id)	do{}while(0)
+#define KPROBE_EXIT(id)		do{}while(0)
+#endif
+
+/* registers the "probe" console command and measures the probe overhead */
+void kprobe_init(void);
+void kprobe_reset(void);
+/* print the table: site,count,min,max,mean then the non-empty bins */
+void kprobe_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KPROBE_H */
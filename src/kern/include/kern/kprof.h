@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#ifndef __KPROF_H
+#define __KPROF_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <types.h>
+/*
+* Statistical PC sampling profiler.
+* TIM5 interrupts at the sampling rate; its handler takes the stacked PC and
+* LR of whatever it interrupted (MSP or PSP frame, chosen by EXC_RETURN) and
+* stores them in a RAM ring. kprof_poll() streams the ring over USART6 in
+* binary frames that src/tools/kprof.py symbolizes against final.elf.
+*
+* kstream frame type 'P', n samples: payload drop16 {pc32 lr32}*n, where
+* drop counts samples lost since the last frame (ring full).
+*/
+#define KPROF_RING_SIZE     512U        /* samples, power of two */
+#define KPROF_FRAME_MAX     32U         /* samples per frame */
+#define KPROF_DEFAULT_HZ    1000U
+#define KPROF_MAX_HZ        20000U
+#define KPROF_TYPE_SAMPLES  'P'
+#define KPROF_TIMER_CLK     90000000U   /* APB1 timer clock */
+
+typedef struct kprof_sample_t
+{
+	uint32_t pc;
+	uint32_t lr;
+}kprof_sample_type;
+
+void kprof_init(void);
+StatusTypeDef kprof_start(uint32_t hz);
+void kprof_stop(void);
+/*
+* send complete frames while USART6 has room; call from thread context.
+* Returns the samples left behind by a full TX ring, 0 when the sampler
+* (or kprof_stop) will queue the next call on the console.
+*/
+uint32_t kprof_poll(void);
+/* called from TIM5_Handler with the exception frame of the interrupted code */
+void kprof_sample(uint32_t *frame);
+
+void TIM5_Handler(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KPROF_H */
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef __KQUEUE_H
+#define __KQUEUE_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <stdint.h>
+#include <types.h>
+/*
+* Lock-free queues of fixed-size records for handing data from interrupt
+* handlers to tasks. Capacity is a power of two; head and tail are free
+* running counters, so a slot is (counter & mask) and nothing is wasted.
+*
+* kspsc: one producer, one consumer. Each side owns its counter and only
+* loads the other (acquire), so no atomic read-modify-write is needed.
+* kmpsc: any number of producers (tasks and handlers of any priority), one
+* consumer. A slot carries a sequence number: a producer claims the slot at
+* head with a compare-and-swap (LDREX/STREX), copies the record and then
+* publishes it by bumping the sequence; the consumer takes records in
+* claim order and frees the slot the same way. A producer interrupted
+* between claim and publish holds back the consumer, never other producers.
+*
+* put and get never wait and are safe from handlers. Only the consumer may
+* use *_wait: it blocks the calling task (ksched_block_timeout) until a put
+* wakes it or ms run out. Define queues with KSPSC_DEFINE/KMPSC_DEFINE.
+*/
+#define KQUEUE_FOREVER      0xFFFFFFFFUL
+
+typedef struct kspsc_t
+{
+	uint8_t *buf;
+	uint32_t size;              /* record bytes */
+	uint32_t mask;              /* capacity - 1 */
+	volatile uint32_t head;     /* written by the producer */
+	volatile uint32_t tail;     /* written by the consumer */
+	TCB_TypeDef *volatile waiter;
+	uint32_t full;              /* puts refused */
+}kspsc;
+
+typedef struct kmpsc_t
+{
+	uint8_t *buf;
+	volatile uint32_t *seq;     /* per slot: the lap (pos & ~mask) when free, lap + 1 when filled */
+	uint32_t size;
+	uint32_t mask;
+	volatile uint32_t head;     /* next slot to claim, CAS by the producers */
+	volatile uint32_t tail;     /* written by the consumer */
+	TCB_TypeDef *volatile waiter;
+	volatile uint32_t full;
+}kmpsc;
+
+#define KQUEUE_POW2(n)      (((n) != 0U) && (((n) & ((n) - 1U)) == 0U))
+
+#define KSPSC_DEFINE(name, type, capacity) \
+	_Static_assert(KQUEUE_POW2(capacity), #name ": capacity must be a power of two"); \
+	static type name##_buf[capacity]; \
+	kspsc name = { (uint8_t*)name##_buf, sizeof(type), (capacity) - 1U, 0, 0, NULL, 0 }
+
+#define KMPSC_DEFINE(name, type, capacity) \
+	_Static_assert(KQUEUE_POW2(capacity) && (capacity) >= 2U, #name ": capacity must be a power of two, 2 or more"); \
+	static type name##_buf[capacity]; \
+	static uint32_t name##_seq[capacity]; \
+	kmpsc name = { (uint8_t*)name##_buf, name##_seq, sizeof(type), (capacity) - 1U, 0, 0, NULL, 0 }
+
+/* SYS_ERROR when capacity is not a power of two */
+StatusTypeDef kspsc_init(kspsc *q, void *buf, uint32_t size, uint32_t capacity);
+/* SYS_BUSY when full (the record is dropped and counted) */
+StatusTypeDef kspsc_put(kspsc *q, const void *rec);
+/* SYS_ERROR when empty */
+StatusTypeDef kspsc_get(kspsc *q, void *rec);
+/* SYS_TIMEOUT when nothing came within ms (KQUEUE_FOREVER: no limit) */
+StatusTypeDef kspsc_wait(kspsc *q, void *rec, uint32_t ms);
+uint32_t kspsc_count(kspsc *q);
+
+/* seq: capacity words, zeroed here; SYS_ERROR unless capacity is a power of two >= 2 */
+StatusTypeDef kmpsc_init(kmpsc *q, void *buf, uint32_t *seq, uint32_t size, uint32_t capacity);
+StatusTypeDef kmpsc_put(kmpsc *q, const void *rec);
+StatusTypeDef kmpsc_get(kmpsc *q, void *rec);
+StatusTypeDef kmpsc_wait(kmpsc *q, void *rec, uint32_t ms);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KQUEUE_H */
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#ifndef __KREPLAY_H
+#define __KREPLAY_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <types.h>
+#include <sys_usart.h>
+/*
+* UART record and replay.
+*
+* Record: Uart_isr logs every received byte of USART2/USART6 with its
+* arrival time into a RAM ring; kreplay_poll() streams it on USART6 as
+* kstream frames 'U', n records: {dt_us32 port8 byte8}*n, dt relative to
+* the previous record. src/tools/kreplay.py turns the stream into a .cap
+* file (same 6 byte records with absolute t_us) and a .cap into C.
+*
+* Replay: the bytes of one port are fed back into its RX ring through
+* Uart_isr. SysTick paces the capture (1 ms resolution, speed x original
+* rate) and pends the USART interrupt when bytes are due; the handler
+* stores them with the same code path as a received byte, so ring overflow
+* shows up as dropped bytes. Meanwhile a parser (Wait_for, Copy_upto,
+* look_for_frame, GetDataFromBuffer) consumes the ring in thread context.
+* The pattern is appended once after the capture so blocking parsers return.
+*/
+#define KREPLAY_RING_SIZE   1024U       /* recorded bytes, power of two */
+#define KREPLAY_FRAME_MAX   40U         /* records per 'U' frame */
+#define KREPLAY_TYPE_BYTES  'U'
+#define KREPLAY_CORE_MHZ    180U
+#define KREPLAY_LINE_MAX    1024U       /* parser output buffer */
+#define KREPLAY_FRAME_TIMEOUT 50U       /* ms, look_for_frame */
+#define KREPLAY_PATTERN_MAX 62U
+
+typedef struct kreplay_cap_t
+{
+	uint32_t t_us;      /* from the start of the capture */
+	uint8_t port;       /* 2 or 6 */
+	uint8_t byte;
+}kreplay_cap;
+
+typedef enum
+{
+	KREPLAY_WAIT_FOR = 0,
+	KREPLAY_COPY_UPTO,
+	KREPLAY_LOOK_FOR_FRAME,
+	KREPLAY_GETDATA,
+	KREPLAY_NUM_PARSERS
+}kreplay_parser;
+
+typedef struct kreplay_result_t
+{
+	uint32_t injected;  /* capture bytes handed to Uart_isr */
+	uint32_t dropped;   /* of those, lost to a full RX ring */
+	uint32_t matches;   /* successful parser calls */
+	uint32_t timeouts;
+	uint32_t cycles;    /* first byte to drained */
+	uint32_t parse_cycles; /* inside parser calls, including their waits */
+}kreplay_result;
+
+extern volatile uint32_t kreplay_recording;
+extern volatile uint32_t kreplay_playing;
+
+/* Uart_isr hooks */
+void kreplay_record(UART_HandleTypeDef *huart, uint8_t c);
+void kreplay_isr(UART_HandleTypeDef *huart);
+/* SysTick hook */
+void kreplay_tick(void);
+
+#ifndef KREPLAY_DISABLE
+#define KREPLAY_RECORD(huart, c)	do{ if(kreplay_recording) kreplay_record(huart, c); }while(0)
+#define KREPLAY_ISR(huart)			do{ if(kreplay_playing) kreplay_isr(huart); }while(0)
+#define KREPLAY_TICK()				do{ if(kreplay_playing) kreplay_tick(); }while(0)
+#else
+#define KREPLAY_RECORD(huart, c)	do{}while(0)
+#define KREPLAY_ISR(huart)			do{}while(0)
+#define KREPLAY_TICK()				do{}while(0)
+#endif
+
+void kreplay_record_start(void);
+void kreplay_record_stop(void);
+/*
+* stream recorded bytes while USART6 has room; call from thread context.
+* Returns the records left behind by a full TX ring, 0 when the recorder
+* (or kreplay_record_stop) will queue the next call on the console.
+*/
+uint32_t kreplay_poll(void);
+
+/* capture used by "replay run"; the firmware default is the weak empty one */
+void kreplay_load(const kreplay_cap *cap, uint32_t len);
+/*
+* Replay the port's bytes at speed x the recorded rate while running parser
+* with pattern (GETDATA: "start,end") until the capture is drained.
+*/
+StatusTypeDef kreplay_run(uint8_t port, kreplay_parser parser, char *pattern, uint32_t speed, kreplay_result *res);
+void kreplay_report(const char *parser, uint8_t port, uint32_t speed, kreplay_result *res);
+kreplay_parser kreplay_parser_by_name(const char *name);
+/* registers the "replay" console command */
+void kreplay_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KREPLAY_H */
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef __KRING_H
+#define __KRING_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <stdint.h>
+#include <cm4.h>
+#include <types.h>
+#include <kwork.h>
+#include <syscall.h>
+/*
+* Submission/completion rings: a task queues I/O requests (sqe) in memory it
+* shares with the kernel and collects the results (cqe) the same way, so one
+* svc serves a whole batch. SYS_ring_setup attaches a ring once,
+* SYS_ring_enter hands the queued entries to the kernel.
+*
+* Each side owns one index of each ring and only reads the other's:
+* the task writes sq_tail and cq_head, the kernel sq_head and cq_tail.
+* Indices run free and are masked on access, the entries of both rings are a
+* power of two. An entry is written before the index that publishes it
+* (DMB in between), on both sides.
+*
+* NOP and UART entries complete inside the svc; UART reads never wait and
+* give -EAGAIN when nothing has arrived. SPI entries need the bus mutex and
+* the transfer delays, so the svc stops at the first one and the "kring" task
+* runs the rest of the batch; their completions come later. With KRING_SQPOLL
+* that task also looks at the ring every KRING_POLL_MS while it waits, and
+* entries are picked up without any svc.
+*
+* The kernel stops when the completion ring is full and goes on at the next
+* ring_enter, nothing is dropped. Rings are attached for good, define them
+* with KRING_DEFINE in static memory. "ring" prints the counters.
+*/
+#define KRING_MAX           4U      /* rings that can be attached */
+#define KRING_PRIO          6U      /* the "kring" task: below the console, above report */
+#define KRING_POLL_MS       2U      /* KRING_SQPOLL scan period */
+
+/* kring.flags */
+#define KRING_SQPOLL        0x1UL   /* the kring task picks entries up, ring_enter only wakes it */
+
+/* kring_sqe.op */
+#define KRING_OP_NOP        0U
+#define KRING_OP_READ       1U
+#define KRING_OP_WRITE      2U
+
+/* kring_sqe.dev, the vfs.h device nodes */
+#define KRING_DEV_CONSOLE   0U      /* USART2 */
+#define KRING_DEV_UART6     1U
+#define KRING_DEV_SPI1      2U      /* full duplex in place: READ and WRITE both clock len bytes through buf */
+
+typedef struct kring_sqe_t
+{
+	uint8_t op;
+	uint8_t dev;
+	uint16_t len;
+	void *buf;                  /* has to stay valid until the completion */
+	uintptr_t user_data;        /* copied to the cqe */
+}kring_sqe;
+
+typedef struct kring_cqe_t
+{
+	uintptr_t user_data;
+	intptr_t res;               /* bytes transferred or -errno */
+}kring_cqe;
+
+typedef struct kring_t
+{
+	kring_sqe *sq;
+	kring_cqe *cq;
+	uint32_t sq_mask;           /* entries - 1 */
+	uint32_t cq_mask;
+	volatile uint32_t sq_head;  /* kernel: next entry to run */
+	volatile uint32_t sq_tail;  /* task: next free entry */
+	volatile uint32_t cq_head;  /* task: next completion to read */
+	volatile uint32_t cq_tail;  /* kernel: next free completion */
+	uint32_t flags;
+	/* kernel private */
+	volatile uint8_t deferred;  /* the kring task owns the ring until it ran dry */
+	kwork work;
+	uint32_t enters;
+	uint32_t completed;
+	uint32_t handoffs;          /* batches passed to the kring task */
+	uint32_t cq_stalls;         /* stops on a full completion ring */
+}kring;
+
+#define KRING_POW2(n)       (((n) != 0U) && (((n) & ((n) - 1U)) == 0U))
+
+/* entries submissions, twice as many completions */
+#define KRING_DEFINE(name, entries) \
+	_Static_assert(KRING_POW2(entries), #name ": entries must be a power of two"); \
+	static kring_sqe name##_sq[entries]; \
+	static kring_cqe name##_cq[2U * (entries)]; \
+	kring name = { .sq = name##_sq, .cq = name##_cq, .sq_mask = (entries) - 1U, .cq_mask = 2U * (entries) - 1U }
+
+/* kernel side, called by SYS_ring_setup and SYS_ring_enter; -errno on failure */
+intptr_t kring_attach(kring *r, uint32_t flags);
+/* entries run in the svc, the rest is left to the kring task */
+intptr_t kring_enter(kring *r);
+/* the "kring" work queue and the "ring" command */
+void kring_sys_init(void);
+
+/* task side */
+static __inline intptr_t kring_setup(kring *r, uint32_t flags)
+{
+	return SYSCALL2(SYS_ring_setup, r, flags);
+}
+
+/* queues one entry; SYS_BUSY when the submission ring is full */
+static __inline StatusTypeDef kring_prep(kring *r, uint8_t op, uint8_t dev, void *buf,
+	uint16_t len, uintptr_t user_data)
+{
+	uint32_t tail = r->sq_tail;
+	kring_sqe *e;
+	if(tail - r->sq_head > r->sq_mask) return SYS_BUSY;
+	e = &r->sq[tail & r->sq_mask];
+	e->op = op;
+	e->dev = dev;
+	e->len = len;
+	e->buf = buf;
+	e->user_data = user_data;
+	__DMB();
+	r->sq_tail = tail + 1U;
+	return SYS_OK;
+}
+
+/* entries the svc completed, -1 and errno on failure */
+static __inline intptr_t kring_submit(kring *r)
+{
+	return SYSCALL1(SYS_ring_enter, r);
+}
+
+/* the oldest completion not yet seen, NULL when there is none */
+static __inline kring_cqe *kring_peek_cqe(kring *r)
+{
+	uint32_t head = r->cq_head;
+	if(head == r->cq_tail) return NULL;
+	__DMB();
+	return &r->cq[head & r->cq_mask];
+}
+
+/* releases the completion kring_peek_cqe returned */
+static __inline void kring_cqe_seen(kring *r)
+{
+	__DMB();
+	r->cq_head = r->cq_head + 1U;
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KRING_H */
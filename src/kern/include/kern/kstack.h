@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#ifndef __KSTACK_H
+#define __KSTACK_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <types.h>
+/*
+* Stack high-water marks by painting.
+* A stack is filled with KSTACK_PAINT before it is used; the deepest point it
+* ever reached is the lowest word that no longer holds the pattern. Scanning
+* costs nothing until someone asks ("stack" console command), unlike
+* sampling the MSP from a timer which also misses short peaks.
+*
+* The main stack is the linker reservation [_sstack, _estack) at the top of
+* SRAM; Reset_Handler paints it before .data/.bss are used. Task stacks are
+* painted and registered by whoever allocates them (kstack_register).
+*/
+#define KSTACK_PAINT    0xDEADBEEFUL
+#define KSTACK_MAX      12U     /* main + MAX_TASKS task stacks + spare */
+
+typedef struct kstack_region_t
+{
+	const char *name;
+	uint32_t *base;     /* lowest address, stacks grow down towards it */
+	uint32_t size;      /* bytes */
+}kstack_region;
+
+/*
+* Paint the main stack from bottom up to the current SP. Must be expanded in
+* the caller (Reset_Handler): a called function would paint over its own frame.
+*/
+__attribute__((always_inline)) static __inline void kstack_paint_main(uint32_t *bottom)
+{
+	uint32_t *sp;
+	asm volatile("mov %0, sp" : "=r"(sp));
+	while(bottom < sp)
+		*bottom++ = KSTACK_PAINT;
+}
+
+/* paint a stack that is not in use yet */
+void kstack_paint(void *base, uint32_t size);
+/* track a painted stack; the name is kept by reference */
+StatusTypeDef kstack_register(const char *name, void *base, uint32_t size);
+void kstack_unregister(void *base);
+/* deepest use in bytes; size when the bottom word is overwritten (overflow) */
+uint32_t kstack_used(void *base, uint32_t size);
+/* deepest use of the main stack in bytes, 0 on the host */
+uint32_t kstack_main_used(void);
+/* print name,base,size,used,free,used_pct for every registered stack */
+void kstack_report(void);
+/* registers the main stack and the "stack" console command */
+void kstack_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KSTACK_H */
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef __KSTRACE_H
+#define __KSTRACE_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <stdint.h>
+#include <cm4.h>
+/*
+* Syscall trace: with kstrace on, syscall() stamps every call with CYCCNT
+* and stores number, pid, the four argument registers, the handler's result
+* (value or -errno) and the cycles it took in a RAM ring that overwrites the
+* oldest record. The same call is counted per syscall number: calls,
+* errors, min/mean/max and a log2 histogram of the cycles.
+*
+* Off, the svc path pays one load and a not-taken branch; the traced path is
+* out of line. Only SVCall writes, and svcs do not nest, so nothing is locked
+* on the way in; the console copies under __irq_save. The cycles cover the
+* handler, not the wait of a call that blocks (nanosleep, yield): the switch
+* happens after the svc returned. A call that waits by restarting the svc
+* (poll, select) is one record with the cycles of all its passes.
+*
+* "strace on [pid]" starts (one task or all), "strace last [n]" prints the
+* newest records, "strace stat" the table and "strace hist no" the buckets.
+*/
+#define KSTRACE_RING_SIZE   128U        /* records, power of two */
+#define KSTRACE_SLOTS       16U         /* syscall numbers with statistics, the last takes the rest */
+#define KSTRACE_BUCKETS     16U         /* bucket k: cycles in [2^(k-1), 2^k), the last is open */
+#define KSTRACE_ALL         0xFFFFFFFFUL
+
+typedef struct kstrace_rec_t
+{
+	uint32_t ts;                /* CYCCNT at entry */
+	uint16_t no;
+	uint16_t pid;
+	uint32_t cycles;
+	int32_t ret;
+	uint32_t args[4];           /* r0-r3 as passed */
+}kstrace_rec;
+
+typedef struct kstrace_stat_t
+{
+	uint16_t no;
+	uint16_t used;
+	uint32_t calls;
+	uint32_t errors;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+	uint32_t hist[KSTRACE_BUCKETS];
+}kstrace_stat;
+
+extern volatile uint32_t kstrace_enabled;
+
+/* syscall(): one finished call, t0 is CYCCNT at its last entry, cycles those of all its passes */
+void kstrace_record(uint32_t no, const uintptr_t *args, intptr_t ret, uint32_t t0, uint32_t cycles);
+/* pid: the task to trace, KSTRACE_ALL for every caller */
+void kstrace_start(uint32_t pid);
+void kstrace_stop(void);
+/* empties the ring and the statistics */
+void kstrace_reset(void);
+/* registers "strace" on the console */
+void kstrace_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KSTRACE_H */
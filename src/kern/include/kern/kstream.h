@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#ifndef __KSTREAM_H
+#define __KSTREAM_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <types.h>
+/*
+* Binary frames for host tools on the diagnostics UART (USART6):
+* A5 5A type n payload[len] xor
+* n is a record count whose meaning depends on type, xor covers type, n and
+* the payload. Frames are written whole through the USART6 TX ring.
+*/
+#define KSTREAM_SYNC0       0xA5U
+#define KSTREAM_SYNC1       0x5AU
+#define KSTREAM_OVERHEAD    5U
+#define KSTREAM_MAX_PAYLOAD 320U
+#define KSTREAM_RETRY_MS    5U      /* producers wait this long for a full TX ring */
+
+/* free bytes in the USART6 TX ring */
+uint32_t kstream_room(void);
+/* SYS_BUSY (nothing written) when the ring cannot take the whole frame */
+StatusTypeDef kstream_send(uint8_t type, uint8_t n, const uint8_t *payload, uint32_t len);
+/* waits for the TX interrupt to make room; thread context only */
+void kstream_send_wait(uint8_t type, uint8_t n, const uint8_t *payload, uint32_t len);
+/* little endian store helpers for building payloads */
+void kstream_put16(uint8_t *dst, uint16_t v);
+void kstream_put32(uint8_t *dst, uint32_t v);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KSTREAM_H */
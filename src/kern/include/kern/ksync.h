@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef __KSYNC_H
+#define __KSYNC_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <stdint.h>
+#include <types.h>
+/*
+* Task synchronisation: mutexes with priority inheritance and counting
+* semaphores. Each keeps its state in one word that the uncontended path
+* changes with a single compare-and-swap (LDREX/STREX), no __irq_save and
+* no call into the scheduler. A set KSYNC_WAITERS bit sends lock/unlock
+* (take/give) to the slow path, which queues or wakes tasks inside
+* __irq_save. Waiters are queued by priority, FIFO among equals, and the
+* releasing side hands the mutex or the semaphore unit straight to the
+* first one: a task that comes later cannot overtake it.
+*
+* Priority inheritance: while a mutex has waiters its owner runs at least at
+* the priority of the most urgent one, through chains of owners blocked on
+* further mutexes. EDF waiters (priority 0) lift an owner to priority 1 only:
+* the EDF class orders its tasks by deadline, not by priority.
+*
+* Mutexes are for tasks only; ksem_give and ksem_trytake also work from
+* handlers. ms is a timeout in SysTick periods, KSYNC_FOREVER waits forever.
+*/
+#define KSYNC_WAITERS       1U              /* in kmutex.owner and ksem.state */
+#define KSYNC_FOREVER       0xFFFFFFFFUL
+#define KSYNC_PI_PRIO_MIN   1U              /* highest priority inheritance may give */
+
+typedef struct kmutex_t
+{
+	volatile uintptr_t owner;       /* TCB_TypeDef* | KSYNC_WAITERS, 0 when free */
+	TCB_TypeDef *waiters;           /* linked by TCB next, by priority */
+	struct kmutex_t *next_held;     /* owner's list of mutexes with waiters */
+	uint32_t contended;             /* slow path locks */
+}kmutex;
+
+typedef struct ksem_t
+{
+	volatile uint32_t state;        /* count << 1 | KSYNC_WAITERS */
+	TCB_TypeDef *waiters;
+	uint32_t contended;
+}ksem;
+
+#define KMUTEX_INIT         { 0, NULL, NULL, 0 }
+#define KSEM_INIT(count)    { (uint32_t)(count) << 1, NULL, 0 }
+
+void kmutex_init(kmutex *m);
+/* SYS_TIMEOUT after ms, SYS_ERROR outside a task or when the caller owns it already */
+StatusTypeDef kmutex_lock(kmutex *m, uint32_t ms);
+/* SYS_BUSY when taken */
+StatusTypeDef kmutex_trylock(kmutex *m);
+/* SYS_ERROR when the caller is not the owner */
+StatusTypeDef kmutex_unlock(kmutex *m);
+/* NULL when free; an owner that exited holding m (kmutex_exit) counts as free */
+TCB_TypeDef *kmutex_owner(kmutex *m);
+/*
+* task is exiting: the mutexes it holds with waiters go to their first
+* waiter. One without waiters keeps the exited owner until the next lock or
+* trylock takes it over; the TCB slot is not reused until then. Call it
+* inside the __irq_save that removes the task.
+*/
+void kmutex_exit(TCB_TypeDef *task);
+
+void ksem_init(ksem *s, uint32_t count);
+/* SYS_TIMEOUT after ms, SYS_ERROR when it would have to wait outside a task */
+StatusTypeDef ksem_take(ksem *s, uint32_t ms);
+StatusTypeDef ksem_trytake(ksem *s);
+/* from a task or a handler */
+void ksem_give(ksem *s);
+uint32_t ksem_count(ksem *s);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KSYNC_H */
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef __KTIMER_H
+#define __KTIMER_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <stdint.h>
+#include <types.h>
+/*
+* Kernel timers on a hierarchical timing wheel. KTIMER_LEVELS levels of
+* KTIMER_SLOTS slots: level 0 holds the timers due within KTIMER_SLOTS ticks
+* one tick per slot, level n covers KTIMER_SLOTS^n ticks per slot. A timer is
+* linked into the slot of its expiry at the lowest level that reaches it, so
+* arming and cancelling are a list link/unlink. Each tick looks at one level 0
+* slot; when the level 0 index wraps, the next level's slot is cascaded (its
+* timers are re-linked one level down), and so on up. An empty wheel, or
+* thousands of timers that are not due yet, cost one empty slot per tick.
+* Expiries further out than KTIMER_RANGE ticks park in the top level and are
+* re-linked on each cascade until they come in range.
+*
+* The callbacks run from SysTick_Handler with interrupts disabled: they may
+* make tasks ready or re-arm timers, nothing that waits. A periodic timer is
+* re-armed before its callback runs, at expires + period (catching up when
+* ticks were missed). The scheduler's sleeps and EDF releases are timers too.
+*/
+#define KTIMER_SLOT_BITS    5U
+#define KTIMER_SLOTS        (1UL << KTIMER_SLOT_BITS)
+#define KTIMER_LEVELS       5U
+#define KTIMER_RANGE        (1UL << (KTIMER_SLOT_BITS * KTIMER_LEVELS))    /* 2^25 ticks, 9.3 h at 1 ms */
+#define KTIMER_NONE         0xFFFFFFFFUL
+
+void ktimer_init(Timer_TypeDef *timer, void (*fn)(void *arg), void *arg);
+/* arm (or re-arm) to expire ms ticks from now, then every period ticks (0: once) */
+void ktimer_start(Timer_TypeDef *timer, uint32_t ms, uint32_t period);
+/* arm at an absolute tick; one already past runs on the next tick */
+void ktimer_start_at(Timer_TypeDef *timer, uint32_t tick, uint32_t period);
+/* disarm, returns 1 when the timer was armed */
+uint8_t ktimer_cancel(Timer_TypeDef *timer);
+uint8_t ktimer_armed(Timer_TypeDef *timer);
+/* armed timers */
+uint32_t ktimer_count(void);
+/* ticks until the wheel has work (an expiry or a cascade), KTIMER_NONE when empty;
+   a cascade may come before the first expiry, so this is a lower bound for it */
+uint32_t ktimer_next(void);
+/* advance the wheel to now and run what is due, called by ksched_tick */
+void ktimer_tick(uint32_t now);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KTIMER_H */
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#ifndef __KTRACE_H
+#define __KTRACE_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <cm4.h>
+/*
+* Binary event trace. Events are 8 bytes (cycle timestamp, type, id, arg)
+* written into a RAM ring that overwrites the oldest entry. A slot is claimed
+* with one atomic increment (LDREX/STREX), so threads and nested interrupts
+* can record without locks; a disabled trace costs one load and a branch.
+* "trace dump" freezes the ring and sends it as kstream frames on USART6:
+* 'H' (hz32, lost32, count32) once, then 'T' frames of n raw events.
+* src/tools/ktrace.py turns the capture into Chrome/Perfetto JSON.
+*/
+#define KTRACE_RING_SIZE    1024U       /* events, power of two */
+#define KTRACE_FRAME_MAX    32U         /* events per frame */
+#define KTRACE_TYPE_HEADER  'H'
+#define KTRACE_TYPE_EVENTS  'T'
+
+typedef enum
+{
+	KTRACE_ISR_ENTER = 1,   /* id: exception number (IRQn + 16) */
+	KTRACE_ISR_EXIT,
+	KTRACE_CTX_SWITCH,      /* id: 0, arg: next task; the previous one is the last switch's */
+	KTRACE_SYSCALL_ENTER,   /* id: syscall number */
+	KTRACE_SYSCALL_EXIT,    /* id: syscall number, arg: low 16 bits of result */
+	KTRACE_MARK,            /* id: marker, arg: value */
+	KTRACE_MARK_BEGIN,
+	KTRACE_MARK_END
+}ktrace_type;
+
+typedef struct ktrace_event_t
+{
+	uint32_t ts;
+	uint8_t type;
+	uint8_t id;
+	uint16_t arg;
+}ktrace_event;
+
+extern ktrace_event ktrace_ring[KTRACE_RING_SIZE];
+extern volatile uint32_t ktrace_head;
+extern volatile uint32_t ktrace_enabled;
+
+__attribute__((always_inline)) static __inline void ktrace_record(uint8_t type, uint8_t id, uint16_t arg)
+{
+	if(ktrace_enabled)
+	{
+		ktrace_event *e = &ktrace_ring[__atomic_fetch_add(&ktrace_head, 1U, __ATOMIC_RELAXED) & (KTRACE_RING_SIZE - 1U)];
+		e->ts = __getCycleCount();
+		e->type = type;
+		e->id = id;
+		e->arg = arg;
+	}
+}
+
+#ifndef KTRACE_DISABLE
+#define KTRACE_ISR_ENTER(irqn)		ktrace_record(KTRACE_ISR_ENTER, (uint8_t)((irqn) + 16), 0)
+#define KTRACE_ISR_EXIT(irqn)		ktrace_record(KTRACE_ISR_EXIT, (uint8_t)((irqn) + 16), 0)
+#define KTRACE_CTX_SWITCH(to)		ktrace_record(KTRACE_CTX_SWITCH, 0, (uint16_t)(to))
+#define KTRACE_SYSCALL_ENTER(no)	ktrace_record(KTRACE_SYSCALL_ENTER, (uint8_t)(no), 0)
+#define KTRACE_SYSCALL_EXIT(no,ret)	ktrace_record(KTRACE_SYSCALL_EXIT, (uint8_t)(no), (uint16_t)(ret))
+#define KTRACE_MARK(id,val)		ktrace_record(KTRACE_MARK, (uint8_t)(id), (uint16_t)(val))
+#define KTRACE_MARK_BEGIN(id)		ktrace_record(KTRACE_MARK_BEGIN, (uint8_t)(id), 0)
+#define KTRACE_MARK_END(id)		ktrace_record(KTRACE_MARK_END, (uint8_t)(id), 0)
+#else
+#define KTRACE_ISR_ENTER(irqn)		do{}while(0)
+#define KTRACE_ISR_EXIT(irqn)		do{}while(0)
+#define KTRACE_CTX_SWITCH(to)		do{}while(0)
+#define KTRACE_SYSCALL_ENTER(no)	do{}while(0)
+#define KTRACE_SYSCALL_EXIT(no,ret)	do{}while(0)
+#define KTRACE_MARK(id,val)		do{}while(0)
+#define KTRACE_MARK_BEGIN(id)		do{}while(0)
+#define KTRACE_MARK_END(id)		do{}while(0)
+#endif
+
+void ktrace_init(void);
+void ktrace_start(void);
+void ktrace_stop(void);
+/* freeze, send the ring on USART6 oldest first, then resume if it was on */
+void ktrace_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KTRACE_H */
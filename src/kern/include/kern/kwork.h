@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef __KWORK_H
+#define __KWORK_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <stdint.h>
+#include <types.h>
+/*
+* Deferred work: a handler does the part that cannot wait (read the data
+* register, clear the flag) and queues a kwork item for the rest, which runs
+* in task context at the priority of the task serving the queue. That task
+* either calls kworkq_run from its own loop or is created by kworkq_start.
+*
+* Items are intrusive, nothing is allocated. Queueing an item that is still
+* pending does nothing (coalesced): one run serves every kwork_queue before
+* it. The pending flag is cleared before fn runs, so fn may requeue its item.
+* kwork_queue is safe from handlers and tasks.
+*
+* Per queue the latency from kwork_queue to the start of fn and the run time
+* of fn are kept in core cycles; "work" prints them.
+*/
+#define KWORK_FOREVER       0xFFFFFFFFUL
+#define KWORK_MAX_QUEUES    4U      /* queues listed by "work" */
+#define KWORK_PRIO          1U      /* kworkq_start default: above every fixed priority task */
+
+typedef struct kwork_t
+{
+	struct kwork_t *next;
+	void (*fn)(void *arg);
+	void *arg;
+	uint32_t stamp;             /* CYCCNT at kwork_queue */
+	volatile uint8_t pending;
+}kwork;
+
+typedef struct kworkq_t
+{
+	const char *name;
+	kwork *head;
+	kwork *tail;
+	TCB_TypeDef *volatile waiter;
+	uint32_t depth;             /* items pending */
+	/* statistics, "work reset" clears them */
+	uint32_t queued;
+	uint32_t coalesced;         /* kwork_queue of an item that was pending */
+	uint32_t runs;
+	uint32_t depth_max;
+	uint32_t lat_min;
+	uint32_t lat_max;
+	uint64_t lat_sum;
+	uint32_t run_max;
+	uint64_t run_sum;
+}kworkq;
+
+#define KWORK_INIT(fn, arg)     { NULL, (fn), (arg), 0, 0 }
+
+void kwork_init(kwork *w, void (*fn)(void *arg), void *arg);
+/* add the queue to the "work" table; SYS_BUSY when KWORK_MAX_QUEUES are listed already */
+StatusTypeDef kworkq_init(kworkq *q, const char *name);
+/* SYS_OK when queued, SYS_BUSY when the item was still pending */
+StatusTypeDef kwork_queue(kworkq *q, kwork *w);
+/*
+* Run what is queued, in order. With nothing queued the calling task waits up
+* to ms for an item (0: return at once). Returns the number of items run.
+*/
+uint32_t kworkq_run(kworkq *q, uint32_t ms);
+/* a task that serves q forever; NULL when no task slot is left */
+TCB_TypeDef *kworkq_start(kworkq *q, uint8_t priority);
+void kworkq_reset(kworkq *q);
+/* registers "work" on the console */
+void kworkq_sys_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KWORK_H */
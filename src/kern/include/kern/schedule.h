@@ -27,10 +27,126 @@
  * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
  * SUCH DAMAGE.
  */
- 
+
 #ifndef __SCHEDULE_H
 #define __SCHEDULE_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <stdint.h>
+#include <cm4.h>
+#include <types.h>
+#include <kmain.h>
+/*
+* Preemptive priority scheduler.
+* Every priority level has a FIFO of ready tasks and a bit in ksched_ready_map
+* (bit 31 - priority), so the highest ready priority is one CLZ away no matter
+* how many tasks exist. Tasks of equal priority share the CPU in round robin,
+* KSCHED_SLICE_TICKS SysTick periods each.
+*
+* SysTick_Handler calls ksched_tick: it advances the timer wheel (ktimer.h,
+* sleeping tasks and EDF releases are TCB timers), accounts the time to the
+* running task and pends PendSV when a higher priority
+* task became ready or the time slice ran out. PendSV has the lowest exception
+* priority, so the switch happens after every other handler finished.
+* PendSV_Handler saves r4-r11 (and s16-s31 when the task used the FPU, see
+* EXC_RETURN bit 4 and lazy stacking in __enable_fpu) on the task stack,
+* stores PSP in TCB_TypeDef.psp and asks ksched_switch for the next task.
+* Tasks run in thread mode on PSP; handlers stay on MSP.
+* CPU time is measured in DWT cycles at every switch (and folded at every
+* tick): TCB execution_time while running, waiting_time while ready. Time in
+* interrupt handlers is charged to the task they interrupted.
+* When only the idle task is left it suppresses the ticks up to the next
+* timer (tickless idle, __SysTick_sleep in cm4.c).
+*
+* Priority 0 is the EDF class: periodic tasks with a period, a WCET budget
+* and a relative deadline (TCB_TypeDef.edf). Its list is kept sorted by
+* absolute deadline instead of FIFO, so the earliest job runs ahead of every
+* fixed-priority task. A task is admitted only while the summed
+* wcet/min(period, deadline) stays within KSCHED_EDF_UTIL_MAX. A job that
+* uses up its budget is stopped until its next release (overrun); a job not
+* finished by its deadline counts as a miss.
+*/
+#define KSCHED_PRIOS        32U
+#define KSCHED_IDLE_PRIO    (KSCHED_PRIOS - 1U)
+#define KSCHED_SLICE_TICKS  10U         /* round robin slice, SysTick periods */
+#define KSCHED_EDF_PRIO     0U          /* EDF class, above every fixed priority */
+#define KSCHED_EDF_UTIL_MAX 1000U       /* admission bound, per mille of the CPU */
+#define KSCHED_TICKLESS_MIN 2U          /* idle stretches SysTick when the next deadline is this far */
+
+extern TCB_TypeDef *volatile ksched_current;
+extern volatile uint32_t ksched_ready_map;
+/* context switches, and those that saved an FP context (s0-s31) */
+extern volatile uint32_t ksched_switches;
+extern volatile uint32_t ksched_fp_switches;
+
+/* creates the idle task, call before the first task_create */
+void ksched_init(void);
+/* switch to the highest priority task, never returns */
+void ksched_start(void) __attribute__((noreturn));
+/* 1 once ksched_start ran */
+uint8_t ksched_running(void);
+
+/* tickless idle: sleeps that skipped ticks and the ticks skipped so far */
+void ksched_idle_stats(uint32_t *sleeps, uint32_t *ticks);
 
+/* bring execution_time/waiting_time of the running and ready tasks up to now */
+void ksched_account(void);
+
+/* SysTick_Handler hook */
+void ksched_tick(void);
+/* PendSV_Handler: requeue the current task, return the next one to run */
+TCB_TypeDef *ksched_switch(void);
+
+/* make a task runnable (from a task or a handler); preempts when it outranks the current task.
+   A task that is ready or running already is left alone */
+void ksched_ready(TCB_TypeDef *task);
+/* take the current task off the CPU with state (TASK_BLOCKED_STATE ...); the switch happens
+   when interrupts are enabled again, so call it inside __irq_save with the wait list updated */
+void ksched_block(uint16_t state);
+/* same, made ready again by its timer after ticks SysTick periods unless ksched_ready came first
+   (0: no timeout); the caller tells the two apart by re-checking what it waited for */
+void ksched_block_timeout(uint16_t state, uint32_t ticks);
+/* change the priority of a task in any state (priority inheritance); a ready task is
+   requeued, the running one gives way when it dropped below a ready task */
+void ksched_set_priority(TCB_TypeDef *task, uint8_t priority);
+/* sleep for ticks SysTick periods (0 = yield) */
+void ksched_sleep(uint32_t ticks);
+/* give the rest of the slice to the next task of the same priority */
+void ksched_yield(void);
+/* remove a task from the scheduler for good (task_exit) */
+void ksched_remove(TCB_TypeDef *task);
+
+/* admission control for an EDF task (priority KSCHED_EDF_PRIO, not ready yet); SYS_ERROR when
+   the utilization would exceed KSCHED_EDF_UTIL_MAX. The first job is released now */
+StatusTypeDef ksched_edf_admit(TCB_TypeDef *task, uint32_t period, uint32_t wcet, uint32_t deadline);
+/* end the current EDF job, sleep until the next release */
+void ksched_wait_period(void);
+/* admitted EDF utilization, per mille */
+uint32_t ksched_edf_util(void);
+
+/* port (PendSV, first frame, start) */
+void ksched_port_init_stack(TCB_TypeDef *task, void (*entry)(void *), void *arg);
+void ksched_port_start(void) __attribute__((noreturn));
+
+/* PendSV request: taken as soon as no other handler runs and interrupts are enabled */
+__attribute__((always_inline)) static __inline void ksched_pend(void)
+{
+#ifndef HOST_SIM
+	SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+	__DSB();
+#else
+	host_sim_irq_raise(PendSV_IRQn);
 #endif
+}
 
+/* index of the highest priority ready task list, ksched_ready_map must not be 0 */
+__attribute__((always_inline)) static __inline uint32_t ksched_top(void)
+{
+	return __CLZ(ksched_ready_map);
+}
 
+#ifdef __cplusplus
+}
+#endif
+#endif /* __SCHEDULE_H */
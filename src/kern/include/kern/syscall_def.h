@@ -152,4 +152,8 @@
 #define SYS_reboot       119
 #define SYS_yield        120	
 
+//-- Submission/completion rings (kring.h) --
+#define SYS_ring_setup   121
+#define SYS_ring_enter   122
+
 #endif /*End of SYSCALL_DEF_H */
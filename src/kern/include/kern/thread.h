@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef __THREAD_H
+#define __THREAD_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <stdint.h>
+#include <types.h>
+/*
+* Kernel tasks. TCBs and stacks come from a static pool of MAX_TASKS entries
+* (SIZE_TASK_STACK bytes each, painted and registered with kstack); the slot
+* of a task that returned or called task_exit is reused by the next
+* task_create. Priority 1 is the most urgent fixed priority, KSCHED_IDLE_PRIO
+* belongs to the idle task and priority 0 (KSCHED_EDF_PRIO) to the periodic
+* tasks created with task_create_edf. An EDF task body is a loop that ends
+* every job with task_wait_period.
+*/
+typedef void (*task_fn)(void *arg);
+
+#define TASK_CTXSW_PRIO     1U          /* ctxsw benchmark pair, the caller must be below */
+#define TASK_TOP_MAX_MS     60000U      /* longest top window, the calling task sleeps through it */
+#define TASK_SLEEP_MAX      0x7FFFFFFFUL /* ticks, longer sleeps are cut (timer expiries compare signed) */
+
+/* NULL when the pool is exhausted or the priority is out of range */
+TCB_TypeDef *task_create(const char *name, task_fn fn, void *arg, uint8_t priority);
+/* periodic EDF task, first job released now; NULL when the pool is exhausted or admission
+   control rejects it (deadline_ms <= period_ms, total wcet/deadline above KSCHED_EDF_UTIL_MAX) */
+TCB_TypeDef *task_create_edf(const char *name, task_fn fn, void *arg, uint32_t period_ms,
+	uint32_t wcet_ms, uint32_t deadline_ms);
+/* end the current EDF job and sleep until the next release */
+void task_wait_period(void);
+/* terminate the calling task (also reached when fn returns) */
+void task_exit(void) __attribute__((noreturn));
+TCB_TypeDef *task_self(void);
+/* block for at least ms milliseconds, at most TASK_SLEEP_MAX ticks; 0 yields */
+void task_sleep(uint32_t ms);
+/* SYS_nanosleep: sec seconds plus nsec nanoseconds, rounded up to whole ticks, at most TASK_SLEEP_MAX */
+void task_nanosleep(uint32_t sec, uint32_t nsec);
+void task_yield(void);
+/* pool slot i, NULL when free (for ps/top) */
+TCB_TypeDef *task_at(uint32_t i);
+/* print id,name,prio,state,exec_ms,wait_ms,stack_used for every task */
+void task_report(void);
+/* sleep ms in the calling task, then print each task's share of the window (cpu, ready-wait,
+   per cent), its switches per second, the total switch rate and the ISR share */
+void task_top(uint32_t ms);
+/* cycles per task_yield switch between two tasks (fpu: both keep an FP context live),
+   averaged over 2n switches; 0 when the pool has no room for the pair */
+uint32_t task_ctxsw_cycles(uint8_t fpu, uint32_t n);
+/* print period,wcet,deadline,util_pm,jobs,misses,overruns for every EDF task */
+void task_edf_report(void);
+/* registers the "ps", "edf", "top" and "ctxsw" console commands */
+void task_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __THREAD_H */
@@ -93,16 +93,72 @@ typedef enum
 } ErrorStatus;
 
 
+/* kernel timer (ktimer.h), embedded in its owner; times in SysTick periods */
+typedef struct ktimer_t{
+	struct ktimer_t *next; //wheel slot list
+	struct ktimer_t **pprev; //link pointing at this timer, NULL while not armed
+	uint32_t expires; //tick at which fn runs
+	uint32_t period; //re-armed by this much after each expiry, 0 for one-shot
+	void (*fn)(void *arg); //runs in SysTick_Handler
+	void *arg;
+} Timer_TypeDef;
+
+/* EDF class parameters of a periodic task, in SysTick periods */
+typedef struct edf_params{
+	uint32_t period;
+	uint32_t wcet; //budget per job
+	uint32_t deadline; //relative to the release
+	uint32_t release; //release of the current job
+	uint32_t abs_deadline; //release + deadline
+	uint32_t budget; //left in the current job
+	uint32_t jobs; //completed jobs
+	uint32_t misses; //jobs not completed by their deadline
+	uint32_t overruns; //jobs stopped because the budget ran out
+	uint16_t util; //admitted utilization, per mille
+	uint8_t missed; //the current job already counted as a miss
+	uint8_t reserved;
+} EDF_TypeDef;
+
+struct kmutex_t;
+struct ksem_t;
+struct vfs_file_t;
+
+#define TASK_FILES 8U //descriptors per task (vfs.h)
+
 typedef struct task_tcb{
 	uint32_t magic_number; //here it is 0xFECABAA0
 	uint16_t task_id; //a unsigned 16 bit integer starting from 1000 
 	void *psp; //task stack pointer or stackframe address
 	uint16_t status; //task status: running, waiting, ready, killed, or terminated
-	uint32_t execution_time; //total execution time (in ms)
-	uint32_t waiting_time; //total waiting time (in ms)
+	uint64_t execution_time; //core cycles spent running (DWT->CYCCNT), interrupts included
+	uint64_t waiting_time; //core cycles spent ready, waiting for the CPU
 	uint32_t digital_sinature; //current value is 0x00000001
+	uint8_t priority; //0 is the highest, 31 is the idle task
+	uint8_t fpu_used; //1 once the task was switched out with an FP context
+	uint16_t slice; //ticks left in the current time slice
+	Timer_TypeDef timer; //wakes a sleeping task, releases the next EDF job
+	struct task_tcb *next; //ready, sleep or wait list link
+	const char *name;
+	uint32_t *stack; //lowest address of the task stack
+	uint32_t stack_size; //in bytes
+	void *arch; //port specific state (host: the thread that runs the task)
+	uint32_t acct_stamp; //CYCCNT when the task last started running or became ready
+	uint32_t switches; //times the task was switched in
+	uint8_t base_priority; //as created, priority is raised above it by priority inheritance
+	struct kmutex_t *held; //owned mutexes that have waiters (ksync.h)
+	uint16_t mutexes; //owned mutexes, with or without waiters
+	struct kmutex_t *wait_mutex; //mutex the task is queued on, NULL once it was handed over
+	struct ksem_t *wait_sem; //same for a semaphore
+	struct task_tcb *wait_next; //mutex or semaphore waiter list link
+	int32_t sys_errno; //errno of the last failed syscall (__errno)
+	uint32_t strace_cycles; //svc cycles of the restarted passes of the call in progress (kstrace)
+	struct vfs_file_t *files[TASK_FILES]; //descriptor table, NULL slots are free
+	EDF_TypeDef edf; //used when priority is KSCHED_EDF_PRIO
 } TCB_TypeDef;
 
+/* PendSV_Handler stores and loads psp at this offset */
+_Static_assert(__builtin_offsetof(TCB_TypeDef, psp) == 8, "TCB_TypeDef.psp must stay at offset 8");
+
 #if defined (__ARMCC_VERSION) && (__ARMCC_VERSION >= 6010050) /* ARM Compiler V6 */
   #ifndef __weak
     #define __weak  __attribute__((weak))
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef __VFS_H
+#define __VFS_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <stdint.h>
+#include <types.h>
+#include <kfcntl.h>
+#include <kpoll.h>
+/*
+* File descriptors over device nodes. A node is a driver behind a vfs_ops
+* table; open() finds it by name and puts a vfs_file (node, offset, access
+* mode) in the first free slot of the calling task's descriptor table.
+* read and write hand the caller's buffer straight to the node, the VFS
+* never copies, and every device is reached through the same three calls.
+*
+* Nodes with a size (the RAM disk) are seekable, the offset belongs to the
+* file and is shared by the descriptors dup() made. Nodes of size 0 are
+* streams, lseek, pread and pwrite on them give -ESPIPE.
+*
+* A task starts with 0 (read) and 1, 2 (write) on the console; before the
+* first task runs a boot table stands in. Descriptors left open are closed
+* when the task exits. Node calls run in the svc and must not wait there:
+* read and write of a node marked VFS_NODE_TASK (the SPI bus mutex, a
+* transfer with delays) go to the vfs task instead, and the caller is
+* blocked until it is done. Without a task slot for it they run in the svc
+* and give -EAGAIN when the resource is taken.
+*
+* poll and select wait for readiness instead of retrying on -EAGAIN. A
+* node's poll op tells what a read or write would find (nodes without one
+* are always ready), and the driver calls vfs_notify from its handler when
+* that changes; the tasks polling one of its nodes are made ready and scan
+* again. Inside the svc the caller cannot wait, so vfs_poll blocks the task
+* and returns -SYSCALL_RESTART: the svc runs again once the task is woken or
+* its timeout ran out, with the deadline kept from the first call.
+*/
+#define VFS_MAX_NODES       8U      /* registered nodes */
+#define VFS_MAX_FILES       16U     /* open files of all tasks, dup shares one */
+#define VFS_NAME_MAX        16U     /* node names, with the terminating 0 */
+#define VFS_RAMDISK_SIZE    4096U   /* /dev/ram0 */
+#define VFS_FIFO_SIZE       128U    /* /dev/fifo0 and /dev/fifo1, a power of two */
+#define VFS_POLL_MAX        16U     /* pollfd entries of one call */
+
+/* vfs_node.flags */
+#define VFS_NODE_TASK       0x1UL   /* may wait for a lock only a task can wait for */
+#define VFS_NODE_TTY        0x2UL   /* input has one reader at a time, see vfs_own */
+
+struct vfs_node_t;
+
+/* bytes transferred or -errno; off is 0 for a stream */
+typedef struct vfs_ops_t
+{
+	int32_t (*read)(const struct vfs_node_t *n, void *buf, uint32_t len, uint32_t off);
+	int32_t (*write)(const struct vfs_node_t *n, const void *buf, uint32_t len, uint32_t off);
+	int32_t (*ioctl)(const struct vfs_node_t *n, uint32_t req, uintptr_t arg);   /* NULL: IOC_SIZE and IOC_NREAD of a seekable node only */
+	uint32_t (*poll)(const struct vfs_node_t *n);  /* POLLIN | POLLOUT as they are now; NULL: both */
+}vfs_ops;
+
+typedef struct vfs_node_t
+{
+	const char *name;           /* "/dev/tty0" */
+	const vfs_ops *ops;
+	void *dev;                  /* driver handle */
+	uint32_t size;              /* bytes of a seekable node, 0 for a stream */
+	uint32_t flags;             /* VFS_NODE_* */
+}vfs_node;
+
+typedef struct vfs_file_t
+{
+	const vfs_node *node;
+	uint32_t off;               /* seekable nodes */
+	uint16_t flags;             /* O_* given to open */
+	uint16_t refs;              /* descriptors on the file, the slot is free at 0 */
+}vfs_file;
+
+/* the device nodes vfs_sys_init registers */
+extern const vfs_node vfs_tty0;     /* USART2, the console */
+extern const vfs_node vfs_tty1;     /* USART6 */
+extern const vfs_node vfs_spi1;     /* full duplex in place: read and write both clock len bytes through buf */
+extern const vfs_node vfs_ram0;     /* VFS_RAMDISK_SIZE bytes */
+extern const vfs_node vfs_fifo0;    /* VFS_FIFO_SIZE byte pipes between tasks, -EAGAIN when empty or full */
+extern const vfs_node vfs_fifo1;
+
+StatusTypeDef vfs_register(const vfs_node *n);
+/* the node called path, NULL when there is none */
+const vfs_node *vfs_lookup(const char *path);
+
+/* the first node on dev, NULL when there is none */
+const vfs_node *vfs_lookup_dev(void *dev);
+
+/*
+* VFS_NODE_TTY input has one reader at a time. A read or a POLLIN poll takes
+* a free node for the calling task (or the boot context); until it lets go
+* the others find it empty: -EAGAIN, not POLLIN, and their poll wakes when it
+* is released. vfs_release, ioctl IOC_RELEASE or the owner's exit free it.
+* The console holds tty0 only while a command line is open. SYS_BUSY when
+* another reader owns n; nodes without the flag are always SYS_OK.
+*/
+StatusTypeDef vfs_own(const vfs_node *n);
+void vfs_release(const vfs_node *n);
+
+/* calls for the running task (the boot table before the scheduler); descriptor, bytes or -errno */
+int32_t vfs_open(const char *path, uint32_t flags);
+int32_t vfs_close(int32_t fd);
+int32_t vfs_read(int32_t fd, void *buf, uint32_t len);
+int32_t vfs_write(int32_t fd, const void *buf, uint32_t len);
+int32_t vfs_pread(int32_t fd, void *buf, uint32_t len, uint32_t off);
+int32_t vfs_pwrite(int32_t fd, const void *buf, uint32_t len, uint32_t off);
+/* the new offset */
+int32_t vfs_lseek(int32_t fd, int32_t off, uint32_t whence);
+int32_t vfs_ioctl(int32_t fd, uint32_t req, uintptr_t arg);
+int32_t vfs_dup(int32_t fd);
+int32_t vfs_dup2(int32_t fd, int32_t fd2);
+/* descriptors with revents set; timeout_ms < 0 waits for good, 0 does not wait */
+int32_t vfs_poll(struct pollfd *fds, uint32_t nfds, int32_t timeout_ms);
+/* the bits of fd_set that are ready are left set; NULL sets are empty */
+int32_t vfs_select(uint32_t nfds, fd_set *rfds, fd_set *wfds, int32_t timeout_ms);
+/* a driver's own read loop in a task: 1 once a node on dev has one of events, 0 after timeout_ms; -ENODEV without a node */
+int32_t vfs_wait(void *dev, uint32_t events, int32_t timeout_ms);
+/* from a driver (handler or task): events (POLLIN, POLLOUT) of the nodes on dev may have changed */
+void vfs_notify(void *dev, uint32_t events);
+
+/* task_alloc: console descriptors; exit: closes what is left */
+void vfs_task_init(TCB_TypeDef *task);
+void vfs_task_exit(TCB_TypeDef *task);
+/* the device nodes and the "vfs" command */
+void vfs_sys_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __VFS_H */
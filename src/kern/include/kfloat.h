@@ -74,6 +74,8 @@ double __aeabi_dmul(double,double);
 
 uint64_t __aeabi_d2ulz(double);
 
+uint32_t __aeabi_dcmpeq(double,double);
+
 double __aeabi_ddiv(double,double);
 
 #ifdef __cplusplus
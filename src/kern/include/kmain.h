@@ -34,7 +34,7 @@
 extern "C" {
 #endif
 
-#define MAX_TASKS   5
+#define MAX_TASKS   8
 
 /* some stack memory calculations */
 #define SIZE_TASK_STACK          1024U
@@ -50,6 +50,13 @@ extern "C" {
 
 #define TASK_READY_STATE  0x00
 #define TASK_BLOCKED_STATE  0XFF
+#define TASK_RUNNING_STATE  0x01
+#define TASK_SLEEPING_STATE  0x02
+#define TASK_TERMINATED_STATE  0x03
+#define TASK_PERIOD_STATE  0x04
+
+#define TASK_MAGIC  0xFECABAA0U
+#define TASK_FIRST_ID  1000U
 
 #define INTERRUPT_DISABLE()  do{__asm volatile ("MOV R0,#0x1"); asm volatile("MSR PRIMASK,R0"); } while(0)
 
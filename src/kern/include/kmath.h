@@ -36,6 +36,7 @@ extern "C" {
 
 #include <stdint.h>
 uint32_t __pow(uint32_t,uint32_t);
+uint64_t __udiv64(uint64_t,uint64_t);
 
 #ifdef __cplusplus
 }
@@ -10,13 +10,12 @@ extern "C" {
 #include <stdint.h>
 
 #define SOTOM_DEBUG_FLAG 1
-#define SRAM_REFRESH_TIME_GAP_MS 2000
 
 /*
    __debugRamUsage(void):
-   this funtion will get the ram usage. This function will take the highest
-   value of ram usage of last SRAM_REFRESH_TIME_GAP_MS milliseconds and save the
-   value to CURRENT_MSP
+   this funtion will get the ram usage. It scans the painted main stack
+   (kstack.h) on demand and saves the deepest MSP reached since reset
+   to CURRENT_MSP
 */
 void __debugRamUsage(void);
 void __digitalWriteDebugButton(uint8_t pin, uint8_t value);
@@ -12,7 +12,6 @@ extern "C" {
 #define TIM2_TICK_TIME_US_DIV (uint32_t)((TIM2_TICK_TIME)/1000000U)
 #define TIM2_ARR (uint32_t)1000U // 1ms //max: 0xffffffff - 1
 
-extern void SYS_ROUTINE(void);
 extern void TIM2_Handler(void);
 
 void ConfigTimer2ForSystem(void);
@@ -31,6 +31,65 @@
 #ifndef _SYSCALL_H
 #define _SYSCALL_H
 #include <stdint.h>
-void syscall(uint16_t);
+#include <syscall_def.h>
+#ifdef HOST_SIM
+#include <host_sim.h>
 #endif
+/*
+* System calls: "svc #n" with n from syscall_def.h and up to four arguments
+* in r0-r3. SVCall_Handler (assembly) reads n from the svc instruction
+* before the stacked PC and calls syscall() with the exception frame, which
+* runs syscall_table[n] on the stacked r0-r3. A handler returns a value or
+* -errno; the result goes back in the stacked r0 (-1 on error) and the
+* errno in r1, so the task sees both in registers when svc returns.
+*
+* Syscalls are made from thread mode only, never with interrupts masked.
+* SVCall runs at the lowest priority, like PendSV: a syscall can wait for a
+* device interrupt (write to a full console ring) or a few ticks (SysTick is
+* one level above), and the task switch it asks for (yield, nanosleep,
+* _exit) happens when it returns.
+*/
+#define SYSCALL_NR              (SYS_ring_enter + 1)
+#define SYSCALL_ERRNO_MAX       4095U       /* -1..-4095 are errors, larger values are results */
+#define SYSCALL_NULL_BUDGET     80U         /* cycles for the SYS_getpid round trip, checked by kbench */
+#define SYSCALL_RESTART         512U        /* a handler returning -SYSCALL_RESTART blocked the task; the
+                                               svc runs again with the same r0-r3 when it resumes (poll) */
+
+/* arguments and results are register wide (pointers on the 64-bit host build) */
+typedef intptr_t (*syscall_fn)(uintptr_t a0, uintptr_t a1, uintptr_t a2, uintptr_t a3);
+
+/* C part of SVCall_Handler: frame is the stacked r0-r3, r12, lr, pc, xpsr */
+void syscall(uintptr_t *frame, uint32_t callno);
+/* "write" for SYS_write, NULL for a number without a handler */
+const char *syscall_name(uint32_t callno);
+/* errno of the calling task's last failed syscall */
+int32_t *__errno(void);
+
+static __inline intptr_t __syscall_ret(uintptr_t r0, uintptr_t r1)
+{
+	if((intptr_t)r0 == -1)
+		*__errno() = (int32_t)r1;
+	return (intptr_t)r0;
+}
 
+/* n has to be a constant: it is encoded in the svc instruction */
+#ifndef HOST_SIM
+#define SYSCALL(n, a0, a1, a2, a3) ({ \
+	register uint32_t __r0 __asm__("r0") = (uint32_t)(a0); \
+	register uint32_t __r1 __asm__("r1") = (uint32_t)(a1); \
+	register uint32_t __r2 __asm__("r2") = (uint32_t)(a2); \
+	register uint32_t __r3 __asm__("r3") = (uint32_t)(a3); \
+	__asm__ volatile("svc %[no]" : "+r"(__r0), "+r"(__r1) : [no] "i"(n), "r"(__r2), "r"(__r3) : "memory"); \
+	__syscall_ret(__r0, __r1); })
+#else
+#define SYSCALL(n, a0, a1, a2, a3) ({ \
+	uintptr_t __f[8] = { (uintptr_t)(a0), (uintptr_t)(a1), (uintptr_t)(a2), (uintptr_t)(a3), 0, 0, 0, 0 }; \
+	host_sim_svc((n), __f); \
+	__syscall_ret(__f[0], __f[1]); })
+#endif
+#define SYSCALL0(n)             SYSCALL(n, 0, 0, 0, 0)
+#define SYSCALL1(n, a0)         SYSCALL(n, a0, 0, 0, 0)
+#define SYSCALL2(n, a0, a1)     SYSCALL(n, a0, a1, 0, 0)
+#define SYSCALL3(n, a0, a1, a2) SYSCALL(n, a0, a1, a2, 0)
+
+#endif
@@ -36,23 +36,53 @@
 #include <kstdio.h>
 #include <sys_rtc.h>
 #include <kstring.h>
+#include <kbench.h>
+#include <kconsole.h>
+#include <kprof.h>
+#include <kreplay.h>
+#include <kstream.h>
+#include <thread.h>
+#include <schedule.h>
 
 #ifndef DEBUG
 #define DEBUG 1
 #endif
-void kmain(void)
-{   
-    uint32_t count = 0;
-    __sys_init();
+/* console commands and the USART6 streams; sleeps until one of them queues work */
+static void console_task(void *arg)
+{
+    uint32_t ms = KWORK_FOREVER;
+    (void)arg;
     while (1)
     {
+        kconsole_wait(ms); // USART2 input, profiler and replay frames queue work here
+        /* a full USART6 ring leaves frames behind, retry until it drains */
+        ms = (kprof_poll() != 0 || kreplay_poll() != 0) ? KSTREAM_RETRY_MS : KWORK_FOREVER;
+    }
+}
 
+static void report_task(void *arg)
+{
+    uint32_t count = 0;
+    (void)arg;
+    while (1)
+    {
         kprintf("Nafis Shyan\r\n");
         kprintf("2021811186\r\n");
         kprintf("Roll: 10\r\n");
         kprintf("------------------\r\n");
         kprintf("Count: %d\r\n", count);
         count++;
-        wait_until(2500);
+        task_sleep(2500);
     }
 }
+
+void kmain(void)
+{   
+    __sys_init();
+#ifdef KBENCH
+    kbench_run(); // cycle counts of kstring/kstdio/kfloat as CSV on the console
+#endif
+    task_create("console", console_task, NULL, 4);
+    task_create("report", report_task, NULL, 8);
+    ksched_start(); // does not return; handlers keep using the main stack (MSP)
+}
@@ -36,6 +36,9 @@
 #include <system_config.h>
 #include <cm4.h>
 #include <cmd_def.h>
+#include <kreplay.h>
+#include <thread.h>
+#include <vfs.h>
 
 
 /*  Define the device uart and pc uart below according to your setup  */
@@ -78,9 +81,17 @@ void static store_char(unsigned char c, UART_HandleTypeDef *huart)
 	{
 		buffer->buffer[buffer->head] = c;
 		buffer->head = i;
+	}else
+	{
+		buffer->dropped++;
 	}
 }
 
+void Uart_rx_inject(UART_HandleTypeDef *huart, unsigned char c)
+{
+	store_char(c, huart);
+}
+
 int Look_for(char *str, char *buffertolookinto)
 {
 	unsigned int stringlength = __strlen((uint8_t *)str);
@@ -127,7 +138,7 @@ repeat1:
 		indx++;
 	if (startString[so_far] == buffertocopyfrom[indx])
 	{
-		while (startString[so_far] == buffertocopyfrom[indx])
+		while (so_far < startStringLength && startString[so_far] == buffertocopyfrom[indx])
 		{
 			so_far++;
 			indx++;
@@ -149,7 +160,7 @@ repeat2:
 		indx++;
 	if (endString[so_far] == buffertocopyfrom[indx])
 	{
-		while (endString[so_far] == buffertocopyfrom[indx])
+		while (so_far < endStringLength && endString[so_far] == buffertocopyfrom[indx])
 		{
 			so_far++;
 			indx++;
@@ -224,23 +235,32 @@ void Uart_write(int c, UART_HandleTypeDef *uart)
 	if (!IS_USART_INSTANCE(uart->Instance))
 		return;
 	unsigned int i;
+	uint32_t pm;
 	if (c >= 0)
 	{
-		if((uart->pTxBuffPtr->head + 1) == uart->TxXferSize)
-		{
-			i =0 ;
-		}else
+		// Tasks preempt each other: head is read and advanced with interrupts
+		// off so two writers never claim the same slot.
+		for(;;)
 		{
-			i=uart->pTxBuffPtr->head + 1;
+			pm = __irq_save();
+			if((uart->pTxBuffPtr->head + 1) == uart->TxXferSize)
+			{
+				i =0 ;
+			}else
+			{
+				i=uart->pTxBuffPtr->head + 1;
+			}
+			if(i != uart->pTxBuffPtr->tail)
+				break;
+			__irq_restore(pm);
+			// If the output buffer is full, there's nothing for it other than to
+			// wait for the interrupt handler to empty it a bit
+			while (i == uart->pTxBuffPtr->tail);
 		}
 
-		// If the output buffer is full, there's nothing for it other than to
-		// wait for the interrupt handler to empty it a bit
-		// ???: return 0 here instead?
-		while (i == uart->pTxBuffPtr->tail);
-
 		uart->pTxBuffPtr->buffer[uart->pTxBuffPtr->head] = (uint8_t)c;
 		uart->pTxBuffPtr->head = i;
+		__irq_restore(pm);
 
 		__UART_ENABLE_IT(uart, UART_IT_TXE); // Enable UART transmission interrupt
 	}
@@ -256,15 +276,50 @@ int IsDataAvailable(UART_HandleTypeDef *uart)
 		return -1;
 }
 
+#ifdef MS_TIMEOUT
+#define RX_TIMEOUT_MS (MS_TIMEOUT * 1000U)
+#else
+#define RX_TIMEOUT_MS 0U
+#endif
+
+/*
+* Until uart has data. A task sleeps in vfs_wait, woken by uart_notify; boot
+* code and a replay run (timed while it parses) spin. 0 once ms (0: no
+* limit) have passed since start (__getTime).
+*/
+static int rx_wait(UART_HandleTypeDef *uart, uint32_t start, uint32_t ms)
+{
+	while (!IsDataAvailable(uart))
+	{
+		uint32_t spent = __getTime() - start;
+		if (ms != 0 && spent >= ms)
+			return 0;
+		if (task_self() != NULL && !__in_handler() && !kreplay_playing)
+			vfs_wait(uart, POLLIN, ms != 0 ? (int32_t)(ms - spent) : -1);
+	}
+	return 1;
+}
+
+/* a task parses the port as the reader of its node, like read() does (vfs_own) */
+static int rx_claim(UART_HandleTypeDef *uart)
+{
+	const vfs_node *n;
+	if (task_self() == NULL || __in_handler())
+		return 1;
+	n = vfs_lookup_dev(uart);
+	return n == NULL || vfs_own(n) == SYS_OK;
+}
+
 int Get_after(char *string, uint8_t numberofchars, char *buffertosave, UART_HandleTypeDef *uart)
 {
+	if (!rx_claim(uart))
+		return -1;
 
 	while (Wait_for(string, uart) != 1)
 		;
 	for (int indx = 0; indx < numberofchars; indx++)
 	{
-		while (!(IsDataAvailable(uart)))
-			;
+		rx_wait(uart, 0, 0);
 		buffertosave[indx] = (char)Uart_read(uart);
 	}
 	return 1;
@@ -305,16 +360,16 @@ int Copy_upto(char *string, char *buffertocopyinto, UART_HandleTypeDef *uart)
 	int len = (int)__strlen((uint8_t *)string);
 	int indx = 0;
 
+	if (!rx_claim(uart))
+		return -1;
 again:
-	while (!IsDataAvailable(uart))
-		;
+	rx_wait(uart, 0, 0);
 	while (Uart_peek(uart) != string[so_far])
 	{
 		buffertocopyinto[indx] = uart->pRxBuffPtr->buffer[uart->pRxBuffPtr->tail];
 		uart->pRxBuffPtr->tail = (unsigned int)(uart->pRxBuffPtr->tail + 1) % uart->RxXferSize;
 		indx++;
-		while (!IsDataAvailable(uart))
-			;
+		rx_wait(uart, 0, 0);
 	}
 	while (Uart_peek(uart) == string[so_far])
 	{
@@ -322,8 +377,7 @@ again:
 		buffertocopyinto[indx++] = (char)Uart_read(uart);
 		if (so_far == len)
 			return 1;
-		while (!IsDataAvailable(uart))
-			;
+		rx_wait(uart, 0, 0);
 	}
 
 	if (so_far != len)
@@ -343,16 +397,11 @@ int Wait_for(char *string, UART_HandleTypeDef *uart)
 	int so_far = 0;
 	int len = (int)__strlen((uint8_t *)string);
 	uint32_t c_time=__getTime();
+	if (!rx_claim(uart))
+		return -1;
 again_device:
-	while (!IsDataAvailable(uart))
-	{
-		#ifdef MS_TIMEOUT
-			if((__getTime()-c_time) >= MS_TIMEOUT*1000)
-			{
-				return SYS_TIMEOUT;
-			} 
-		#endif
-	}
+	if (!rx_wait(uart, c_time, RX_TIMEOUT_MS))
+		return SYS_TIMEOUT;
 	if (Uart_peek(uart) != string[so_far])
 	{
 		uart->pRxBuffPtr->tail = (unsigned int)(uart->pRxBuffPtr->tail + 1) % uart->RxXferSize;
@@ -364,15 +413,8 @@ again_device:
 		Uart_read(uart);
 		if (so_far == len)
 			return 1;
-		while (!IsDataAvailable(uart))
-		{
-		#ifdef MS_TIMEOUT
-			if((__getTime()-c_time) >= MS_TIMEOUT*1000)
-			{
-				return SYS_TIMEOUT;
-			} 
-		#endif
-		}
+		if (!rx_wait(uart, c_time, RX_TIMEOUT_MS))
+			return SYS_TIMEOUT;
 	}
 
 	if (so_far != len)
@@ -465,8 +507,11 @@ Uart_isr(UART_HandleTypeDef *huart)
 	uint32_t cr1its = READ_REG(huart->Instance->CR1);
 	uint32_t tmp;
 	unsigned char c;
+	KREPLAY_ISR(huart);
 	if (((isrflags & USART_SR_NE) != RESET) || ((isrflags & USART_SR_ORE) != RESET) || ((isrflags & USART_SR_FE) != RESET))
 	{
+		if ((isrflags & USART_SR_ORE) != RESET)
+			huart->pRxBuffPtr->dropped++;
 		tmp = huart->Instance->SR;
 		tmp |= (tmp | huart->Instance->DR);
 		return;
@@ -489,6 +534,7 @@ Uart_isr(UART_HandleTypeDef *huart)
 		huart->Instance->SR; /* Read status register */
 
 		c = (unsigned char)(huart->Instance->DR); /* Read data register */
+		KREPLAY_RECORD(huart, c);
 		store_char(c, huart);					  // store data in buffer
 
 		return;
@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#include <kbench.h>
+#include <cm4.h>
+#include <kstdio.h>
+#include <kstring.h>
+#include <kfloat.h>
+#include <ktrace.h>
+#include <kqueue.h>
+#include <ksync.h>
+#include <syscall.h>
+#include <kdata.h>
+#include <kring.h>
+#include <kstrace.h>
+
+typedef void (*bench_fn)(void);
+
+typedef struct bench_case_t
+{
+	char *name;
+	bench_fn fn;
+	uint32_t bytes;		/* bytes touched per call, 0 when not a byte routine */
+}bench_case;
+
+/*
+* Inputs live in volatile objects and results are written to a volatile
+* sink so the compiler can neither fold nor drop the calls.
+*/
+static uint8_t bench_buf[KBENCH_MAX_LEN + 1];
+static uint8_t bench_num[16];
+static volatile uint32_t bench_len;
+static volatile double bench_d1 = 1234.5678;
+static volatile double bench_d2 = 56.25;
+static volatile float bench_f = 3.14159f;
+static volatile int bench_i = -1234567;
+static volatile uint32_t bench_u = 0xDEADBEEF;
+static volatile uint64_t bench_sink;
+static volatile double bench_dsink;
+static volatile float bench_fsink;
+static uint32_t bench_overhead_x100;
+
+static void bench_nop(void) { }
+static void bench_kmemset(void) { bench_sink = *(uint8_t*)kmemset(bench_buf, 0x5A, bench_len); }
+static void bench_strlen(void) { bench_sink = __strlen(bench_buf); }
+static void bench_convert(void) { bench_sink = *convert(bench_i, 10); }
+static void bench_convert16(void) { bench_sink = *convert(bench_i, 16); }
+static void bench_convertu32(void) { bench_sink = *convertu32(bench_u, 10); }
+static void bench_convertu32_16(void) { bench_sink = *convertu32(bench_u, 16); }
+static void bench_float2str(void) { bench_sink = *float2str(bench_f); }
+static void bench_str_to_num(void) { bench_sink = (uint32_t)__str_to_num(bench_num, 10); }
+/* str2float cuts the string at '.', so the input is restored (two stores) each call */
+static void bench_str2float(void)
+{
+	__builtin_memcpy(bench_num, "1234.567", 9);
+	bench_fsink = str2float(bench_num);
+}
+static void bench_f2d(void) { bench_dsink = __aeabi_f2d(bench_f); }
+static void bench_d2f(void) { bench_fsink = __aeabi_d2f(bench_d1); }
+static void bench_d2iz(void) { bench_sink = (uint32_t)__aeabi_d2iz(bench_d1); }
+static void bench_d2i(void) { bench_sink = (uint32_t)__aeabi_d2i(bench_d1); }
+static void bench_decimal(void) { bench_sink = get_decimal_part(bench_d1); }
+static void bench_d2uiz(void) { bench_sink = __aeabi_d2uiz(bench_d1); }
+static void bench_d2ulz(void) { bench_sink = __aeabi_d2ulz(bench_d1); }
+static void bench_dadd(void) { bench_dsink = __aeabi_dadd(bench_d1, bench_d2); }
+static void bench_dsub(void) { bench_dsink = __aeabi_dsub(bench_d1, bench_d2); }
+static void bench_dmul(void) { bench_dsink = __aeabi_dmul(bench_d1, bench_d2); }
+static void bench_ddiv(void) { bench_dsink = __aeabi_ddiv(bench_d1, bench_d2); }
+static void bench_dcmpeq(void) { bench_sink = __aeabi_dcmpeq(bench_d1, bench_d2); }
+static void bench_ktrace(void) { KTRACE_MARK(0, bench_len); }
+
+/* one record in and out again, no consumer waiting */
+typedef struct { uint32_t w[4]; } bench_msg;
+KSPSC_DEFINE(kbench_spsc, bench_msg, 8);
+KMPSC_DEFINE(kbench_mpsc, bench_msg, 8);
+static bench_msg bench_rec;
+static void bench_spsc_put_get(void) { kspsc_put(&kbench_spsc, &bench_rec); bench_sink = kspsc_get(&kbench_spsc, &bench_rec); }
+static void bench_mpsc_put_get(void) { kmpsc_put(&kbench_mpsc, &bench_rec); bench_sink = kmpsc_get(&kbench_mpsc, &bench_rec); }
+
+/* uncontended fast paths, one CAS each; the benchmark runs before the scheduler, so no kmutex row */
+static ksem bench_sem = KSEM_INIT(0);
+static void bench_sem_give_take(void) { ksem_give(&bench_sem); bench_sink = ksem_trytake(&bench_sem); }
+
+/* null syscall round trip: svc, SVCall_Handler, table dispatch, exception return */
+static void bench_svc_getpid(void) { bench_sink = (uint32_t)SYSCALL0(SYS_getpid); }
+/* the same answers from the kernel data page, no svc */
+static void bench_kdata_pid(void) { bench_sink = kdata_pid(); }
+static void bench_kdata_us(void) { bench_sink = kdata_us(); }
+
+/* one ring_enter for KBENCH_RING_BATCH NOP entries, completions reaped */
+#define KBENCH_RING_BATCH   16U
+KRING_DEFINE(kbench_ring, KBENCH_RING_BATCH);
+static void bench_kring_nop16(void)
+{
+	for(uint32_t i = 0; i < KBENCH_RING_BATCH; i++)
+		kring_prep(&kbench_ring, KRING_OP_NOP, 0, NULL, 0, i);
+	bench_sink = (uint32_t)kring_submit(&kbench_ring);
+	while(kring_peek_cqe(&kbench_ring) != NULL)
+		kring_cqe_seen(&kbench_ring);
+}
+
+static bench_case bench_sized[] = {
+	{ "kmemset", bench_kmemset, 0 },
+	{ "__strlen", bench_strlen, 0 },
+};
+
+static uint32_t bench_sizes[] = { 16, 64, 256, KBENCH_MAX_LEN };
+
+static bench_case bench_fixed[] = {
+	{ "convert_10", bench_convert, 0 },
+	{ "convert_16", bench_convert16, 0 },
+	{ "convertu32_10", bench_convertu32, 0 },
+	{ "convertu32_16", bench_convertu32_16, 0 },
+	{ "float2str", bench_float2str, 0 },
+	{ "__str_to_num", bench_str_to_num, 6 },
+	{ "str2float", bench_str2float, 8 },
+	{ "__aeabi_f2d", bench_f2d, 0 },
+	{ "__aeabi_d2f", bench_d2f, 0 },
+	{ "__aeabi_d2iz", bench_d2iz, 0 },
+	{ "__aeabi_d2i", bench_d2i, 0 },
+	{ "get_decimal_part", bench_decimal, 0 },
+	{ "__aeabi_d2uiz", bench_d2uiz, 0 },
+	{ "__aeabi_d2ulz", bench_d2ulz, 0 },
+	{ "__aeabi_dadd", bench_dadd, 0 },
+	{ "__aeabi_dsub", bench_dsub, 0 },
+	{ "__aeabi_dmul", bench_dmul, 0 },
+	{ "__aeabi_ddiv", bench_ddiv, 0 },
+	{ "__aeabi_dcmpeq", bench_dcmpeq, 0 },
+	{ "kspsc_put_get", bench_spsc_put_get, 16 },
+	{ "kmpsc_put_get", bench_mpsc_put_get, 16 },
+	{ "ksem_give_take", bench_sem_give_take, 0 },
+	{ "kdata_pid", bench_kdata_pid, 0 },
+	{ "kdata_us", bench_kdata_us, 0 },
+};
+
+/*
+* One batch of KBENCH_ITERS calls; kept out of line so the indirect call
+* is the same for every routine, including the empty one.
+*/
+static uint32_t __attribute__((noinline)) bench_batch(bench_fn fn)
+{
+	uint32_t t0 = __getCycleCount();
+	for(uint32_t i = 0; i < KBENCH_ITERS; i++)
+	{
+		fn();
+	}
+	return __getCycleCount() - t0;
+}
+
+/* prints v/scale with a fixed number of decimals (scale 100 or 1000) */
+static void bench_print_fixed(uint32_t v, uint32_t scale)
+{
+	uint32_t frac = v % scale;
+	kprintf("%d.", v / scale);
+	for(uint32_t d = scale / 10; d > 1 && frac < d; d /= 10)
+	{
+		kprintf("0");
+	}
+	kprintf("%d", frac);
+}
+
+/*
+* Runs one case and prints its line. Cycle figures are per call in
+* hundredths of a cycle: the minimum over all batches and the mean.
+* Returns the minimum.
+*/
+static uint32_t bench_measure(bench_case *bc, uint32_t bytes, uint32_t subtract)
+{
+	uint32_t min = 0xFFFFFFFF, sum = 0, mean;
+	bench_fn fn = bc->fn;
+
+	fn();	/* warm up */
+	for(uint32_t r = 0; r < KBENCH_REPS; r++)
+	{
+		uint32_t per_call = (bench_batch(fn) * 100U) / KBENCH_ITERS;
+		per_call = (per_call > subtract) ? per_call - subtract : 0;
+		if(per_call < min) min = per_call;
+		sum += per_call;
+	}
+	mean = sum / KBENCH_REPS;
+	kprintf("%s,%d,", bc->name, bytes);
+	bench_print_fixed(min, 100);
+	kprintf(",");
+	bench_print_fixed(mean, 100);
+	kprintf(",");
+	if(bytes != 0 && min != 0)
+	{
+		bench_print_fixed((bytes * 100000U) / min, 1000);
+	}else
+	{
+		kprintf("-");
+	}
+	kprintf("\n");
+	if(bc->fn == bench_nop)
+	{
+		bench_overhead_x100 = min;
+	}
+	return min;
+}
+
+void kbench_run(void)
+{
+	bench_case nop = { "call_overhead", bench_nop, 0 };
+
+	for(uint32_t i = 0; i < 6; i++)
+	{
+		bench_num[i] = (uint8_t)('1' + i);
+	}
+	bench_num[6] = '\0';
+#ifndef HOST_SIM
+	kprintf("# kbench clock=dwt hz=%d reps=%d iters=%d\n", 180000000, KBENCH_REPS, KBENCH_ITERS);
+#else
+	kprintf("# kbench clock=monotonic hz=%d reps=%d iters=%d\n", (int)HOST_SIM_HCLK, KBENCH_REPS, KBENCH_ITERS);
+#endif
+	kprintf("name,bytes,cycles_min,cycles_mean,bytes_per_cycle\n");
+	bench_measure(&nop, 0, 0);
+	kprintf("# call_overhead is subtracted from every line below\n");
+	for(uint32_t s = 0; s < sizeof(bench_sizes)/sizeof(bench_sizes[0]); s++)
+	{
+		bench_len = bench_sizes[s];
+		kmemset(bench_buf, 'a', bench_len);
+		bench_buf[bench_len] = '\0';
+		for(uint32_t c = 0; c < sizeof(bench_sized)/sizeof(bench_sized[0]); c++)
+		{
+			bench_measure(&bench_sized[c], bench_len, bench_overhead_x100);
+		}
+	}
+	for(uint32_t c = 0; c < sizeof(bench_fixed)/sizeof(bench_fixed[0]); c++)
+	{
+		bench_measure(&bench_fixed[c], bench_fixed[c].bytes, bench_overhead_x100);
+	}
+	/* cost of one trace event, with the trace off and on */
+	{
+		bench_case off = { "ktrace_off", bench_ktrace, 0 };
+		bench_case on = { "ktrace_on", bench_ktrace, 0 };
+		uint32_t was_on = ktrace_enabled;
+		ktrace_enabled = 0;
+		bench_measure(&off, 0, bench_overhead_x100);
+		ktrace_enabled = 1;
+		bench_measure(&on, 0, bench_overhead_x100);
+		ktrace_enabled = was_on;
+	}
+	{
+		bench_case svc = { "svc_getpid", bench_svc_getpid, 0 };
+		uint32_t min = bench_measure(&svc, 0, bench_overhead_x100);
+#ifndef HOST_SIM
+		kprintf("# svc_getpid budget %d cycles: %s\n", SYSCALL_NULL_BUDGET,
+			min <= SYSCALL_NULL_BUDGET * 100U ? "ok" : "OVER");
+#else
+		(void)min; // the simulated svc is a function call, no budget
+#endif
+		svc.name = "svc_getpid_strace"; // the same call recorded by kstrace
+		kstrace_start(KSTRACE_ALL);
+		bench_measure(&svc, 0, bench_overhead_x100);
+		kstrace_stop();
+		kstrace_reset();
+	}
+	/* the same trap shared by a batch: per entry cost against svc_getpid above */
+	if(kring_setup(&kbench_ring, 0) == 0)
+	{
+		bench_case ring = { "kring_nop16", bench_kring_nop16, 0 };
+		uint32_t min = bench_measure(&ring, 0, bench_overhead_x100);
+		kprintf("# kring_nop16 per entry ");
+		bench_print_fixed(min / KBENCH_RING_BATCH, 100);
+		kprintf(" cycles\n");
+	}
+	kprintf("# __aeabi_ui2d skipped: its digit-count loop never terminates\n");
+	kprintf("# kbench done\n");
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#include <kboot.h>
+#include <kconsole.h>
+#include <kstdio.h>
+#include <kmath.h>
+#include <sys_clock.h>
+#include <sys_bus_matrix.h>
+
+/* lives in .bss: Reset_Handler keeps its first stamps in registers until it is zeroed */
+static uint32_t kboot_cycles[KBOOT_NUM_STAGES];
+static uint8_t kboot_mhz[KBOOT_NUM_STAGES];
+static uint8_t kboot_seen[KBOOT_NUM_STAGES];
+
+static const char *kboot_names[KBOOT_NUM_STAGES] = {
+	[KBOOT_RESET] = "reset",
+	[KBOOT_DATA] = "data_copy",
+	[KBOOT_BSS] = "bss_zero",
+	[KBOOT_STACK] = "stack_paint",
+	[KBOOT_HSE] = "hse_ready",
+	[KBOOT_PLL] = "pll_lock",
+	[KBOOT_CLOCK] = "clock_switch",
+	[KBOOT_FPU] = "enable_fpu",
+	[KBOOT_SYSTICK] = "systick_init",
+	[KBOOT_USART2] = "seriallin2_init",
+	[KBOOT_USART6] = "seriallin6_init",
+	[KBOOT_RINGBUF] = "ringbuf_init",
+	[KBOOT_TIM2] = "timer2_init",
+	[KBOOT_SERVICES] = "kernel_services",
+	[KBOOT_SYSINFO] = "show_system_info",
+};
+
+/* core clock in MHz right now */
+static uint32_t kboot_clock(void)
+{
+#ifndef HOST_SIM
+	switch(RCC->CFGR & RCC_CFGR_SWS)
+	{
+		case RCC_CFGR_SWS_PLL: return __AHB_CLK();
+		case RCC_CFGR_SWS_HSE: return CRYSTAL_CLK;
+		default: return HSIRC_CLK;
+	}
+#else
+	return HOST_SIM_HCLK / 1000000UL;
+#endif
+}
+
+static uint32_t kboot_ns(uint32_t cycles, uint32_t mhz)
+{
+	return (uint32_t)__udiv64((uint64_t)cycles * 1000ULL, mhz);
+}
+
+void kboot_set(kboot_stage stage, uint32_t cycles)
+{
+	kboot_cycles[stage] = cycles;
+	kboot_mhz[stage] = (uint8_t)kboot_clock();
+	kboot_seen[stage] = 1;
+}
+
+uint32_t kboot_elapsed_ns(void)
+{
+	uint32_t ns = 0, last = 0, mhz = kboot_seen[KBOOT_RESET] ? kboot_mhz[KBOOT_RESET] : HSIRC_CLK;
+	for(uint32_t i = 0; i < KBOOT_NUM_STAGES; i++)
+	{
+		if(!kboot_seen[i]) continue;
+		if(i != KBOOT_RESET) ns += kboot_ns(kboot_cycles[i] - last, mhz);
+		last = kboot_cycles[i];
+		mhz = kboot_mhz[i];
+	}
+	return ns + kboot_ns(__getCycleCount() - last, mhz);
+}
+
+void kboot_report(void)
+{
+	uint32_t ns = 0, last = 0, mhz = kboot_seen[KBOOT_RESET] ? kboot_mhz[KBOOT_RESET] : HSIRC_CLK;
+	kprintf("stage,mhz,start_ns,cycles,ns\n");
+	for(uint32_t i = 0; i < KBOOT_NUM_STAGES; i++)
+	{
+		uint32_t cycles, d;
+		if(!kboot_seen[i]) continue;
+		cycles = (i == KBOOT_RESET) ? 0 : kboot_cycles[i] - last;
+		d = kboot_ns(cycles, mhz);
+		kprintf("%s,%d,%d,%d,%d\n", kboot_names[i], mhz, ns, cycles, d);
+		ns += d;
+		last = kboot_cycles[i];
+		mhz = kboot_mhz[i];
+	}
+	kprintf("# %d ns from reset to the end of __sys_init\n", ns);
+}
+
+static void cmd_boot(char *args)
+{
+	(void)args;
+	kboot_report();
+}
+
+void kboot_init(void)
+{
+	kconsole_register("boot", cmd_boot, "boot timeline from Reset_Handler");
+}
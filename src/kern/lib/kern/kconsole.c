@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#include <kconsole.h>
+#include <kstdio.h>
+#include <UsartRingBuffer.h>
+#include <system_config.h>
+#include <kwork.h>
+#include <vfs.h>
+#include <cm4.h>
+
+static kconsole_cmd cmd_table[KCONSOLE_MAX_CMDS];
+static uint32_t cmd_count = 0;
+static char line_buf[KCONSOLE_LINE_MAX];
+static uint32_t line_len = 0;
+/* input is read by the task that calls kconsole_wait, woken from the USART handler */
+static void kconsole_rx(void *arg) { (void)arg; kconsole_poll(); }
+static kworkq kconsole_wq;
+static kwork kconsole_rx_work;
+
+static void cmd_help(char *args)
+{
+	(void)args;
+	for(uint32_t i = 0; i < cmd_count; i++)
+	{
+		kprintf("%s\t%s\n", cmd_table[i].name, cmd_table[i].help);
+	}
+}
+
+void kconsole_init(void)
+{
+	uint32_t pm;
+	cmd_count = 0;
+	line_len = 0;
+	pm = __irq_save(); // the USART handlers are live already
+	kworkq_init(&kconsole_wq, "console");
+	kwork_init(&kconsole_rx_work, kconsole_rx, NULL);
+	__irq_restore(pm);
+	kconsole_register("help", cmd_help, "list commands");
+}
+
+void kconsole_rx_notify(void)
+{
+	kwork_queue(&kconsole_wq, &kconsole_rx_work);
+}
+
+StatusTypeDef kconsole_queue(kwork *w)
+{
+	return kwork_queue(&kconsole_wq, w);
+}
+
+uint32_t kconsole_wait(uint32_t ms)
+{
+	return kworkq_run(&kconsole_wq, ms);
+}
+
+StatusTypeDef kconsole_register(char *name, kconsole_fn fn, char *help)
+{
+	if(name == NULL || fn == NULL)
+	{
+		return SYS_ERROR;
+	}
+	if(cmd_count == KCONSOLE_MAX_CMDS)
+	{
+		return SYS_BUSY;
+	}
+	cmd_table[cmd_count].name = name;
+	cmd_table[cmd_count].fn = fn;
+	cmd_table[cmd_count].help = (help != NULL) ? help : "";
+	cmd_count++;
+	return SYS_OK;
+}
+
+uint8_t kconsole_match(char *a, char *b)
+{
+	while(*a && *a == *b)
+	{
+		a++;
+		b++;
+	}
+	return *a == *b;
+}
+
+char *kconsole_word(char **args)
+{
+	char *w = *args;
+	while(**args && **args != ' ')
+		(*args)++;
+	if(**args == ' ')
+	{
+		**args = '\0';
+		(*args)++;
+		while(**args == ' ')
+			(*args)++;
+	}
+	return w;
+}
+
+void kconsole_exec(char *line)
+{
+	char *args;
+	while(*line == ' ') line++;
+	if(*line == '\0')
+	{
+		return;
+	}
+	args = line;
+	while(*args != ' ' && *args != '\0') args++;
+	if(*args == ' ')
+	{
+		*args++ = '\0';
+		while(*args == ' ') args++;
+	}
+	for(uint32_t i = 0; i < cmd_count; i++)
+	{
+		if(kconsole_match(cmd_table[i].name, line))
+		{
+			cmd_table[i].fn(args);
+			return;
+		}
+	}
+	kprintf("%s: command not found\n", line);
+}
+
+static void kconsole_input(int c)
+{
+	if(c == '\r' || c == '\n')
+	{
+		if(line_len == 0 && c == '\n')
+		{
+			return;	/* second half of "\r\n" */
+		}
+		line_buf[line_len] = '\0';
+		line_len = 0;
+		kprintf("\n");
+		kconsole_exec(line_buf);
+		kprintf(KCONSOLE_PROMPT);
+	}else if(c == 0x08 || c == 0x7F)
+	{
+		if(line_len > 0)
+		{
+			line_len--;
+			kprintf("\b \b");
+		}
+	}else if(line_len < KCONSOLE_LINE_MAX - 1)
+	{
+		line_buf[line_len++] = (char)c;
+		Uart_write(c, __CONSOLE);
+	}
+}
+
+void kconsole_poll(void)
+{
+	uint8_t buf[16];
+	int32_t n;
+	if(vfs_own(&vfs_tty0) != SYS_OK)
+	{
+		return;	/* a task reads the console, its release queues us again */
+	}
+	while((n = vfs_tty0.ops->read(&vfs_tty0, buf, sizeof(buf), 0)) > 0)
+	{
+		for(int32_t i = 0; i < n; i++)
+		{
+			kconsole_input(buf[i]);
+		}
+	}
+	if(line_len == 0)
+	{
+		vfs_release(&vfs_tty0);	/* no command line open */
+	}
+}
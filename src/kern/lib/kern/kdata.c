@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <kdata.h>
+#include <kmain.h>
+#include <sys_bus_matrix.h>
+#include <sys_clock.h>
+
+kdata_page kdata_area __attribute__((aligned(KDATA_ALIGN)));
+static uint32_t rtc_last;
+
+static uint32_t kdata_mhz(void)
+{
+#ifndef HOST_SIM
+	return __AHB_CLK();
+#else
+	return HOST_SIM_HCLK / 1000000UL;
+#endif
+}
+
+void kdata_init(void)
+{
+	kdata_area.seq++;
+	__DMB();
+	kdata_area.cycles_per_us = kdata_mhz();
+	kdata_area.us_per_tick = 1000000U / TICK_HZ;
+	kdata_area.ticks = getmsTick();
+	kdata_area.tick_cycles = __getCycleCount();
+	kdata_area.rtc_valid = 0;
+	__DMB();
+	kdata_area.seq++;
+	rtc_last = kdata_area.ticks - TICK_HZ; // read the RTC at the first tick
+}
+
+void kdata_tick(void)
+{
+	uint32_t now = getmsTick();
+	kdata_area.seq++;
+	__DMB();
+	kdata_area.ticks = now;
+	kdata_area.tick_cycles = __getCycleCount();
+	if(now - rtc_last >= TICK_HZ)
+	{
+		rtc_last = now;
+		kdata_area.rtc_valid = (RCC->BDCR & RCC_BDCR_RTCEN) != 0;
+		if(kdata_area.rtc_valid)
+		{
+			kdata_area.rtc_time = RTC->TR; // BYPSHAD: read straight from the counters
+			kdata_area.rtc_date = RTC->DR;
+		}
+	}
+	__DMB();
+	kdata_area.seq++;
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#include <kirqlat.h>
+#include <kconsole.h>
+#include <kstdio.h>
+#include <kstring.h>
+#include <cm4.h>
+
+volatile uint32_t kirqlat_armed = 0;
+volatile uint32_t kirqlat_t0 = 0;
+volatile uint32_t kirqlat_t1 = 0;
+
+static uint32_t kirqlat_samples[KIRQLAT_MAX_SAMPLES];
+static uint32_t kirqlat_overhead = 0;
+static uint32_t kirqlat_seed = 0x2545F491UL;
+
+static const int32_t kirqlat_irqs[] = { SysTick_IRQn, TIM2_IRQn, USART2_IRQn, USART6_IRQn };
+static const char *kirqlat_names[] = { "SysTick", "TIM2", "USART2", "USART6" };
+
+static uint32_t kirqlat_rand(void)
+{
+	/* xorshift32, only used to spread the trigger points */
+	kirqlat_seed ^= kirqlat_seed << 13;
+	kirqlat_seed ^= kirqlat_seed >> 17;
+	kirqlat_seed ^= kirqlat_seed << 5;
+	return kirqlat_seed;
+}
+
+static void kirqlat_spin(uint32_t cycles)
+{
+	uint32_t t0 = __getCycleCount();
+	while(__getCycleCount() - t0 < cycles)
+		;
+}
+
+static void kirqlat_pend(int32_t irqn)
+{
+	if(irqn == SysTick_IRQn)
+	{
+#ifndef HOST_SIM
+		SCB->ICSR = SCB_ICSR_PENDSTSET_Msk;
+#else
+		host_sim_irq_raise(SysTick_IRQn);
+#endif
+	}else
+	{
+		NVIC_SetPendingIRQ(irqn);
+	}
+}
+
+/* shell sort, the sample count is small and this runs outside the measurement */
+static void kirqlat_sort(uint32_t *v, uint32_t n)
+{
+	for(uint32_t gap = n / 2U; gap > 0; gap /= 2U)
+	{
+		for(uint32_t i = gap; i < n; i++)
+		{
+			uint32_t x = v[i];
+			uint32_t j = i;
+			while(j >= gap && v[j - gap] > x)
+			{
+				v[j] = v[j - gap];
+				j -= gap;
+			}
+			v[j] = x;
+		}
+	}
+}
+
+StatusTypeDef kirqlat_run(int32_t irqn, uint32_t samples, uint32_t load, kirqlat_result *res)
+{
+	uint32_t n = 0, missed = 0;
+	if(samples == 0 || samples > KIRQLAT_MAX_SAMPLES || load > 100U)
+	{
+		return SYS_ERROR;
+	}
+	for(uint32_t i = 0; i < samples; i++)
+	{
+		uint32_t crit = (kirqlat_rand() % 100U) < load;
+		uint32_t pm = 0, t;
+		kirqlat_spin(kirqlat_rand() & 0x3FFU);
+		if(crit)
+		{
+			pm = __irq_save();
+		}
+		kirqlat_armed = (uint32_t)(irqn + 16);
+		kirqlat_t0 = __getCycleCount();
+		kirqlat_pend(irqn);
+		if(crit)
+		{
+			kirqlat_spin(kirqlat_rand() % KIRQLAT_CRIT_MAX);
+			__irq_restore(pm);
+		}
+		t = __getCycleCount();
+		while(kirqlat_armed != 0 && __getCycleCount() - t < KIRQLAT_TIMEOUT)
+			;
+		if(kirqlat_armed != 0)
+		{
+			/* masked or disabled interrupt: disarm before the next trigger */
+			kirqlat_armed = 0;
+			missed++;
+			continue;
+		}
+		t = kirqlat_t1 - kirqlat_t0;
+		if((int32_t)t < 0)
+		{
+			/* a real interrupt of the same source stamped before the trigger */
+			missed++;
+			continue;
+		}
+		kirqlat_samples[n++] = (t > kirqlat_overhead) ? t - kirqlat_overhead : 0;
+	}
+	res->irqn = irqn;
+	res->samples = n;
+	res->missed = missed;
+	res->min = res->p50 = res->p99 = res->max = 0;
+	if(n == 0)
+	{
+		return SYS_TIMEOUT;
+	}
+	kirqlat_sort(kirqlat_samples, n);
+	res->min = kirqlat_samples[0];
+	res->p50 = kirqlat_samples[(n - 1U) / 2U];
+	res->p99 = kirqlat_samples[((n - 1U) * 99U) / 100U];
+	res->max = kirqlat_samples[n - 1U];
+	return SYS_OK;
+}
+
+void kirqlat_report(uint32_t samples, uint32_t load)
+{
+	kirqlat_result res;
+	kprintf("irq,samples,missed,load,min,p50,p99,max\n");
+	for(uint32_t i = 0; i < sizeof(kirqlat_irqs) / sizeof(kirqlat_irqs[0]); i++)
+	{
+		kirqlat_run(kirqlat_irqs[i], samples, load, &res);
+		kprintf("%s,%d,%d,%d,%d,%d,%d,%d\n", kirqlat_names[i], res.samples, res.missed, load,
+			res.min, res.p50, res.p99, res.max);
+	}
+	kprintf("# core cycles, stamp overhead %d removed\n", kirqlat_overhead);
+}
+
+static void cmd_irqlat(char *args)
+{
+	uint32_t samples = KIRQLAT_DEFAULT_SAMPLES, load = 0;
+	char *w = kconsole_word(&args);
+	if(w[0] != '\0')
+	{
+		samples = (uint32_t)__str_to_num((uint8_t*)w, 10);
+	}
+	w = kconsole_word(&args);
+	if(w[0] != '\0')
+	{
+		load = (uint32_t)__str_to_num((uint8_t*)w, 10);
+	}
+	if(samples == 0 || samples > KIRQLAT_MAX_SAMPLES || load > 100U)
+	{
+		kprintf("irqlat: samples 1..%d, load 0..100\n", KIRQLAT_MAX_SAMPLES);
+		return;
+	}
+	kirqlat_report(samples, load);
+}
+
+void kirqlat_init(void)
+{
+	uint32_t best = 0xFFFFFFFFUL;
+	/* the same store/compare/stamp sequence without the exception entry */
+	for(uint32_t i = 0; i < 16; i++)
+	{
+		kirqlat_armed = (uint32_t)(SysTick_IRQn + 16);
+		kirqlat_t0 = __getCycleCount();
+		kirqlat_entry(SysTick_IRQn);
+		if(kirqlat_t1 - kirqlat_t0 < best) best = kirqlat_t1 - kirqlat_t0;
+	}
+	kirqlat_overhead = best;
+	kconsole_register("irqlat", cmd_irqlat, "irq latency: irqlat [samples [load%]]");
+}
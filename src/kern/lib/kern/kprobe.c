@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#include <kprobe.h>
+#include <kconsole.h>
+#include <kstdio.h>
+#include <kmath.h>
+
+#define KPROBE_SITE(n) { .name = n, .min = 0xFFFFFFFFUL }
+
+kprobe_site kprobe_table[KPROBE_NUM_SITES] = {
+	[KPROBE_UART_ISR] = KPROBE_SITE("Uart_isr"),
+	[KPROBE_SYSTICK] = KPROBE_SITE("SysTick_Handler"),
+	[KPROBE_TIM2] = KPROBE_SITE("TIM2_Handler"),
+	[KPROBE_SPI_TXRX] = KPROBE_SITE("SPI_TransmitReceive"),
+	[KPROBE_KPRINTF] = KPROBE_SITE("kprintf"),
+};
+
+static uint32_t kprobe_overhead = 0;
+
+static void cmd_probe(char *args)
+{
+	if(kconsole_match(args, "reset"))
+	{
+		kprobe_reset();
+		return;
+	}
+	kprobe_dump();
+}
+
+void kprobe_init(void)
+{
+	kprobe_site cal = KPROBE_SITE("calibrate");
+	/* cost of an empty ENTER/EXIT pair, reported with the table */
+	for(uint32_t i = 0; i < 16; i++)
+	{
+		uint32_t t0 = __getCycleCount();
+		kprobe_record(&cal, __getCycleCount() - t0);
+	}
+	kprobe_overhead = cal.min;
+	kconsole_register("probe", cmd_probe, "cycle probes: probe [reset]");
+}
+
+void kprobe_reset(void)
+{
+	for(uint32_t i = 0; i < KPROBE_NUM_SITES; i++)
+	{
+		uint32_t pm = __irq_save();
+		kprobe_table[i].count = 0;
+		kprobe_table[i].min = 0xFFFFFFFFUL;
+		kprobe_table[i].max = 0;
+		kprobe_table[i].sum = 0;
+		for(uint32_t b = 0; b < KPROBE_HIST_BINS; b++)
+		{
+			kprobe_table[i].hist[b] = 0;
+		}
+		__irq_restore(pm);
+	}
+}
+
+void kprobe_dump(void)
+{
+	kprobe_site snap;
+	kprintf("# probe overhead=%d cycles\n", kprobe_overhead);
+	kprintf("site,count,min,max,mean,log2_hist\n");
+	for(uint32_t i = 0; i < KPROBE_NUM_SITES; i++)
+	{
+		/* copy first: kprintf itself is a probed site */
+		uint32_t pm = __irq_save();
+		snap = kprobe_table[i];
+		__irq_restore(pm);
+		if(snap.count == 0)
+		{
+			kprintf("%s,0,0,0,0,\n", snap.name);
+			continue;
+		}
+		kprintf("%s,%d,%d,%d,%d,", snap.name, snap.count, snap.min, snap.max,
+			(uint32_t)__udiv64(snap.sum, snap.count));
+		for(uint32_t b = 0; b < KPROBE_HIST_BINS; b++)
+		{
+			if(snap.hist[b] != 0)
+			{
+				kprintf("%d:%d ", b, snap.hist[b]);
+			}
+		}
+		kprintf("\n");
+	}
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#include <kprof.h>
+#include <kconsole.h>
+#include <kstdio.h>
+#include <kstring.h>
+#include <cm4.h>
+#include <sys_bus_matrix.h>
+#include <kstream.h>
+
+/*
+* Single producer (TIM5 ISR), single consumer (kprof_poll): head is only
+* written by the ISR and tail only by the consumer.
+*/
+static kprof_sample_type kprof_ring[KPROF_RING_SIZE];
+static volatile uint32_t kprof_head = 0;
+static volatile uint32_t kprof_tail = 0;
+static volatile uint32_t kprof_dropped = 0;
+static uint32_t kprof_hz = 0;
+/* queued on the console when a frame is complete, kprof_poll runs in kconsole_wait */
+static void kprof_drain(void *arg) { (void)arg; kprof_poll(); }
+static kwork kprof_work = KWORK_INIT(kprof_drain, NULL);
+
+void kprof_sample(uint32_t *frame)
+{
+	uint32_t head = kprof_head;
+	TIM5->SR = (uint32_t)~TIM_SR_UIF;
+	if(head - kprof_tail >= KPROF_RING_SIZE)
+	{
+		kprof_dropped++;
+		return;
+	}
+	/* hardware frame: r0 r1 r2 r3 r12 lr pc xpsr */
+	kprof_ring[head & (KPROF_RING_SIZE - 1U)].pc = frame[6];
+	kprof_ring[head & (KPROF_RING_SIZE - 1U)].lr = frame[5];
+	kprof_head = head + 1U;
+	if(head + 1U - kprof_tail == KPROF_FRAME_MAX)
+	{
+		kconsole_queue(&kprof_work);
+	}
+}
+
+#ifndef HOST_SIM
+/*
+* Bit 2 of EXC_RETURN tells which stack holds the frame. The FPU extended
+* frame keeps PC and LR at the same offsets. kprof_sample returns straight
+* to the exception return because LR is left untouched by the branch.
+*/
+__attribute__((naked)) void TIM5_Handler(void)
+{
+	asm volatile(
+		"tst lr, #4\n\t"
+		"ite eq\n\t"
+		"mrseq r0, msp\n\t"
+		"mrsne r0, psp\n\t"
+		"b kprof_sample\n\t"
+	);
+}
+#else
+/* the host has no exception frame; record where the simulator dispatched */
+void TIM5_Handler(void)
+{
+	uint32_t frame[8] = { 0 };
+	frame[6] = (uint32_t)(uintptr_t)__builtin_return_address(0);
+	kprof_sample(frame);
+}
+#endif
+
+StatusTypeDef kprof_start(uint32_t hz)
+{
+	if(hz == 0 || hz > KPROF_MAX_HZ)
+	{
+		return SYS_ERROR;
+	}
+	RCC->APB1ENR |= RCC_APB1ENR_TIM5EN;
+	TIM5->CR1 = 0;
+	TIM5->PSC = (KPROF_TIMER_CLK / 1000000U) - 1U;   /* 1 us per count */
+	TIM5->ARR = (1000000U / hz) - 1U;
+	TIM5->CNT = 0;
+	TIM5->EGR = TIM_EGR_UG;
+	TIM5->SR = (uint32_t)~TIM_SR_UIF;
+	TIM5->DIER = TIM_DIER_UIE;
+	kprof_hz = hz;
+	kprof_dropped = 0;
+	NVIC_SetPriority(TIM5_IRQn, 0);
+	NVIC_EnableIRQ(TIM5_IRQn);
+	TIM5->CR1 |= TIM_CR1_CEN;
+	return SYS_OK;
+}
+
+void kprof_stop(void)
+{
+	TIM5->CR1 &= ~TIM_CR1_CEN;
+	TIM5->DIER = 0;
+	NVIC_DisableIRQ(TIM5_IRQn);
+	kprof_hz = 0;
+	kconsole_queue(&kprof_work);	/* flush the partial frame */
+}
+
+uint32_t kprof_poll(void)
+{
+	uint8_t payload[2U + 8U * KPROF_FRAME_MAX];
+	uint32_t avail, n, drop, tail, pm;
+
+	for(;;)
+	{
+		tail = kprof_tail;
+		avail = kprof_head - tail;
+		drop = kprof_dropped;
+		if(avail == 0 && drop == 0)
+		{
+			return 0;
+		}
+		/* stream only whole frames while the profiler runs, flush the rest on stop */
+		if(avail < KPROF_FRAME_MAX && kprof_hz != 0 && drop == 0)
+		{
+			return 0;
+		}
+		n = (avail > KPROF_FRAME_MAX) ? KPROF_FRAME_MAX : avail;
+		if(drop > 0xFFFFU) drop = 0xFFFFU;
+		kstream_put16(payload, (uint16_t)drop);
+		for(uint32_t i = 0; i < n; i++)
+		{
+			kprof_sample_type *s = &kprof_ring[(tail + i) & (KPROF_RING_SIZE - 1U)];
+			kstream_put32(&payload[2U + 8U * i], s->pc);
+			kstream_put32(&payload[6U + 8U * i], s->lr);
+		}
+		if(kstream_send(KPROF_TYPE_SAMPLES, (uint8_t)n, payload, 2U + 8U * n) != SYS_OK)
+		{
+			return avail;	/* never block on the UART */
+		}
+		pm = __irq_save();
+		kprof_dropped -= drop;
+		__irq_restore(pm);
+		kprof_tail = tail + n;
+	}
+}
+
+static void cmd_prof(char *args)
+{
+	char *w = kconsole_word(&args);
+	if(kconsole_match(w, "stop"))
+	{
+		kprof_stop();
+		kprintf("prof: stopped\n");
+		return;
+	}
+	if(kconsole_match(w, "start"))
+	{
+		uint32_t hz = KPROF_DEFAULT_HZ;
+		w = kconsole_word(&args);
+		if(w[0] != '\0')
+		{
+			hz = (uint32_t)__str_to_num((uint8_t*)w, 10);
+		}
+		if(kprof_start(hz) != SYS_OK)
+		{
+			kprintf("prof: rate must be 1..%d Hz\n", KPROF_MAX_HZ);
+			return;
+		}
+		kprintf("prof: sampling at %d Hz on USART6\n", hz);
+		return;
+	}
+	kprintf("prof: %d Hz, %d queued, %d dropped\n", kprof_hz, kprof_head - kprof_tail, kprof_dropped);
+}
+
+void kprof_init(void)
+{
+	kconsole_register("prof", cmd_prof, "PC sampling: prof [start [hz]|stop]");
+}
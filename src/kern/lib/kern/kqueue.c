@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <kqueue.h>
+#include <cm4.h>
+#include <schedule.h>
+#include <thread.h>
+
+static void kqueue_copy(void *dst, const void *src, uint32_t size)
+{
+	uint8_t *d = (uint8_t*)dst;
+	const uint8_t *s = (const uint8_t*)src;
+	while(size--)
+		*d++ = *s++;
+}
+
+/* a put made the queue non-empty: hand the CPU to the consumer if it sleeps on it */
+static void kqueue_wake(TCB_TypeDef *volatile *waiter)
+{
+	TCB_TypeDef *t = __atomic_exchange_n(waiter, NULL, __ATOMIC_ACQ_REL);
+	if(t != NULL)
+		ksched_ready(t);
+}
+
+/*
+* Consumer side of *_wait: register as the waiter, re-check under __irq_save
+* (a put between the check and the block would otherwise be missed) and
+* block until kqueue_wake or the timeout readies the task.
+*/
+static StatusTypeDef kqueue_wait(TCB_TypeDef *volatile *waiter, StatusTypeDef (*get)(void *q, void *rec),
+	uint32_t (*empty)(void *q), void *q, void *rec, uint32_t ms)
+{
+	uint32_t start = getmsTick();
+	for(;;)
+	{
+		uint32_t pm, left = 0;
+		if(get(q, rec) == SYS_OK) return SYS_OK;
+		if(ms != KQUEUE_FOREVER)
+		{
+			uint32_t spent = getmsTick() - start;
+			if(spent >= ms) return SYS_TIMEOUT;
+			left = ms - spent;
+		}
+		pm = __irq_save();
+		*waiter = task_self();
+		if(empty(q))
+			ksched_block_timeout(TASK_BLOCKED_STATE, left);
+		__irq_restore(pm); // blocks here
+		*waiter = NULL; // timed out, or woken with the waiter already cleared
+	}
+}
+
+StatusTypeDef kspsc_init(kspsc *q, void *buf, uint32_t size, uint32_t capacity)
+{
+	if(!KQUEUE_POW2(capacity)) return SYS_ERROR;
+	q->buf = (uint8_t*)buf;
+	q->size = size;
+	q->mask = capacity - 1U;
+	q->head = 0;
+	q->tail = 0;
+	q->waiter = NULL;
+	q->full = 0;
+	return SYS_OK;
+}
+
+StatusTypeDef kspsc_put(kspsc *q, const void *rec)
+{
+	uint32_t head = q->head;
+	if(head - __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE) > q->mask)
+	{
+		q->full++;
+		return SYS_BUSY;
+	}
+	kqueue_copy(q->buf + (head & q->mask) * q->size, rec, q->size);
+	__atomic_store_n(&q->head, head + 1U, __ATOMIC_RELEASE);
+	if(q->waiter != NULL)
+		kqueue_wake(&q->waiter);
+	return SYS_OK;
+}
+
+StatusTypeDef kspsc_get(kspsc *q, void *rec)
+{
+	uint32_t tail = q->tail;
+	if(__atomic_load_n(&q->head, __ATOMIC_ACQUIRE) == tail) return SYS_ERROR;
+	kqueue_copy(rec, q->buf + (tail & q->mask) * q->size, q->size);
+	__atomic_store_n(&q->tail, tail + 1U, __ATOMIC_RELEASE);
+	return SYS_OK;
+}
+
+uint32_t kspsc_count(kspsc *q)
+{
+	return __atomic_load_n(&q->head, __ATOMIC_ACQUIRE) - q->tail;
+}
+
+static StatusTypeDef spsc_get(void *q, void *rec)
+{
+	return kspsc_get((kspsc*)q, rec);
+}
+
+static uint32_t spsc_empty(void *q)
+{
+	return kspsc_count((kspsc*)q) == 0;
+}
+
+StatusTypeDef kspsc_wait(kspsc *q, void *rec, uint32_t ms)
+{
+	return kqueue_wait(&q->waiter, spsc_get, spsc_empty, q, rec, ms);
+}
+
+StatusTypeDef kmpsc_init(kmpsc *q, void *buf, uint32_t *seq, uint32_t size, uint32_t capacity)
+{
+	if(!KQUEUE_POW2(capacity) || capacity < 2U) return SYS_ERROR;
+	q->buf = (uint8_t*)buf;
+	q->seq = seq;
+	q->size = size;
+	q->mask = capacity - 1U;
+	q->head = 0;
+	q->tail = 0;
+	q->waiter = NULL;
+	q->full = 0;
+	for(uint32_t i = 0; i < capacity; i++)
+		seq[i] = 0;
+	return SYS_OK;
+}
+
+StatusTypeDef kmpsc_put(kmpsc *q, const void *rec)
+{
+	uint32_t pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+	for(;;)
+	{
+		uint32_t lap = pos & ~q->mask;
+		int32_t d = (int32_t)(__atomic_load_n(&q->seq[pos & q->mask], __ATOMIC_ACQUIRE) - lap);
+		if(d == 0)
+		{
+			// free in this lap: claim it, pos is reloaded when another producer won
+			if(__atomic_compare_exchange_n(&q->head, &pos, pos + 1U, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		}else if(d < 0)
+		{
+			__atomic_fetch_add(&q->full, 1U, __ATOMIC_RELAXED);
+			return SYS_BUSY; // the consumer has not freed it yet: full
+		}else
+		{
+			pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED); // claimed meanwhile
+		}
+	}
+	kqueue_copy(q->buf + (pos & q->mask) * q->size, rec, q->size);
+	__atomic_store_n(&q->seq[pos & q->mask], (pos & ~q->mask) + 1U, __ATOMIC_RELEASE);
+	if(q->waiter != NULL)
+		kqueue_wake(&q->waiter);
+	return SYS_OK;
+}
+
+StatusTypeDef kmpsc_get(kmpsc *q, void *rec)
+{
+	uint32_t pos = q->tail, lap = pos & ~q->mask;
+	if(__atomic_load_n(&q->seq[pos & q->mask], __ATOMIC_ACQUIRE) != lap + 1U) return SYS_ERROR;
+	kqueue_copy(rec, q->buf + (pos & q->mask) * q->size, q->size);
+	__atomic_store_n(&q->seq[pos & q->mask], lap + q->mask + 1U, __ATOMIC_RELEASE); // free for the next lap
+	__atomic_store_n(&q->tail, pos + 1U, __ATOMIC_RELEASE);
+	return SYS_OK;
+}
+
+static StatusTypeDef mpsc_get(void *q, void *rec)
+{
+	return kmpsc_get((kmpsc*)q, rec);
+}
+
+static uint32_t mpsc_empty(void *q)
+{
+	kmpsc *m = (kmpsc*)q;
+	uint32_t pos = m->tail;
+	return __atomic_load_n(&m->seq[pos & m->mask], __ATOMIC_ACQUIRE) != (pos & ~m->mask) + 1U;
+}
+
+StatusTypeDef kmpsc_wait(kmpsc *q, void *rec, uint32_t ms)
+{
+	return kqueue_wait(&q->waiter, mpsc_get, mpsc_empty, q, rec, ms);
+}
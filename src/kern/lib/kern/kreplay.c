@@ -0,0 +1,409 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#include <kreplay.h>
+#include <kconsole.h>
+#include <kstdio.h>
+#include <kstring.h>
+#include <kmath.h>
+#include <kstream.h>
+#include <cm4.h>
+#include <UsartRingBuffer.h>
+
+extern UART_HandleTypeDef huart2;
+extern UART_HandleTypeDef huart6;
+
+volatile uint32_t kreplay_recording = 0;
+volatile uint32_t kreplay_playing = 0;
+
+/* firmware without a linked capture; kreplay.py --c writes the strong pair */
+__attribute__((weak)) const kreplay_cap kreplay_capture[1] = { { 0, 0, 0 } };
+__attribute__((weak)) const uint32_t kreplay_capture_len = 0;
+
+/*
+* Recording ring, single producer (Uart_isr of either port runs at the same
+* priority, so they never nest) and single consumer (kreplay_poll).
+*/
+typedef struct kreplay_rec_t
+{
+	uint32_t cycles;
+	uint16_t ms;
+	uint8_t port;
+	uint8_t byte;
+}kreplay_rec;
+
+static kreplay_rec kreplay_ring[KREPLAY_RING_SIZE];
+static volatile uint32_t kreplay_head = 0;
+static volatile uint32_t kreplay_tail = 0;
+static volatile uint32_t kreplay_lost = 0;
+static uint32_t kreplay_prev_cycles = 0;
+static uint16_t kreplay_prev_ms = 0;
+/* queued on the console when a frame is complete, kreplay_poll runs in kconsole_wait */
+static void kreplay_drain(void *arg) { (void)arg; kreplay_poll(); }
+static kwork kreplay_work = KWORK_INIT(kreplay_drain, NULL);
+
+/* playback state, shared by SysTick, Uart_isr and kreplay_run */
+static const kreplay_cap *play_cap = NULL;
+static uint32_t play_len = 0;
+static volatile uint32_t play_idx = 0;
+static volatile uint32_t play_ms = 0;
+static volatile uint32_t play_injected = 0;
+static volatile uint32_t play_tail_idx = 0;
+static char play_tail[KREPLAY_PATTERN_MAX + 2U];
+static uint32_t play_t0 = 0;
+static uint32_t play_speed = 1;
+static uint8_t play_port = 0;
+static UART_HandleTypeDef *play_uart = NULL;
+static IRQn_Type play_irq = USART2_IRQn;
+
+static char kreplay_line[KREPLAY_LINE_MAX];
+static char kreplay_out[KREPLAY_LINE_MAX];
+
+static const char *kreplay_parser_names[KREPLAY_NUM_PARSERS] = {
+	[KREPLAY_WAIT_FOR] = "wait_for",
+	[KREPLAY_COPY_UPTO] = "copy_upto",
+	[KREPLAY_LOOK_FOR_FRAME] = "look_for_frame",
+	[KREPLAY_GETDATA] = "getdata",
+};
+
+static uint8_t kreplay_port_of(UART_HandleTypeDef *huart)
+{
+	return (huart->Instance == USART2) ? 2U : 6U;
+}
+
+void kreplay_record(UART_HandleTypeDef *huart, uint8_t c)
+{
+	uint32_t head = kreplay_head;
+	kreplay_rec *r;
+	if(head - kreplay_tail >= KREPLAY_RING_SIZE)
+	{
+		kreplay_lost++;
+		return;
+	}
+	r = &kreplay_ring[head & (KREPLAY_RING_SIZE - 1U)];
+	r->cycles = __getCycleCount();
+	r->ms = (uint16_t)__getTime();
+	r->port = kreplay_port_of(huart);
+	r->byte = c;
+	kreplay_head = head + 1U;
+	if(head + 1U - kreplay_tail == KREPLAY_FRAME_MAX)
+	{
+		kconsole_queue(&kreplay_work);
+	}
+}
+
+void kreplay_record_start(void)
+{
+	kreplay_tail = kreplay_head;
+	kreplay_lost = 0;
+	kreplay_prev_cycles = __getCycleCount();
+	kreplay_prev_ms = (uint16_t)__getTime();
+	kreplay_recording = 1;
+}
+
+void kreplay_record_stop(void)
+{
+	kreplay_recording = 0;
+	kconsole_queue(&kreplay_work);	/* flush the partial frame */
+}
+
+uint32_t kreplay_poll(void)
+{
+	uint8_t payload[6U * KREPLAY_FRAME_MAX];
+	uint32_t avail, n, tail, prev_cycles;
+	uint16_t prev_ms;
+
+	for(;;)
+	{
+		tail = kreplay_tail;
+		avail = kreplay_head - tail;
+		if(avail == 0 || (avail < KREPLAY_FRAME_MAX && kreplay_recording))
+		{
+			return 0;
+		}
+		n = (avail > KREPLAY_FRAME_MAX) ? KREPLAY_FRAME_MAX : avail;
+		prev_cycles = kreplay_prev_cycles;
+		prev_ms = kreplay_prev_ms;
+		for(uint32_t i = 0; i < n; i++)
+		{
+			kreplay_rec *r = &kreplay_ring[(tail + i) & (KREPLAY_RING_SIZE - 1U)];
+			uint16_t dms = (uint16_t)(r->ms - prev_ms);
+			/* CYCCNT wraps every 23.8 s, past that the tick count is used */
+			uint32_t dt = (dms > 20000U) ? (uint32_t)dms * 1000U : (r->cycles - prev_cycles) / KREPLAY_CORE_MHZ;
+			kstream_put32(&payload[6U * i], dt);
+			payload[6U * i + 4U] = r->port;
+			payload[6U * i + 5U] = r->byte;
+			prev_cycles = r->cycles;
+			prev_ms = r->ms;
+		}
+		if(kstream_send(KREPLAY_TYPE_BYTES, (uint8_t)n, payload, 6U * n) != SYS_OK)
+		{
+			return avail;	/* never block on the UART */
+		}
+		kreplay_prev_cycles = prev_cycles;
+		kreplay_prev_ms = prev_ms;
+		kreplay_tail = tail + n;
+	}
+}
+
+void kreplay_load(const kreplay_cap *cap, uint32_t len)
+{
+	play_cap = cap;
+	play_len = len;
+}
+
+/* replay clock in capture microseconds */
+static uint64_t kreplay_now_us(void)
+{
+	return (uint64_t)play_ms * 1000ULL * play_speed;
+}
+
+/* SysTick only reads play_idx, Uart_isr (higher priority) owns it */
+static uint32_t kreplay_due(void)
+{
+	uint32_t i = play_idx;
+	while(i < play_len && play_cap[i].port != play_port)
+		i++;
+	if(i == play_len)
+		return 1;	/* only the pattern is left */
+	return (uint64_t)(play_cap[i].t_us - play_t0) <= kreplay_now_us();
+}
+
+void kreplay_tick(void)
+{
+	play_ms++;
+	if(kreplay_due())
+	{
+		NVIC_SetPendingIRQ(play_irq);
+	}
+}
+
+void kreplay_isr(UART_HandleTypeDef *huart)
+{
+	uint64_t now;
+	if(huart != play_uart)
+		return;
+	now = kreplay_now_us();
+	while(play_idx < play_len)
+	{
+		const kreplay_cap *c = &play_cap[play_idx];
+		if(c->port == play_port)
+		{
+			if((uint64_t)(c->t_us - play_t0) > now)
+				return;
+			Uart_rx_inject(huart, c->byte);
+			play_injected++;
+		}
+		play_idx++;
+	}
+	/* capture done: append the pattern once, whole, so a blocking parser returns */
+	while(play_tail[play_tail_idx] != '\0')
+	{
+		ring_buffer *rx = huart->pRxBuffPtr;
+		uint32_t room = (huart->RxXferSize + rx->tail - rx->head - 1U) % huart->RxXferSize;
+		if(play_tail_idx == 0 && room < __strlen((uint8_t*)play_tail))
+			return;
+		Uart_rx_inject(huart, (uint8_t)play_tail[play_tail_idx++]);
+	}
+	kreplay_playing = 0;
+}
+
+/* offset of s in the first len bytes of buf, -1 when absent */
+static int32_t kreplay_find(const char *buf, uint32_t len, const char *s)
+{
+	uint32_t n = __strlen((uint8_t*)s);
+	for(uint32_t i = 0; i + n <= len; i++)
+	{
+		uint32_t j = 0;
+		while(j < n && buf[i + j] == s[j])
+			j++;
+		if(j == n)
+			return (int32_t)i;
+	}
+	return -1;
+}
+
+static int kreplay_getdata(char *start, char *end, UART_HandleTypeDef *uart)
+{
+	int32_t s, e;
+	if(Copy_upto(end, kreplay_line, uart) != 1)
+		return -1;
+	e = kreplay_find(kreplay_line, KREPLAY_LINE_MAX, end);
+	if(e < 0)
+		return -1;
+	kreplay_line[e + (int32_t)__strlen((uint8_t*)end)] = '\0';
+	s = kreplay_find(kreplay_line, (uint32_t)e, start);
+	if(s < 0)
+		return -1;	/* GetDataFromBuffer would run off without a start string */
+	GetDataFromBuffer(start, end, kreplay_line, kreplay_out);
+	return 1;
+}
+
+StatusTypeDef kreplay_run(uint8_t port, kreplay_parser parser, char *pattern, uint32_t speed, kreplay_result *res)
+{
+	char *start = pattern, *end = pattern;
+	uint32_t t_start, t, drop0;
+	int r;
+
+	if((port != 2U && port != 6U) || parser >= KREPLAY_NUM_PARSERS || speed == 0 || pattern[0] == '\0'
+		|| __strlen((uint8_t*)pattern) > KREPLAY_PATTERN_MAX)
+		return SYS_ERROR;
+	if(parser == KREPLAY_GETDATA)
+	{
+		while(*end != '\0' && *end != ',')
+			end++;
+		if(*end != ',' || end[1] == '\0' || end == start)
+			return SYS_ERROR;
+		*end++ = '\0';
+	}
+	kmemset(res, 0, sizeof(*res));
+	play_uart = (port == 2U) ? &huart2 : &huart6;
+	play_irq = (port == 2U) ? USART2_IRQn : USART6_IRQn;
+	play_port = port;
+	play_speed = speed;
+	play_idx = 0;
+	play_injected = 0;
+	/* look_for_frame reads on to the end of the line */
+	strcopy((uint8_t*)play_tail, (uint8_t*)end);
+	if(parser == KREPLAY_LOOK_FOR_FRAME)
+		StrCat(play_tail, "\n");
+	play_tail_idx = 0;
+	play_t0 = 0;
+	for(uint32_t i = 0; i < play_len; i++)
+	{
+		if(play_cap[i].port == port)
+		{
+			play_t0 = play_cap[i].t_us;
+			break;
+		}
+	}
+	Uart_flush(play_uart);
+	drop0 = play_uart->pRxBuffPtr->dropped;
+	t_start = __getCycleCount();
+	play_ms = 0;
+	kreplay_playing = 1;
+
+	while(kreplay_playing || IsDataAvailable(play_uart))
+	{
+		t = __getCycleCount();
+		switch(parser)
+		{
+		case KREPLAY_WAIT_FOR:
+			r = Wait_for(pattern, play_uart);
+			break;
+		case KREPLAY_COPY_UPTO:
+			r = Copy_upto(pattern, kreplay_line, play_uart);
+			break;
+		case KREPLAY_LOOK_FOR_FRAME:
+			r = look_for_frame(pattern, play_uart, KREPLAY_FRAME_TIMEOUT, (uint8_t*)kreplay_line);
+			break;
+		default:
+			r = kreplay_getdata(start, end, play_uart);
+			break;
+		}
+		res->parse_cycles += __getCycleCount() - t;
+		if(r == 1)
+			res->matches++;
+		else if(r == SYS_TIMEOUT)
+			res->timeouts++;
+	}
+	res->cycles = __getCycleCount() - t_start;
+	res->injected = play_injected;
+	res->dropped = play_uart->pRxBuffPtr->dropped - drop0;
+	return SYS_OK;
+}
+
+void kreplay_report(const char *parser, uint8_t port, uint32_t speed, kreplay_result *res)
+{
+	uint32_t consumed = res->injected - res->dropped;
+	kprintf("parser,port,speed,injected,dropped,matches,timeouts,cycles,parse_cycles,cycles_per_byte\n");
+	kprintf("%s,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", parser, port, speed, res->injected, res->dropped,
+		res->matches, res->timeouts, res->cycles, res->parse_cycles,
+		consumed ? res->parse_cycles / consumed : 0);
+}
+
+kreplay_parser kreplay_parser_by_name(const char *name)
+{
+	for(uint32_t i = 0; i < KREPLAY_NUM_PARSERS; i++)
+	{
+		if(kconsole_match((char*)name, (char*)kreplay_parser_names[i]))
+			return (kreplay_parser)i;
+	}
+	return KREPLAY_NUM_PARSERS;
+}
+
+static void cmd_replay(char *args)
+{
+	char *w = kconsole_word(&args);
+	if(kconsole_match(w, "rec"))
+	{
+		w = kconsole_word(&args);
+		if(kconsole_match(w, "start"))
+		{
+			kreplay_record_start();
+			kprintf("replay: recording USART2/USART6 RX to USART6\n");
+		}else
+		{
+			kreplay_record_stop();
+			kprintf("replay: recording stopped, %d lost\n", kreplay_lost);
+		}
+		return;
+	}
+	if(kconsole_match(w, "run"))
+	{
+		kreplay_result res;
+		char *name = kconsole_word(&args);
+		char *port = kconsole_word(&args);
+		char *pattern = kconsole_word(&args);
+		char *speed = kconsole_word(&args);
+		kreplay_parser p = kreplay_parser_by_name(name);
+		uint32_t pn = (port[0] != '\0') ? (uint32_t)__str_to_num((uint8_t*)port, 10) : 0;
+		uint32_t sp = (speed[0] != '\0') ? (uint32_t)__str_to_num((uint8_t*)speed, 10) : 1;
+		if(play_len == 0)
+		{
+			kprintf("replay: no capture linked\n");
+			return;
+		}
+		if(kreplay_run((uint8_t)pn, p, pattern, sp, &res) != SYS_OK)
+		{
+			kprintf("replay: run <parser> <2|6> <pattern|start,end> [speed]\n");
+			return;
+		}
+		kreplay_report(name, (uint8_t)pn, sp, &res);
+		return;
+	}
+	kprintf("replay: %d bytes captured, %d queued, %d lost\n", play_len, kreplay_head - kreplay_tail, kreplay_lost);
+}
+
+void kreplay_init(void)
+{
+	kreplay_load(kreplay_capture, kreplay_capture_len);
+	kconsole_register("replay", cmd_replay, "uart replay: replay [rec start|rec stop|run parser port pattern [speed]]");
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <kring.h>
+#include <errno.h>
+#include <cm4.h>
+#include <kconsole.h>
+#include <kstdio.h>
+#include <schedule.h>
+#include <thread.h>
+#include <vfs.h>
+
+static kring *kring_list[KRING_MAX];
+static uint32_t kring_count = 0;
+static uint32_t kring_polled = 0;       /* KRING_SQPOLL rings in kring_list */
+static kworkq kring_wq;
+static TCB_TypeDef *kring_task_tcb;
+
+/* kring_sqe.dev, the nodes read and write go through */
+static const vfs_node *const kring_devs[] = {
+	[KRING_DEV_CONSOLE] = &vfs_tty0,
+	[KRING_DEV_UART6]   = &vfs_tty1,
+	[KRING_DEV_SPI1]    = &vfs_spi1,
+};
+#define KRING_NDEV  (sizeof(kring_devs) / sizeof(kring_devs[0]))
+
+/* 1 when the entry has to wait for something only a task can wait for */
+static __inline uint8_t kring_waits(const kring_sqe *e)
+{
+	return e->op != KRING_OP_NOP && e->dev < KRING_NDEV && (kring_devs[e->dev]->flags & VFS_NODE_TASK);
+}
+
+static intptr_t kring_op(const kring_sqe *e)
+{
+	const vfs_node *n;
+	if(e->op == KRING_OP_NOP) return 0;
+	if(e->op != KRING_OP_READ && e->op != KRING_OP_WRITE) return -EINVAL;
+	if(e->buf == NULL && e->len != 0) return -EFAULT;
+	if(e->dev >= KRING_NDEV) return -ENODEV;
+	n = kring_devs[e->dev];
+	if(e->op == KRING_OP_WRITE)
+		return n->ops->write(n, e->buf, e->len, 0);
+	if(vfs_own(n) != SYS_OK) return -EAGAIN; // another reader has it, see vfs_own
+	return n->ops->read(n, e->buf, e->len, 0);
+}
+
+/*
+* Runs entries until the submission ring is empty or the completion ring is
+* full. With wait 0 (in the svc) it also stops in front of an entry that
+* kring_waits. Returns the entries completed.
+*/
+static uint32_t kring_process(kring *r, uint8_t wait)
+{
+	uint32_t done = 0;
+	for(;;)
+	{
+		uint32_t head = r->sq_head, tail = r->cq_tail;
+		kring_sqe e;
+		kring_cqe *c;
+		if(head == r->sq_tail) break;
+		if(tail - r->cq_head > r->cq_mask)
+		{
+			r->cq_stalls++;
+			break;
+		}
+		__DMB();
+		e = r->sq[head & r->sq_mask];
+		if(!wait && kring_waits(&e))
+		{
+			r->deferred = 1;
+			r->handoffs++;
+			kwork_queue(&kring_wq, &r->work);
+			break;
+		}
+		r->sq_head = head + 1U; // the task may reuse the entry, e is a copy
+		c = &r->cq[tail & r->cq_mask];
+		c->user_data = e.user_data;
+		c->res = kring_op(&e);
+		__DMB();
+		r->cq_tail = tail + 1U;
+		done++;
+	}
+	r->completed += done;
+	return done;
+}
+
+/* kwork item of a ring: the rest of a batch the svc left, or a SQPOLL wakeup */
+static void kring_run(void *arg)
+{
+	kring *r = (kring*)arg;
+	kring_process(r, 1);
+	r->deferred = 0; // a ring_enter from here on runs in the svc again
+}
+
+static void kring_task(void *arg)
+{
+	(void)arg;
+	for(;;)
+	{
+		kworkq_run(&kring_wq, kring_polled != 0 ? KRING_POLL_MS : KWORK_FOREVER);
+		for(uint32_t i = 0; i < kring_count; i++)
+		{
+			kring *r = kring_list[i];
+			if((r->flags & KRING_SQPOLL) && r->sq_head != r->sq_tail)
+				kring_process(r, 1);
+		}
+	}
+}
+
+static uint8_t kring_attached(kring *r)
+{
+	for(uint32_t i = 0; i < kring_count; i++)
+		if(kring_list[i] == r) return 1;
+	return 0;
+}
+
+intptr_t kring_attach(kring *r, uint32_t flags)
+{
+	uint32_t pm;
+	if(r == NULL || r->sq == NULL || r->cq == NULL) return -EFAULT;
+	if(!KRING_POW2(r->sq_mask + 1U) || !KRING_POW2(r->cq_mask + 1U) || (flags & ~KRING_SQPOLL))
+		return -EINVAL;
+	if(kring_attached(r)) return -EBUSY;
+	if(kring_count == KRING_MAX) return -ENOSPC;
+	if(kring_task_tcb == NULL)
+	{
+		kring_task_tcb = task_create("kring", kring_task, NULL, KRING_PRIO);
+		if(kring_task_tcb == NULL) return -ENOMEM;
+	}
+	r->sq_head = r->sq_tail = 0;
+	r->cq_head = r->cq_tail = 0;
+	r->flags = flags;
+	r->deferred = 0;
+	r->enters = r->completed = r->handoffs = r->cq_stalls = 0;
+	kwork_init(&r->work, kring_run, r);
+	pm = __irq_save();
+	kring_list[kring_count++] = r;
+	if(flags & KRING_SQPOLL) kring_polled++;
+	__irq_restore(pm);
+	if(flags & KRING_SQPOLL)
+		kwork_queue(&kring_wq, &r->work); // the task may wait without a timeout, start the scan
+	return 0;
+}
+
+intptr_t kring_enter(kring *r)
+{
+	if(r == NULL || !kring_attached(r)) return -EINVAL;
+	r->enters++;
+	if((r->flags & KRING_SQPOLL) || r->deferred)
+	{
+		kwork_queue(&kring_wq, &r->work); // the kring task has the ring
+		return 0;
+	}
+	return (intptr_t)kring_process(r, 0);
+}
+
+static void cmd_ring(char *args)
+{
+	(void)args;
+	kprintf("ring,flags,entries,enters,completed,handoffs,cq_stalls,queued,unreaped\n");
+	for(uint32_t i = 0; i < kring_count; i++)
+	{
+		kring *r = kring_list[i];
+		kprintf("%d,%x,%d,%d,%d,%d,%d,%d,%d\n", i, r->flags, r->sq_mask + 1U, r->enters, r->completed,
+			r->handoffs, r->cq_stalls, r->sq_tail - r->sq_head, r->cq_tail - r->cq_head);
+	}
+}
+
+void kring_sys_init(void)
+{
+	kworkq_init(&kring_wq, "kring");
+	kconsole_register("ring", cmd_ring, "submission rings: ring");
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#include <kstack.h>
+#include <kconsole.h>
+#include <kstdio.h>
+#include <cm4.h>
+
+#ifndef HOST_SIM
+/* linker.ld: main stack reservation at the top of SRAM */
+extern uint32_t _sstack;
+extern uint32_t _estack;
+#endif
+
+static kstack_region kstack_table[KSTACK_MAX];
+
+void kstack_paint(void *base, uint32_t size)
+{
+	uint32_t *p = (uint32_t*)base;
+	for(uint32_t i = 0; i < size / 4U; i++)
+		p[i] = KSTACK_PAINT;
+}
+
+StatusTypeDef kstack_register(const char *name, void *base, uint32_t size)
+{
+	uint32_t pm = __irq_save();
+	for(uint32_t i = 0; i < KSTACK_MAX; i++)
+	{
+		if(kstack_table[i].base == NULL)
+		{
+			kstack_table[i].name = name;
+			kstack_table[i].base = (uint32_t*)base;
+			kstack_table[i].size = size;
+			__irq_restore(pm);
+			return SYS_OK;
+		}
+	}
+	__irq_restore(pm);
+	return SYS_BUSY;
+}
+
+void kstack_unregister(void *base)
+{
+	uint32_t pm = __irq_save();
+	for(uint32_t i = 0; i < KSTACK_MAX; i++)
+	{
+		if(kstack_table[i].base == (uint32_t*)base)
+			kstack_table[i].base = NULL;
+	}
+	__irq_restore(pm);
+}
+
+uint32_t kstack_used(void *base, uint32_t size)
+{
+	uint32_t *p = (uint32_t*)base;
+	uint32_t words = size / 4U, i = 0;
+	while(i < words && p[i] == KSTACK_PAINT)
+		i++;
+	return (words - i) * 4U;
+}
+
+uint32_t kstack_main_used(void)
+{
+#ifndef HOST_SIM
+	return kstack_used(&_sstack, (uint32_t)&_estack - (uint32_t)&_sstack);
+#else
+	return 0;
+#endif
+}
+
+void kstack_report(void)
+{
+	kprintf("stack,base,size,used,free,used_pct\n");
+	for(uint32_t i = 0; i < KSTACK_MAX; i++)
+	{
+		kstack_region *r = &kstack_table[i];
+		uint32_t used;
+		if(r->base == NULL) continue;
+		used = kstack_used(r->base, r->size);
+		kprintf("%s,%x,%d,%d,%d,%d%s\n", r->name, (uint32_t)(uintptr_t)r->base, r->size, used,
+			r->size - used, (used * 100U) / r->size, (used == r->size) ? " overflow" : "");
+	}
+}
+
+static void cmd_stack(char *args)
+{
+	(void)args;
+	kstack_report();
+}
+
+void kstack_init(void)
+{
+#ifndef HOST_SIM
+	kstack_register("main", &_sstack, (uint32_t)&_estack - (uint32_t)&_sstack);
+#endif
+	kconsole_register("stack", cmd_stack, "stack high-water marks");
+}
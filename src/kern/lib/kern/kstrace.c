@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <kstrace.h>
+#include <syscall.h>
+#include <kconsole.h>
+#include <kstdio.h>
+#include <kmath.h>
+#include <kstring.h>
+#include <schedule.h>
+#include <thread.h>
+
+volatile uint32_t kstrace_enabled = 0;
+static uint32_t kstrace_pid = KSTRACE_ALL;
+static kstrace_rec kstrace_ring[KSTRACE_RING_SIZE];
+static uint32_t kstrace_head = 0;           /* records written since the reset */
+static kstrace_stat kstrace_stats[KSTRACE_SLOTS];
+
+static kstrace_stat *kstrace_slot(uint32_t no)
+{
+	kstrace_stat *s = kstrace_stats;
+	for(uint32_t i = 0; i < KSTRACE_SLOTS - 1U; i++, s++)
+	{
+		if(!s->used)
+		{
+			s->used = 1;
+			s->no = (uint16_t)no;
+			s->min = 0xFFFFFFFFUL;
+			return s;
+		}
+		if(s->no == no) return s;
+	}
+	if(!s->used)
+	{
+		s->used = 1;
+		s->no = 0xFFFF; // every number that found no slot
+		s->min = 0xFFFFFFFFUL;
+	}
+	return s;
+}
+
+static __inline uint32_t kstrace_bucket(uint32_t cycles)
+{
+	uint32_t b = cycles == 0 ? 0 : 32U - __CLZ(cycles);
+	return b < KSTRACE_BUCKETS ? b : KSTRACE_BUCKETS - 1U;
+}
+
+void kstrace_record(uint32_t no, const uintptr_t *args, intptr_t ret, uint32_t t0, uint32_t cycles)
+{
+	TCB_TypeDef *self = task_self();
+	uint32_t pid = self != NULL ? self->task_id : 0;
+	kstrace_rec *r;
+	kstrace_stat *s;
+	if(kstrace_pid != KSTRACE_ALL && pid != kstrace_pid) return;
+	r = &kstrace_ring[kstrace_head++ & (KSTRACE_RING_SIZE - 1U)];
+	r->ts = t0;
+	r->no = (uint16_t)no;
+	r->pid = (uint16_t)pid;
+	r->cycles = cycles;
+	r->ret = (int32_t)ret;
+	for(uint32_t i = 0; i < 4; i++)
+		r->args[i] = (uint32_t)args[i];
+	s = kstrace_slot(no);
+	s->calls++;
+	if((uintptr_t)ret >= (uintptr_t)-(intptr_t)SYSCALL_ERRNO_MAX) s->errors++;
+	if(cycles < s->min) s->min = cycles;
+	if(cycles > s->max) s->max = cycles;
+	s->sum += cycles;
+	s->hist[kstrace_bucket(cycles)]++;
+}
+
+void kstrace_start(uint32_t pid)
+{
+	kstrace_pid = pid;
+	__DMB();
+	kstrace_enabled = 1;
+}
+
+void kstrace_stop(void)
+{
+	kstrace_enabled = 0;
+}
+
+void kstrace_reset(void)
+{
+	uint32_t pm = __irq_save();
+	kstrace_head = 0;
+	for(uint32_t i = 0; i < KSTRACE_SLOTS; i++)
+	{
+		kstrace_stat *s = &kstrace_stats[i];
+		s->used = 0; // kstrace_slot sets no and min when it takes the slot again
+		s->calls = s->errors = s->max = 0;
+		s->sum = 0;
+		for(uint32_t b = 0; b < KSTRACE_BUCKETS; b++)
+			s->hist[b] = 0;
+	}
+	__irq_restore(pm);
+}
+
+static void kstrace_print_name(uint32_t no)
+{
+	const char *name = no != 0xFFFFU ? syscall_name(no) : "other";
+	if(name != NULL)
+		kprintf("%s", name);
+	else
+		kprintf("sys_%d", no);
+}
+
+/* upper bound of the bucket that holds the pct-th percent of the calls */
+static uint32_t kstrace_percentile(const kstrace_stat *s, uint32_t pct)
+{
+	uint32_t want = (s->calls * pct + 99U) / 100U, seen = 0;
+	for(uint32_t b = 0; b < KSTRACE_BUCKETS - 1U; b++)
+	{
+		seen += s->hist[b];
+		if(seen >= want) return 1UL << b;
+	}
+	return s->max;
+}
+
+static void kstrace_print_stats(void)
+{
+	kprintf("no,name,calls,errors,min,mean,max,p50,p99\n");
+	for(uint32_t i = 0; i < KSTRACE_SLOTS; i++)
+	{
+		kstrace_stat s;
+		uint32_t pm = __irq_save();
+		s = kstrace_stats[i];
+		__irq_restore(pm);
+		if(!s.used || s.calls == 0) continue;
+		kprintf("%d,", s.no);
+		kstrace_print_name(s.no);
+		kprintf(",%d,%d,%d,%d,%d,%d,%d\n", s.calls, s.errors, s.min, (uint32_t)__udiv64(s.sum, s.calls),
+			s.max, kstrace_percentile(&s, 50), kstrace_percentile(&s, 99));
+	}
+}
+
+static void kstrace_print_hist(uint32_t no)
+{
+	for(uint32_t i = 0; i < KSTRACE_SLOTS; i++)
+	{
+		kstrace_stat s;
+		uint32_t pm = __irq_save();
+		s = kstrace_stats[i];
+		__irq_restore(pm);
+		if(!s.used || s.no != no) continue;
+		kprintf("cycles_below,calls\n");
+		for(uint32_t b = 0; b < KSTRACE_BUCKETS; b++)
+		{
+			if(s.hist[b] == 0) continue;
+			if(b == KSTRACE_BUCKETS - 1U)
+				kprintf("-,%d\n", s.hist[b]);
+			else
+				kprintf("%d,%d\n", 1UL << b, s.hist[b]);
+		}
+		return;
+	}
+	kprintf("strace: no calls of %d recorded\n", no);
+}
+
+/* newest n records, oldest of them first: ts pid name(r0, r1, r2, r3) = ret cycles */
+static void kstrace_print_last(uint32_t n)
+{
+	uint32_t head = kstrace_head;
+	uint32_t have = head < KSTRACE_RING_SIZE ? head : KSTRACE_RING_SIZE;
+	if(n > have) n = have;
+	for(uint32_t i = head - n; i != head; i++)
+	{
+		kstrace_rec r;
+		uint32_t pm = __irq_save();
+		r = kstrace_ring[i & (KSTRACE_RING_SIZE - 1U)];
+		__irq_restore(pm);
+		kprintf("%d %d ", r.ts, r.pid);
+		kstrace_print_name(r.no);
+		kprintf("(%x, %x, %x, %x) = %d %d\n", r.args[0], r.args[1], r.args[2], r.args[3], r.ret, r.cycles);
+	}
+}
+
+static void cmd_strace(char *args)
+{
+	char *w = kconsole_word(&args);
+	if(kconsole_match(w, "on"))
+	{
+		kstrace_start(args[0] != '\0' ? (uint32_t)__str_to_num((uint8_t*)args, 10) : KSTRACE_ALL);
+	}else if(kconsole_match(w, "off"))
+	{
+		kstrace_stop();
+	}else if(kconsole_match(w, "reset"))
+	{
+		kstrace_reset();
+	}else if(kconsole_match(w, "stat"))
+	{
+		kstrace_print_stats();
+		return;
+	}else if(kconsole_match(w, "hist") && args[0] != '\0')
+	{
+		kstrace_print_hist((uint32_t)__str_to_num((uint8_t*)args, 10));
+		return;
+	}else if(kconsole_match(w, "last"))
+	{
+		kstrace_print_last(args[0] != '\0' ? (uint32_t)__str_to_num((uint8_t*)args, 10) : 16U);
+		return;
+	}
+	kprintf("strace: %s", kstrace_enabled ? "on" : "off");
+	if(kstrace_pid != KSTRACE_ALL) kprintf(" pid %d", kstrace_pid);
+	kprintf(", %d calls recorded\n", kstrace_head);
+}
+
+void kstrace_init(void)
+{
+	kstrace_reset();
+	kconsole_register("strace", cmd_strace, "syscall trace: strace [on [pid]|off|reset|stat|hist no|last [n]]");
+}
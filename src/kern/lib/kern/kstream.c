@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#include <kstream.h>
+#include <cm4.h>
+#include <sys_usart.h>
+#include <UsartRingBuffer.h>
+
+extern UART_HandleTypeDef huart6;
+
+uint32_t kstream_room(void)
+{
+	ring_buffer *tx = huart6.pTxBuffPtr;
+	if(tx == NULL)
+	{
+		return 0;
+	}
+	return (huart6.TxXferSize + tx->tail - tx->head - 1U) % huart6.TxXferSize;
+}
+
+StatusTypeDef kstream_send(uint8_t type, uint8_t n, const uint8_t *payload, uint32_t len)
+{
+	uint8_t sum = (uint8_t)(type ^ n);
+	if(len > KSTREAM_MAX_PAYLOAD)
+	{
+		return SYS_ERROR;
+	}
+	if(kstream_room() < len + KSTREAM_OVERHEAD)
+	{
+		return SYS_BUSY;
+	}
+	Uart_write(KSTREAM_SYNC0, &huart6);
+	Uart_write(KSTREAM_SYNC1, &huart6);
+	Uart_write(type, &huart6);
+	Uart_write(n, &huart6);
+	for(uint32_t i = 0; i < len; i++)
+	{
+		sum ^= payload[i];
+		Uart_write(payload[i], &huart6);
+	}
+	Uart_write(sum, &huart6);
+	return SYS_OK;
+}
+
+void kstream_send_wait(uint8_t type, uint8_t n, const uint8_t *payload, uint32_t len)
+{
+	while(kstream_send(type, n, payload, len) == SYS_BUSY)
+	{
+		__WFI();
+	}
+}
+
+void kstream_put16(uint8_t *dst, uint16_t v)
+{
+	dst[0] = (uint8_t)v;
+	dst[1] = (uint8_t)(v >> 8);
+}
+
+void kstream_put32(uint8_t *dst, uint32_t v)
+{
+	dst[0] = (uint8_t)v;
+	dst[1] = (uint8_t)(v >> 8);
+	dst[2] = (uint8_t)(v >> 16);
+	dst[3] = (uint8_t)(v >> 24);
+}
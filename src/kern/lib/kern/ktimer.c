@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ktimer.h>
+#include <cm4.h>
+
+static Timer_TypeDef *wheel[KTIMER_LEVELS][KTIMER_SLOTS];
+static uint32_t wheel_map[KTIMER_LEVELS];  /* bit s: slot s is not empty */
+static uint32_t wheel_now;                 /* last tick the wheel processed */
+static uint32_t armed;
+
+static void slot_link(Timer_TypeDef *t, uint32_t level, uint32_t slot)
+{
+	Timer_TypeDef **head = &wheel[level][slot];
+	t->next = *head;
+	if(t->next != NULL) t->next->pprev = &t->next;
+	t->pprev = head;
+	*head = t;
+	wheel_map[level] |= 1UL << slot;
+}
+
+static void slot_unlink(Timer_TypeDef *t)
+{
+	Timer_TypeDef **pp = t->pprev;
+	*pp = t->next;
+	if(t->next != NULL) t->next->pprev = pp;
+	else if(pp >= &wheel[0][0] && pp < &wheel[0][0] + KTIMER_LEVELS * KTIMER_SLOTS)
+	{
+		// was alone in its slot
+		uint32_t i = (uint32_t)(pp - &wheel[0][0]);
+		wheel_map[i / KTIMER_SLOTS] &= ~(1UL << (i % KTIMER_SLOTS));
+	}
+	t->next = NULL;
+	t->pprev = NULL;
+}
+
+/* lowest level whose span holds the expiry, one already due goes to the next tick */
+static void wheel_add(Timer_TypeDef *t)
+{
+	uint32_t level = 0, e = t->expires;
+	int32_t d = (int32_t)(e - wheel_now);
+	if(d <= 0)
+	{
+		d = 1;
+		e = wheel_now + 1U;
+	}else if((uint32_t)d >= KTIMER_RANGE)
+	{
+		d = (int32_t)(KTIMER_RANGE - 1U); // parked, re-linked by the cascades
+		e = wheel_now + KTIMER_RANGE - 1U;
+	}
+	while(level < KTIMER_LEVELS - 1U && (uint32_t)d >= (1UL << (KTIMER_SLOT_BITS * (level + 1U))))
+		level++;
+	slot_link(t, level, (e >> (KTIMER_SLOT_BITS * level)) & (KTIMER_SLOTS - 1U));
+}
+
+/* move a higher level slot one level down, due timers into the slot processed now */
+static void cascade(uint32_t level, uint32_t slot)
+{
+	Timer_TypeDef *t;
+	while((t = wheel[level][slot]) != NULL)
+	{
+		slot_unlink(t);
+		if((int32_t)(t->expires - wheel_now) <= 0)
+			slot_link(t, 0, wheel_now & (KTIMER_SLOTS - 1U));
+		else
+			wheel_add(t);
+	}
+}
+
+void ktimer_init(Timer_TypeDef *timer, void (*fn)(void *arg), void *arg)
+{
+	timer->next = NULL;
+	timer->pprev = NULL;
+	timer->expires = 0;
+	timer->period = 0;
+	timer->fn = fn;
+	timer->arg = arg;
+}
+
+void ktimer_start_at(Timer_TypeDef *timer, uint32_t tick, uint32_t period)
+{
+	uint32_t pm = __irq_save();
+	if(timer->pprev != NULL)
+		slot_unlink(timer);
+	else
+		armed++;
+	timer->expires = tick;
+	timer->period = period;
+	wheel_add(timer);
+	__irq_restore(pm);
+}
+
+void ktimer_start(Timer_TypeDef *timer, uint32_t ms, uint32_t period)
+{
+	ktimer_start_at(timer, getmsTick() + ms, period);
+}
+
+uint8_t ktimer_cancel(Timer_TypeDef *timer)
+{
+	uint8_t was = 0;
+	uint32_t pm = __irq_save();
+	if(timer->pprev != NULL)
+	{
+		slot_unlink(timer);
+		armed--;
+		was = 1;
+	}
+	__irq_restore(pm);
+	return was;
+}
+
+uint8_t ktimer_armed(Timer_TypeDef *timer)
+{
+	return timer->pprev != NULL;
+}
+
+uint32_t ktimer_count(void)
+{
+	return armed;
+}
+
+/* distance from 'from' to the first set bit of map at or after it, going round; map != 0 */
+static uint32_t map_scan(uint32_t map, uint32_t from)
+{
+	uint32_t r = (from == 0U) ? map : ((map >> from) | (map << (KTIMER_SLOTS - from)));
+	return 31U - __CLZ(r & (~r + 1U));
+}
+
+uint32_t ktimer_next(void)
+{
+	uint32_t best = KTIMER_NONE, pm = __irq_save();
+	for(uint32_t level = 0; level < KTIMER_LEVELS; level++)
+	{
+		uint32_t shift = KTIMER_SLOT_BITS * level, block, ticks;
+		if(wheel_map[level] == 0) continue;
+		// level 0: the slot runs at its tick; above: at the start of its block (cascade)
+		block = (wheel_now >> shift) + 1U;
+		block += map_scan(wheel_map[level], block & (KTIMER_SLOTS - 1U));
+		ticks = (block << shift) - wheel_now;
+		if(ticks < best) best = ticks;
+	}
+	__irq_restore(pm);
+	return best;
+}
+
+void ktimer_tick(uint32_t now)
+{
+	uint32_t pm = __irq_save();
+	while((int32_t)(now - wheel_now) > 0)
+	{
+		uint32_t slot;
+		Timer_TypeDef *t;
+		wheel_now++;
+		slot = wheel_now & (KTIMER_SLOTS - 1U);
+		for(uint32_t level = 1, idx = slot; idx == 0 && level < KTIMER_LEVELS; level++)
+		{
+			idx = (wheel_now >> (KTIMER_SLOT_BITS * level)) & (KTIMER_SLOTS - 1U);
+			cascade(level, idx);
+		}
+		while((t = wheel[0][slot]) != NULL)
+		{
+			slot_unlink(t);
+			if((int32_t)(t->expires - wheel_now) > 0)
+			{
+				wheel_add(t); // came down from a parked far expiry
+				continue;
+			}
+			if(t->period != 0)
+			{
+				t->expires += t->period;
+				wheel_add(t); // behind schedule: runs again on the next tick
+			}else
+			{
+				armed--;
+			}
+			t->fn(t->arg);
+		}
+	}
+	__irq_restore(pm);
+}
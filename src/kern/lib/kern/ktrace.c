@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#include <ktrace.h>
+#include <kconsole.h>
+#include <kstdio.h>
+#include <kstream.h>
+
+ktrace_event ktrace_ring[KTRACE_RING_SIZE];
+volatile uint32_t ktrace_head = 0;
+volatile uint32_t ktrace_enabled = 0;
+
+static void cmd_trace(char *args)
+{
+	if(kconsole_match(args, "start"))
+	{
+		ktrace_start();
+	}else if(kconsole_match(args, "stop"))
+	{
+		ktrace_stop();
+	}else if(kconsole_match(args, "dump"))
+	{
+		ktrace_dump();
+	}
+	kprintf("trace: %s, %d events recorded\n", ktrace_enabled ? "on" : "off", ktrace_head);
+}
+
+void ktrace_init(void)
+{
+	kconsole_register("trace", cmd_trace, "event trace: trace [start|stop|dump]");
+}
+
+void ktrace_start(void)
+{
+	ktrace_head = 0;
+	ktrace_enabled = 1;
+}
+
+void ktrace_stop(void)
+{
+	ktrace_enabled = 0;
+}
+
+void ktrace_dump(void)
+{
+	uint8_t payload[sizeof(ktrace_event) * KTRACE_FRAME_MAX];
+	uint32_t was_on = ktrace_enabled;
+	uint32_t head, first, count, lost;
+
+	ktrace_enabled = 0;
+	__DMB();
+	head = ktrace_head;
+	count = (head > KTRACE_RING_SIZE) ? KTRACE_RING_SIZE : head;
+	lost = head - count;
+	first = head - count;
+#ifndef HOST_SIM
+	kstream_put32(&payload[0], 180000000U);
+#else
+	kstream_put32(&payload[0], (uint32_t)HOST_SIM_HCLK);
+#endif
+	kstream_put32(&payload[4], lost);
+	kstream_put32(&payload[8], count);
+	kstream_send_wait(KTRACE_TYPE_HEADER, 1, payload, 12);
+	while(count > 0)
+	{
+		uint32_t n = (count > KTRACE_FRAME_MAX) ? KTRACE_FRAME_MAX : count;
+		for(uint32_t i = 0; i < n; i++)
+		{
+			ktrace_event *e = &ktrace_ring[(first + i) & (KTRACE_RING_SIZE - 1U)];
+			uint8_t *p = &payload[i * sizeof(ktrace_event)];
+			kstream_put32(p, e->ts);
+			p[4] = e->type;
+			p[5] = e->id;
+			kstream_put16(&p[6], e->arg);
+		}
+		kstream_send_wait(KTRACE_TYPE_EVENTS, (uint8_t)n, payload, n * sizeof(ktrace_event));
+		first += n;
+		count -= n;
+	}
+	if(was_on)
+	{
+		ktrace_start();
+	}
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <kwork.h>
+#include <cm4.h>
+#include <kconsole.h>
+#include <kstdio.h>
+#include <kmath.h>
+#include <schedule.h>
+#include <thread.h>
+
+static kworkq *kwork_queues[KWORK_MAX_QUEUES];
+static uint32_t kwork_nqueues = 0;
+
+void kwork_init(kwork *w, void (*fn)(void *arg), void *arg)
+{
+	w->next = NULL;
+	w->fn = fn;
+	w->arg = arg;
+	w->stamp = 0;
+	w->pending = 0;
+}
+
+void kworkq_reset(kworkq *q)
+{
+	uint32_t pm = __irq_save();
+	q->queued = 0;
+	q->coalesced = 0;
+	q->runs = 0;
+	q->depth_max = q->depth;
+	q->lat_min = 0xFFFFFFFFUL;
+	q->lat_max = 0;
+	q->lat_sum = 0;
+	q->run_max = 0;
+	q->run_sum = 0;
+	__irq_restore(pm);
+}
+
+StatusTypeDef kworkq_init(kworkq *q, const char *name)
+{
+	q->name = name;
+	q->head = NULL;
+	q->tail = NULL;
+	q->waiter = NULL;
+	q->depth = 0;
+	kworkq_reset(q);
+	for(uint32_t i = 0; i < kwork_nqueues; i++)
+	{
+		if(kwork_queues[i] == q) return SYS_OK;
+	}
+	if(kwork_nqueues == KWORK_MAX_QUEUES) return SYS_BUSY;
+	kwork_queues[kwork_nqueues++] = q;
+	return SYS_OK;
+}
+
+StatusTypeDef kwork_queue(kworkq *q, kwork *w)
+{
+	TCB_TypeDef *t;
+	uint32_t pm = __irq_save();
+	if(w->pending)
+	{
+		q->coalesced++;
+		__irq_restore(pm);
+		return SYS_BUSY;
+	}
+	w->pending = 1;
+	w->stamp = __getCycleCount();
+	w->next = NULL;
+	if(q->tail != NULL)
+		q->tail->next = w;
+	else
+		q->head = w;
+	q->tail = w;
+	q->queued++;
+	if(++q->depth > q->depth_max) q->depth_max = q->depth;
+	t = q->waiter;
+	q->waiter = NULL;
+	if(t != NULL)
+		ksched_ready(t);
+	__irq_restore(pm);
+	return SYS_OK;
+}
+
+uint32_t kworkq_run(kworkq *q, uint32_t ms)
+{
+	uint32_t ran = 0, start = getmsTick();
+	for(;;)
+	{
+		uint32_t pm = __irq_save();
+		kwork *w = q->head;
+		uint32_t stamp, t0, t1;
+		if(w == NULL)
+		{
+			uint32_t spent = getmsTick() - start;
+			if(ran != 0 || ms == 0 || (ms != KWORK_FOREVER && spent >= ms) || task_self() == NULL)
+			{
+				__irq_restore(pm);
+				return ran;
+			}
+			q->waiter = task_self();
+			ksched_block_timeout(TASK_BLOCKED_STATE, ms == KWORK_FOREVER ? 0 : ms - spent);
+			__irq_restore(pm); // blocks here
+			q->waiter = NULL; // timed out, or woken with the waiter already cleared
+			continue;
+		}
+		q->head = w->next;
+		if(q->head == NULL) q->tail = NULL;
+		q->depth--;
+		stamp = w->stamp;
+		w->pending = 0; // from here a kwork_queue runs it again
+		__irq_restore(pm);
+
+		t0 = __getCycleCount();
+		w->fn(w->arg);
+		t1 = __getCycleCount();
+
+		pm = __irq_save();
+		q->runs++;
+		if(t0 - stamp < q->lat_min) q->lat_min = t0 - stamp;
+		if(t0 - stamp > q->lat_max) q->lat_max = t0 - stamp;
+		q->lat_sum += t0 - stamp;
+		if(t1 - t0 > q->run_max) q->run_max = t1 - t0;
+		q->run_sum += t1 - t0;
+		__irq_restore(pm);
+		ran++;
+	}
+}
+
+static void kworkq_task(void *arg)
+{
+	for(;;)
+		kworkq_run((kworkq*)arg, KWORK_FOREVER);
+}
+
+TCB_TypeDef *kworkq_start(kworkq *q, uint8_t priority)
+{
+	return task_create(q->name, kworkq_task, q, priority);
+}
+
+static void cmd_work(char *args)
+{
+	uint8_t reset = kconsole_match(args, "reset");
+	kprintf("queue,queued,coalesced,runs,depth_max,lat_min,lat_mean,lat_max,run_mean,run_max\n");
+	for(uint32_t i = 0; i < kwork_nqueues; i++)
+	{
+		kworkq snap, *q = kwork_queues[i];
+		uint32_t pm = __irq_save();
+		snap = *q;
+		__irq_restore(pm);
+		if(snap.runs == 0)
+			kprintf("%s,%d,%d,0,%d,0,0,0,0,0\n", snap.name, snap.queued, snap.coalesced, snap.depth_max);
+		else
+			kprintf("%s,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", snap.name, snap.queued, snap.coalesced, snap.runs,
+				snap.depth_max, snap.lat_min, (uint32_t)__udiv64(snap.lat_sum, snap.runs), snap.lat_max,
+				(uint32_t)__udiv64(snap.run_sum, snap.runs), snap.run_max);
+		if(reset)
+			kworkq_reset(q);
+	}
+}
+
+void kworkq_sys_init(void)
+{
+	kconsole_register("work", cmd_work, "deferred work, cycles: work [reset]");
+}
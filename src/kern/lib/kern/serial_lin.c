@@ -34,6 +34,11 @@
 #include <UsartRingBuffer.h>
 #include <system_config.h>
 #include <kstring.h>
+#include <kprobe.h>
+#include <ktrace.h>
+#include <kirqlat.h>
+#include <kconsole.h>
+#include <vfs.h>
 extern UART_HandleTypeDef huart2;
 extern UART_HandleTypeDef huart6;
 Data_TypeDef errObj={SYS_USART_t,0};
@@ -165,6 +170,23 @@ void SerialLin6_init(UART_HandleTypeDef *huart,uint32_t baudrate)
 	
 }
 
+/*
+* A byte reached the rx ring: the console task reads it, not the handler,
+* and tasks polling the port scan again. tail is the tx ring's on entry,
+* a moved one made room for a writer.
+*/
+static void uart_notify(UART_HandleTypeDef *huart, unsigned int head, unsigned int tail)
+{
+	if(huart->pRxBuffPtr->head != head)
+	{
+		if(huart == __CONSOLE)
+			kconsole_rx_notify();
+		vfs_notify(huart, POLLIN);
+	}
+	if(huart->pTxBuffPtr->tail != tail)
+		vfs_notify(huart, POLLOUT);
+}
+
 /*
 void USART1_IRQHandler(void)
 {
@@ -177,7 +199,14 @@ void USART1_IRQHandler(void)
   */
 void USART2_Handler(void)
 {
+	KIRQLAT_ENTRY(USART2_IRQn);
+	KTRACE_ISR_ENTER(USART2_IRQn);
+	unsigned int head = huart2.pRxBuffPtr->head, tail = huart2.pTxBuffPtr->tail;
+	KPROBE_ENTER(KPROBE_UART_ISR);
   	Uart_isr (&huart2);
+	uart_notify(&huart2, head, tail);
+	KPROBE_EXIT(KPROBE_UART_ISR);
+	KTRACE_ISR_EXIT(USART2_IRQn);
 }
 
 /*
@@ -211,7 +240,14 @@ void USART5_IRQHandler(void)
   */
 void USART6_Handler(void)
 {
+	KIRQLAT_ENTRY(USART6_IRQn);
+	KTRACE_ISR_ENTER(USART6_IRQn);
+	unsigned int head = huart6.pRxBuffPtr->head, tail = huart6.pTxBuffPtr->tail;
+	KPROBE_ENTER(KPROBE_UART_ISR);
 	Uart_isr (&huart6);
+	uart_notify(&huart6, head, tail);
+	KPROBE_EXIT(KPROBE_UART_ISR);
+	KTRACE_ISR_EXIT(USART6_IRQn);
 }
 
 void noIntWrite(UART_HandleTypeDef *huart,char ch)
@@ -41,6 +41,21 @@
 #include <system_config.h>
 #include <mcu_info.h>
 #include <sys_rtc.h>
+#include <kconsole.h>
+#include <kwork.h>
+#include <kring.h>
+#include <vfs.h>
+#include <kdata.h>
+#include <kprobe.h>
+#include <kprof.h>
+#include <ktrace.h>
+#include <kstrace.h>
+#include <kirqlat.h>
+#include <kboot.h>
+#include <kstack.h>
+#include <kreplay.h>
+#include <thread.h>
+#include <schedule.h>
 #ifndef DEBUG
 #define DEBUG 1
 #endif
@@ -52,37 +67,53 @@ void __sys_init(void)
 	__ISB();	
 	__enable_fpu(); //enable FPU single precision floating point unit
 	__ISB();
+	KBOOT_STAMP(KBOOT_FPU);
+	//the DWT cycle counter is started in Reset_Handler
 	NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);
+	kdata_init(); //time fields of the kernel data page, refreshed by SysTick
 	__SysTick_init(180000);	//enable systick for 1ms
+	KBOOT_STAMP(KBOOT_SYSTICK);
 	//SYS_RTC_init();
 	SerialLin2_init(__CONSOLE,0);
+	KBOOT_STAMP(KBOOT_USART2);
 	SerialLin6_init(&huart6,0);
+	KBOOT_STAMP(KBOOT_USART6);
 	Ringbuf_init(__CONSOLE);
 	Ringbuf_init(&huart6);
+	KBOOT_STAMP(KBOOT_RINGBUF);
 	ConfigTimer2ForSystem();
 	__ISB();
+	KBOOT_STAMP(KBOOT_TIM2);
+	kconsole_init();
+	kworkq_sys_init();
+	kring_sys_init();
+	vfs_sys_init();
+	kprobe_init();
+	kprof_init();
+	ktrace_init();
+	kstrace_init();
+	kirqlat_init();
+	kboot_init();
+	kstack_init();
+	kreplay_init();
+	task_init();
+	ksched_init(); //idle task, PendSV priority; kmain starts the scheduler
+	KBOOT_STAMP(KBOOT_SERVICES);
 	#ifdef DEBUG
 	kprintf("\n************************************\r\n");
 	kprintf("Booting Machine Intelligence System 1.0 .....\r\n");
 	kprintf("Copyright (c) 2024, Prof. Mosaddek Tushar, CSE, DU\r\n");
 	kprintf("CPUID %x\n", SCB->CPUID);
 	kprintf("OS Version: 2024.1.0.0\n");
-	kprintf("Time Elapse %d ms\n",__getTime());
+	kprintf("Time Elapse %d ms (%d us since reset, \"boot\" for stages)\n",__getTime(),kboot_elapsed_ns()/1000);
 	kprintf("*************************************\r\n");
 	kprintf("# ");
 	show_system_info();
+	KBOOT_STAMP(KBOOT_SYSINFO);
 	display_group_info();
 	#endif
 }
 
-/*
-* Do not remove it is for debug purpose
-*/
-
-void SYS_ROUTINE(void)
-{
-	__debugRamUsage();
-}
 
 /*
 * Display your Full Name, Registration Number and Class Roll
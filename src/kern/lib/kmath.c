@@ -39,3 +39,22 @@ uint32_t __pow(uint32_t val,uint32_t n)
 	}
 	return s;
 }
+
+/*
+* 64-bit unsigned division by shift and subtract, so that statistics code
+* does not pull in __aeabi_uldivmod. Division by zero returns 0.
+*/
+uint64_t __udiv64(uint64_t n,uint64_t d)
+{
+	uint64_t q=0,r=0;
+	if(d==0) return 0;
+	if((n>>32)==0 && (d>>32)==0) return (uint32_t)n/(uint32_t)d;
+	for(int i=63;i>=0;i--){
+		r=(r<<1)|((n>>i)&1);
+		if(r>=d){
+			r-=d;
+			q|=(uint64_t)1<<i;
+		}
+	}
+	return q;
+}
@@ -34,6 +34,11 @@
 #include <kstring.h>
 #include <float.h>
 #include <system_config.h>
+#include <kprobe.h>
+#include <ksync.h>
+
+/* one kprintf line at a time between tasks; boot code and handlers print unlocked */
+static kmutex console_lock = KMUTEX_INIT;
 
 /**
 * first argument define the type of string to kprintf and kscanf, 
@@ -53,7 +58,10 @@ void kprintf(char *format,...)
 	uint8_t *str;
 	va_list list;
 	double dval;
+	uint8_t locked;
 	//uint32_t *intval;
+	KPROBE_ENTER(KPROBE_KPRINTF);
+	locked = kmutex_lock(&console_lock, KSYNC_FOREVER) == SYS_OK;
 	va_start(list,format);
 	for(tr = format;*tr != '\0';tr++)
 	{
@@ -106,6 +114,9 @@ void kprintf(char *format,...)
 		}
 	}
 	va_end(list);
+	if(locked)
+		kmutex_unlock(&console_lock);
+	KPROBE_EXIT(KPROBE_KPRINTF);
 }
 
 void putstr(const uint8_t *str,size_t size)
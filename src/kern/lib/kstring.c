@@ -37,33 +37,40 @@
 static uint8_t __outbuf[50];
 
 
+/* digits up to the first one that is not valid in base; "0x" may lead in base 16 */
 int __str_to_num(uint8_t* buff,uint8_t base)
 {
 	uint8_t sign=0;
-	int decimal=0;
-    uint32_t val;
-	if(buff[0] == '-') 
+	uint32_t decimal=0;
+	uint32_t val=0;
+	if(buff[0] == '-')
 	{
 		sign=1;
-		buff[0]='0';
+		buff++;
 	}
-	__reverse_str(buff);
-	uint32_t i=0;
-	while(buff[i]){
-		if(buff[i]>='0' && buff[i]<='9'){
-			val=(uint32_t)(buff[i]-'0');
-		}else if (buff[i]>='a' && buff[i]<='f')
+	if(base == 16 && buff[0] == '0' && (buff[1] == 'x' || buff[1] == 'X'))
+	{
+		buff+=2;
+	}
+	for(;;buff++)
+	{
+		if(*buff>='0' && *buff<='9'){
+			val=(uint32_t)(*buff-'0');
+		}else if (*buff>='a' && *buff<='f')
 		{
-			val=(uint32_t)(buff[i]-97+10);
-		}else if (buff[i]>='A' && buff[i]<='F')
-        {
-            val=(uint32_t)(buff[i]-65+10);
-        }
-        decimal+=val*__pow(base,i);
-		i++;
+			val=(uint32_t)(*buff-'a'+10);
+		}else if (*buff>='A' && *buff<='F')
+		{
+			val=(uint32_t)(*buff-'A'+10);
+		}else
+		{
+			break;
+		}
+		if(val >= base) break;
+		decimal=decimal*base+val;
 	}
-	if(sign) decimal = decimal*-1;
-	return decimal;
+	if(sign) decimal = 0U-decimal;
+	return (int)decimal;
 }
 void __reverse_str(uint8_t* buff)
 {
@@ -1,10 +1,8 @@
 #include <debug.h>
-#include <timer.h>
+#include <kstack.h>
 
 extern const uint32_t STACK_START;
 
-static uint32_t _LAST_RAM_USAGE_UPDATE = 0;
-
 /* EXPORT VALUES */
 volatile uint32_t CURRENT_MSP = 0;
 
@@ -18,17 +16,8 @@ void __debugRamUsage() {
   if (!SOTOM_DEBUG_FLAG)
     return;
 
-  uint32_t t_ = getMiliseconds();
-  register uint32_t msp __asm("sp");
-
-  if (msp < CURRENT_MSP) {
-    CURRENT_MSP = msp;
-  }
-
-  if (t_ > _LAST_RAM_USAGE_UPDATE) {
-    CURRENT_MSP = STACK_START;
-    _LAST_RAM_USAGE_UPDATE = t_ + SRAM_REFRESH_TIME_GAP_MS;
-  }
+  // lowest address the main stack ever reached, read from the painted stack
+  CURRENT_MSP = STACK_START - kstack_main_used();
 }
 
 void __digitalWriteDebugButton(uint8_t pin, uint8_t value) {
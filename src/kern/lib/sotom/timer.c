@@ -3,6 +3,9 @@
 #include <sys_gpio.h>
 #include <sys_timer.h>
 #include <cm4.h>
+#include <kprobe.h>
+#include <ktrace.h>
+#include <kirqlat.h>
 
 // #include "../../protocols/usart/usart.h"
 // #include "../stdlib/stdlibc.h"
@@ -83,10 +86,16 @@ uint32_t getMicroseconds() {
 }
 
 void TIM2_Handler() {
+  KIRQLAT_ENTRY(TIM2_IRQn);
+  KTRACE_ISR_ENTER(TIM2_IRQn);
+  KPROBE_ENTER(KPROBE_TIM2);
+  uint32_t sr = TIM2->SR;
   TIM2->SR = ~(1 << 0); // clear interrupt flag
-  if (!TIM2_READY_TO_USE)
-    return;
-  TIM2_INTERRUPT_CALL_COUNT++;
-  TIM2->CNT = 0;
-  SYS_ROUTINE();
+  // count real updates only, a software pended entry has no UIF
+  if (TIM2_READY_TO_USE && (sr & (1 << 0))) {
+    TIM2_INTERRUPT_CALL_COUNT++;
+    TIM2->CNT = 0;
+  }
+  KPROBE_EXIT(KPROBE_TIM2);
+  KTRACE_ISR_EXIT(TIM2_IRQn);
 }
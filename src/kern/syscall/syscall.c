@@ -31,31 +31,304 @@
 #include <syscall.h>
 #include <syscall_def.h>
 #include <errno.h>
-#include <errmsg.h>
-void syscall(uint16_t callno)
+#include <kunistd.h>
+#include <ktrace.h>
+#include <kstrace.h>
+#include <cm4.h>
+#include <schedule.h>
+#include <thread.h>
+#include <kring.h>
+#include <vfs.h>
+#include <ksync.h>
+
+static int32_t boot_errno; // syscalls made before the first task runs
+
+int32_t *__errno(void)
+{
+	TCB_TypeDef *t = task_self();
+	return t != NULL ? &t->sys_errno : &boot_errno;
+}
+
+static intptr_t sys__exit(uintptr_t status, uintptr_t a1, uintptr_t a2, uintptr_t a3)
+{
+	uint32_t pm;
+	(void)status; (void)a1; (void)a2; (void)a3;
+	if(task_self() == NULL) return -EPERM;
+	vfs_task_exit(task_self());
+	pm = __irq_save();
+	kmutex_exit(task_self());
+	ksched_remove(task_self()); // switched out when the svc returns, never resumed
+	__irq_restore(pm);
+	return 0;
+}
+
+static intptr_t sys_getpid(uintptr_t a0, uintptr_t a1, uintptr_t a2, uintptr_t a3)
+{
+	(void)a0; (void)a1; (void)a2; (void)a3;
+	return task_self() != NULL ? task_self()->task_id : 0;
+}
+
+static intptr_t sys_open(uintptr_t path, uintptr_t flags, uintptr_t a2, uintptr_t a3)
+{
+	(void)a2; (void)a3;
+	return vfs_open((const char*)path, (uint32_t)flags);
+}
+
+static intptr_t sys_close(uintptr_t fd, uintptr_t a1, uintptr_t a2, uintptr_t a3)
+{
+	(void)a1; (void)a2; (void)a3;
+	return vfs_close((int32_t)fd);
+}
+
+static intptr_t sys_dup(uintptr_t fd, uintptr_t a1, uintptr_t a2, uintptr_t a3)
+{
+	(void)a1; (void)a2; (void)a3;
+	return vfs_dup((int32_t)fd);
+}
+
+static intptr_t sys_dup2(uintptr_t fd, uintptr_t fd2, uintptr_t a2, uintptr_t a3)
+{
+	(void)a2; (void)a3;
+	return vfs_dup2((int32_t)fd, (int32_t)fd2);
+}
+
+/* what the node has, does not wait; -EAGAIN from a stream with nothing */
+static intptr_t sys_read(uintptr_t fd, uintptr_t buf, uintptr_t len, uintptr_t a3)
+{
+	(void)a3;
+	return vfs_read((int32_t)fd, (void*)buf, (uint32_t)len);
+}
+
+static intptr_t sys_write(uintptr_t fd, uintptr_t buf, uintptr_t len, uintptr_t a3)
+{
+	(void)a3;
+	return vfs_write((int32_t)fd, (const void*)buf, (uint32_t)len);
+}
+
+static intptr_t sys_pread(uintptr_t fd, uintptr_t buf, uintptr_t len, uintptr_t off)
+{
+	return vfs_pread((int32_t)fd, (void*)buf, (uint32_t)len, (uint32_t)off);
+}
+
+static intptr_t sys_pwrite(uintptr_t fd, uintptr_t buf, uintptr_t len, uintptr_t off)
+{
+	return vfs_pwrite((int32_t)fd, (const void*)buf, (uint32_t)len, (uint32_t)off);
+}
+
+static intptr_t sys_lseek(uintptr_t fd, uintptr_t off, uintptr_t whence, uintptr_t a3)
+{
+	(void)a3;
+	return vfs_lseek((int32_t)fd, (int32_t)off, (uint32_t)whence);
+}
+
+static intptr_t sys_ioctl(uintptr_t fd, uintptr_t req, uintptr_t arg, uintptr_t a3)
+{
+	(void)a3;
+	return vfs_ioctl((int32_t)fd, (uint32_t)req, arg);
+}
+
+/* the task waits from the svc return on and the svc runs again, see vfs_poll */
+static intptr_t sys_poll(uintptr_t fds, uintptr_t nfds, uintptr_t timeout_ms, uintptr_t a3)
+{
+	(void)a3;
+	return vfs_poll((struct pollfd*)fds, (uint32_t)nfds, (int32_t)timeout_ms);
+}
+
+/* select(nfds, readfds, writefds, timeout_ms): no exception set, a timeout in ms */
+static intptr_t sys_select(uintptr_t nfds, uintptr_t rfds, uintptr_t wfds, uintptr_t timeout_ms)
+{
+	return vfs_select((uint32_t)nfds, (fd_set*)rfds, (fd_set*)wfds, (int32_t)timeout_ms);
+}
+
+/* seconds since boot; *sec and *nsec are filled when not NULL */
+static intptr_t sys___time(uintptr_t sec, uintptr_t nsec, uintptr_t a2, uintptr_t a3)
+{
+	uint32_t ms = getmsTick();
+	(void)a2; (void)a3;
+	if(sec != 0) *(uint32_t*)sec = ms / 1000U;
+	if(nsec != 0) *(uint32_t*)nsec = (ms % 1000U) * 1000000U;
+	return ms / 1000U;
+}
+
+/* the task sleeps from the svc return on */
+static intptr_t sys_nanosleep(uintptr_t sec, uintptr_t nsec, uintptr_t a2, uintptr_t a3)
+{
+	(void)a2; (void)a3;
+	if(task_self() == NULL) return -EPERM;
+	if(nsec >= 1000000000UL) return -EINVAL;
+	task_nanosleep((uint32_t)sec, (uint32_t)nsec);
+	return 0;
+}
+
+static intptr_t sys_reboot(uintptr_t a0, uintptr_t a1, uintptr_t a2, uintptr_t a3)
+{
+	(void)a0; (void)a1; (void)a2; (void)a3;
+	__DSB();
+	SCB->AIRCR = (0x5FAUL << SCB_AIRCR_VECTKEY_Pos) | SCB_AIRCR_SYSRESETREQ_Msk;
+	__DSB();
+	return 0;
+}
+
+static intptr_t sys_yield(uintptr_t a0, uintptr_t a1, uintptr_t a2, uintptr_t a3)
 {
-/* The SVC_Handler calls this function to evaluate and execute the actual function */
-/* Take care of return value or code */
-	switch(callno)
+	(void)a0; (void)a1; (void)a2; (void)a3;
+	ksched_yield();
+	return 0;
+}
+
+static intptr_t sys_ring_setup(uintptr_t ring, uintptr_t flags, uintptr_t a2, uintptr_t a3)
+{
+	(void)a2; (void)a3;
+	return kring_attach((kring*)ring, (uint32_t)flags);
+}
+
+/* the batch queued on the ring; returns the entries completed in the svc */
+static intptr_t sys_ring_enter(uintptr_t ring, uintptr_t a1, uintptr_t a2, uintptr_t a3)
+{
+	(void)a1; (void)a2; (void)a3;
+	return kring_enter((kring*)ring);
+}
+
+/* empty slots are ENOSYS */
+static const syscall_fn syscall_table[SYSCALL_NR] = {
+	[SYS__exit]     = sys__exit,
+	[SYS_getpid]    = sys_getpid,
+	[SYS_open]      = sys_open,
+	[SYS_dup]       = sys_dup,
+	[SYS_dup2]      = sys_dup2,
+	[SYS_close]     = sys_close,
+	[SYS_read]      = sys_read,
+	[SYS_pread]     = sys_pread,
+	[SYS_write]     = sys_write,
+	[SYS_pwrite]    = sys_pwrite,
+	[SYS_lseek]     = sys_lseek,
+	[SYS_ioctl]     = sys_ioctl,
+	[SYS_select]    = sys_select,
+	[SYS_poll]      = sys_poll,
+	[SYS___time]    = sys___time,
+	[SYS_nanosleep] = sys_nanosleep,
+	[SYS_reboot]    = sys_reboot,
+	[SYS_yield]     = sys_yield,
+	[SYS_ring_setup] = sys_ring_setup,
+	[SYS_ring_enter] = sys_ring_enter,
+};
+
+static const char *const syscall_names[SYSCALL_NR] = {
+	[SYS__exit]     = "_exit",
+	[SYS_getpid]    = "getpid",
+	[SYS_open]      = "open",
+	[SYS_dup]       = "dup",
+	[SYS_dup2]      = "dup2",
+	[SYS_close]     = "close",
+	[SYS_read]      = "read",
+	[SYS_pread]     = "pread",
+	[SYS_write]     = "write",
+	[SYS_pwrite]    = "pwrite",
+	[SYS_lseek]     = "lseek",
+	[SYS_ioctl]     = "ioctl",
+	[SYS_select]    = "select",
+	[SYS_poll]      = "poll",
+	[SYS___time]    = "__time",
+	[SYS_nanosleep] = "nanosleep",
+	[SYS_reboot]    = "reboot",
+	[SYS_yield]     = "yield",
+	[SYS_ring_setup] = "ring_setup",
+	[SYS_ring_enter] = "ring_enter",
+};
+
+const char *syscall_name(uint32_t callno)
+{
+	return callno < SYSCALL_NR ? syscall_names[callno] : NULL;
+}
+
+/* back onto the svc instruction, r0-r3 still hold the arguments */
+static __inline void syscall_rewind(uintptr_t *frame)
+{
+#ifndef HOST_SIM
+	frame[6] -= 2U; // stacked pc, svc is a 16-bit instruction
+#else
+	frame[6] = HOST_SIM_SVC_RESTART;
+#endif
+}
+
+static __inline intptr_t syscall_run(uintptr_t *frame, uint32_t callno)
+{
+	intptr_t ret = -ENOSYS;
+	if(callno < SYSCALL_NR && syscall_table[callno] != NULL)
+		ret = syscall_table[callno](frame[0], frame[1], frame[2], frame[3]);
+	if(ret == -(intptr_t)SYSCALL_RESTART)
+		syscall_rewind(frame);
+	else if((uintptr_t)ret >= (uintptr_t)-(intptr_t)SYSCALL_ERRNO_MAX)
+	{
+		frame[0] = (uintptr_t)-1;
+		frame[1] = (uintptr_t)-ret;
+	}else
+	{
+		frame[0] = (uintptr_t)ret;
+		frame[1] = 0;
+	}
+	KTRACE_SYSCALL_EXIT(callno, ret);
+	return ret;
+}
+
+/* kstrace on: out of line, so the untraced path stays a branch */
+/* a restarted call is one record: its passes add up in the task until the last one */
+static void __attribute__((noinline)) syscall_traced(uintptr_t *frame, uint32_t callno)
+{
+	uintptr_t args[4] = { frame[0], frame[1], frame[2], frame[3] };
+	TCB_TypeDef *self = task_self();
+	uint32_t t0 = __getCycleCount(), cycles;
+	intptr_t ret = syscall_run(frame, callno);
+	cycles = __getCycleCount() - t0;
+	if(self != NULL)
 	{
-		/* Write your code to call actual function (kunistd.h/c or times.h/c and handle the return value(s) */
-		case SYS_read: 
-			break;
-		case SYS_write:
-			break;
-		case SYS_reboot:
-			break;	
-		case SYS__exit:
-			break;
-		case SYS_getpid:
-			break;
-		case SYS___time:
-			break;
-		case SYS_yield:
-			break;				
-		/* return error code see error.h and errmsg.h ENOSYS sys_errlist[ENOSYS]*/	
-		default: ;
+		if(ret == -(intptr_t)SYSCALL_RESTART)
+		{
+			self->strace_cycles += cycles;
+			return;
+		}
+		cycles += self->strace_cycles;
+		self->strace_cycles = 0;
 	}
-/* Handle SVC return here */
+	kstrace_record(callno, args, ret, t0, cycles);
 }
 
+void syscall(uintptr_t *frame, uint32_t callno)
+{
+	KTRACE_SYSCALL_ENTER(callno);
+	if(__builtin_expect(kstrace_enabled != 0U, 0))
+	{
+		syscall_traced(frame, callno);
+		return;
+	}
+	syscall_run(frame, callno);
+}
+
+#ifndef HOST_SIM
+/*
+* Exception entry: the frame is on the PSP for a task and on the MSP before
+* the scheduler runs (EXC_RETURN bit 2). The svc immediate is the low byte
+* of the halfword before the stacked PC. syscall() is tail called, it
+* returns straight through EXC_RETURN.
+*/
+__attribute__((naked)) void SVCall_Handler(void)
+{
+	__asm volatile(
+		"tst lr, #4\n"
+		"ite eq\n"
+		"mrseq r0, msp\n"
+		"mrsne r0, psp\n"
+		"ldr r1, [r0, #24]\n"
+		"ldrb r1, [r1, #-2]\n"
+		"b syscall\n"
+	);
+}
+#else
+/* host: host_sim_svc passes the frame and the number the svc would encode */
+void SVCall_Handler(void)
+{
+	uint32_t callno;
+	uintptr_t *frame = host_sim_svc_args(&callno);
+	syscall(frame, callno);
+}
+#endif
@@ -0,0 +1,413 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ksync.h>
+#include <cm4.h>
+#include <kmain.h>
+#include <schedule.h>
+#include <thread.h>
+
+#define OWNER(m)    ((TCB_TypeDef*)((m)->owner & ~(uintptr_t)KSYNC_WAITERS))
+
+/*
+* Waiter lists are linked through TCB wait_next, not next: a task that timed
+* out sits in a ready list and still in the waiter list until it runs.
+* Sorted by priority, FIFO among equals.
+*/
+static void wait_insert(TCB_TypeDef **list, TCB_TypeDef *t)
+{
+	while(*list != NULL && (*list)->priority <= t->priority)
+		list = &(*list)->wait_next;
+	t->wait_next = *list;
+	*list = t;
+}
+
+static void wait_remove(TCB_TypeDef **list, TCB_TypeDef *t)
+{
+	while(*list != NULL && *list != t)
+		list = &(*list)->wait_next;
+	if(*list != NULL)
+		*list = t->wait_next;
+	t->wait_next = NULL;
+}
+
+static TCB_TypeDef *wait_pop(TCB_TypeDef **list)
+{
+	TCB_TypeDef *t = *list;
+	*list = t->wait_next;
+	t->wait_next = NULL;
+	return t;
+}
+
+static void held_remove(TCB_TypeDef *owner, kmutex *m)
+{
+	kmutex **p = &owner->held;
+	while(*p != NULL && *p != m)
+		p = &(*p)->next_held;
+	if(*p != NULL)
+		*p = m->next_held;
+	m->next_held = NULL;
+}
+
+/* base priority, raised to the first waiter of every held mutex */
+static uint8_t pi_effective(TCB_TypeDef *t)
+{
+	uint8_t p = t->base_priority;
+	for(kmutex *m = t->held; m != NULL; m = m->next_held)
+	{
+		uint8_t w;
+		if(m->waiters == NULL) continue;
+		w = m->waiters->priority < KSYNC_PI_PRIO_MIN ? KSYNC_PI_PRIO_MIN : m->waiters->priority;
+		if(w < p) p = w;
+	}
+	return p;
+}
+
+/*
+* Recompute t's priority and pass the change along the chain of owners:
+* t waits on a mutex whose owner waits on another one... The waiter lists
+* are kept sorted on the way. Bounded by MAX_TASKS, a chain cannot be longer
+* unless it is a deadlock. Called inside __irq_save.
+*/
+static void pi_update(TCB_TypeDef *t)
+{
+	for(uint32_t i = 0; t != NULL && i < MAX_TASKS; i++)
+	{
+		uint8_t p = pi_effective(t);
+		kmutex *m = t->wait_mutex;
+		if(p == t->priority) return;
+		ksched_set_priority(t, p);
+		if(t->wait_sem != NULL)
+		{
+			wait_remove(&t->wait_sem->waiters, t);
+			wait_insert(&t->wait_sem->waiters, t);
+		}
+		if(m == NULL) return;
+		wait_remove(&m->waiters, t);
+		wait_insert(&m->waiters, t);
+		t = OWNER(m);
+	}
+}
+
+/* the owner exited holding m without waiters (kmutex_exit): the next locker takes it over */
+static __inline uint8_t owner_exited(uintptr_t o)
+{
+	return o != 0 && !(o & KSYNC_WAITERS) && ((TCB_TypeDef*)o)->status == TASK_TERMINATED_STATE;
+}
+
+/* the caller's lock of m, owned by o before (0 or an exited task) */
+static __inline void owner_take(uintptr_t o, TCB_TypeDef *self)
+{
+	if(o != 0) ((TCB_TypeDef*)o)->mutexes--;
+	self->mutexes++;
+}
+
+/* first waiter of m owns it before it runs again; inside __irq_save */
+static void mutex_handoff(kmutex *m, TCB_TypeDef *self)
+{
+	TCB_TypeDef *w;
+	held_remove(self, m);
+	w = wait_pop(&m->waiters);
+	w->wait_mutex = NULL;
+	if(m->waiters != NULL)
+	{
+		m->next_held = w->held;
+		w->held = m;
+	}
+	__atomic_store_n(&m->owner, (uintptr_t)w | (m->waiters != NULL ? KSYNC_WAITERS : 0U), __ATOMIC_RELEASE);
+	self->mutexes--;
+	w->mutexes++;
+	ksched_set_priority(self, pi_effective(self));
+	ksched_set_priority(w, pi_effective(w));
+	ksched_ready(w);
+}
+
+/* the caller has to be a task, not a handler, with the scheduler running */
+static TCB_TypeDef *ksync_task(void)
+{
+	if(!ksched_running() || __in_handler()) return NULL;
+	return task_self();
+}
+
+/* 0 once the timeout of ms started at start expired, else the ticks left go to *left (0: no limit) */
+static uint32_t ksync_left(uint32_t start, uint32_t ms, uint32_t *left)
+{
+	uint32_t spent;
+	if(ms == KSYNC_FOREVER)
+	{
+		*left = 0;
+		return 1;
+	}
+	spent = getmsTick() - start;
+	if(spent >= ms) return 0;
+	*left = ms - spent;
+	return 1;
+}
+
+void kmutex_init(kmutex *m)
+{
+	m->owner = 0;
+	m->waiters = NULL;
+	m->next_held = NULL;
+	m->contended = 0;
+}
+
+TCB_TypeDef *kmutex_owner(kmutex *m)
+{
+	uintptr_t o = __atomic_load_n(&m->owner, __ATOMIC_ACQUIRE);
+	return owner_exited(o) ? NULL : OWNER(m);
+}
+
+StatusTypeDef kmutex_trylock(kmutex *m)
+{
+	uintptr_t o = 0;
+	uint32_t pm;
+	StatusTypeDef ret = SYS_BUSY;
+	TCB_TypeDef *self = ksync_task();
+	if(self == NULL || OWNER(m) == self) return SYS_ERROR;
+	if(__atomic_compare_exchange_n(&m->owner, &o, (uintptr_t)self, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+	{
+		self->mutexes++;
+		return SYS_OK;
+	}
+	pm = __irq_save();
+	o = m->owner;
+	if(owner_exited(o) && __atomic_compare_exchange_n(&m->owner, &o, (uintptr_t)self, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+	{
+		owner_take(o, self);
+		ret = SYS_OK;
+	}
+	__irq_restore(pm);
+	return ret;
+}
+
+StatusTypeDef kmutex_lock(kmutex *m, uint32_t ms)
+{
+	uint32_t pm, start, left;
+	uintptr_t o = 0;
+	TCB_TypeDef *self = ksync_task();
+	if(self == NULL || OWNER(m) == self) return SYS_ERROR;
+	if(__atomic_compare_exchange_n(&m->owner, &o, (uintptr_t)self, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+	{
+		self->mutexes++;
+		return SYS_OK;
+	}
+	start = getmsTick();
+	pm = __irq_save();
+	m->contended++;
+	// the owner cannot run in here: it either released meanwhile or sees the waiters bit
+	for(;;)
+	{
+		o = m->owner;
+		if(o == 0 || owner_exited(o))
+		{
+			if(__atomic_compare_exchange_n(&m->owner, &o, (uintptr_t)self, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+			{
+				owner_take(o, self);
+				__irq_restore(pm);
+				return SYS_OK;
+			}
+		}else if(__atomic_compare_exchange_n(&m->owner, &o, o | KSYNC_WAITERS, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+			break;
+	}
+	if(!ksync_left(start, ms, &left))
+	{
+		if(m->waiters == NULL)
+			__atomic_fetch_and(&m->owner, ~(uintptr_t)KSYNC_WAITERS, __ATOMIC_RELAXED);
+		__irq_restore(pm);
+		return SYS_TIMEOUT;
+	}
+	if(m->waiters == NULL)
+	{
+		TCB_TypeDef *owner = OWNER(m);
+		m->next_held = owner->held;
+		owner->held = m;
+	}
+	self->wait_mutex = m;
+	wait_insert(&m->waiters, self);
+	pi_update(OWNER(m));
+	for(;;)
+	{
+		ksched_block_timeout(TASK_BLOCKED_STATE, left);
+		__irq_restore(pm); // blocks here
+		pm = __irq_save();
+		if(self->wait_mutex == NULL) break; // handed over by kmutex_unlock
+		if(!ksync_left(start, ms, &left))
+		{
+			TCB_TypeDef *owner = OWNER(m);
+			self->wait_mutex = NULL;
+			wait_remove(&m->waiters, self);
+			if(m->waiters == NULL)
+			{
+				__atomic_fetch_and(&m->owner, ~(uintptr_t)KSYNC_WAITERS, __ATOMIC_RELAXED);
+				held_remove(owner, m);
+			}
+			pi_update(owner);
+			__irq_restore(pm);
+			return SYS_TIMEOUT;
+		}
+	}
+	__irq_restore(pm);
+	return SYS_OK;
+}
+
+StatusTypeDef kmutex_unlock(kmutex *m)
+{
+	uint32_t pm;
+	uintptr_t o;
+	TCB_TypeDef *self = ksync_task();
+	if(self == NULL) return SYS_ERROR;
+	o = (uintptr_t)self;
+	if(__atomic_compare_exchange_n(&m->owner, &o, 0, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+	{
+		self->mutexes--;
+		return SYS_OK;
+	}
+	if(OWNER(m) != self) return SYS_ERROR;
+	pm = __irq_save();
+	if(m->waiters == NULL)
+	{
+		__atomic_store_n(&m->owner, 0, __ATOMIC_RELEASE);
+		self->mutexes--;
+		__irq_restore(pm);
+		return SYS_OK;
+	}
+	mutex_handoff(m, self); // direct handoff, a later task cannot overtake the waiter
+	__irq_restore(pm);
+	return SYS_OK;
+}
+
+void kmutex_exit(TCB_TypeDef *task)
+{
+	uint32_t pm = __irq_save();
+	while(task->held != NULL)
+		mutex_handoff(task->held, task);
+	__irq_restore(pm);
+}
+
+void ksem_init(ksem *s, uint32_t count)
+{
+	s->state = count << 1;
+	s->waiters = NULL;
+	s->contended = 0;
+}
+
+uint32_t ksem_count(ksem *s)
+{
+	return __atomic_load_n(&s->state, __ATOMIC_RELAXED) >> 1;
+}
+
+StatusTypeDef ksem_trytake(ksem *s)
+{
+	uint32_t st = __atomic_load_n(&s->state, __ATOMIC_RELAXED);
+	while(st >= 2U)
+	{
+		if(__atomic_compare_exchange_n(&s->state, &st, st - 2U, 1, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+			return SYS_OK;
+	}
+	return SYS_BUSY;
+}
+
+StatusTypeDef ksem_take(ksem *s, uint32_t ms)
+{
+	uint32_t pm, start, left, st;
+	TCB_TypeDef *self;
+	if(ksem_trytake(s) == SYS_OK) return SYS_OK;
+	self = ksync_task();
+	if(self == NULL) return SYS_ERROR;
+	start = getmsTick();
+	pm = __irq_save();
+	s->contended++;
+	for(;;)
+	{
+		st = s->state;
+		if(st >= 2U)
+		{
+			if(__atomic_compare_exchange_n(&s->state, &st, st - 2U, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+			{
+				__irq_restore(pm);
+				return SYS_OK;
+			}
+		}else if(__atomic_compare_exchange_n(&s->state, &st, st | KSYNC_WAITERS, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+			break;
+	}
+	if(!ksync_left(start, ms, &left))
+	{
+		if(s->waiters == NULL)
+			__atomic_fetch_and(&s->state, ~KSYNC_WAITERS, __ATOMIC_RELAXED);
+		__irq_restore(pm);
+		return SYS_TIMEOUT;
+	}
+	self->wait_sem = s;
+	wait_insert(&s->waiters, self);
+	for(;;)
+	{
+		ksched_block_timeout(TASK_BLOCKED_STATE, left);
+		__irq_restore(pm); // blocks here
+		pm = __irq_save();
+		if(self->wait_sem == NULL) break; // ksem_give passed its unit on
+		if(!ksync_left(start, ms, &left))
+		{
+			self->wait_sem = NULL;
+			wait_remove(&s->waiters, self);
+			if(s->waiters == NULL)
+				__atomic_fetch_and(&s->state, ~KSYNC_WAITERS, __ATOMIC_RELAXED);
+			__irq_restore(pm);
+			return SYS_TIMEOUT;
+		}
+	}
+	__irq_restore(pm);
+	return SYS_OK;
+}
+
+void ksem_give(ksem *s)
+{
+	uint32_t pm, st = __atomic_load_n(&s->state, __ATOMIC_RELAXED);
+	TCB_TypeDef *w;
+	while(!(st & KSYNC_WAITERS))
+	{
+		if(__atomic_compare_exchange_n(&s->state, &st, st + 2U, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+			return;
+	}
+	pm = __irq_save();
+	if(s->waiters == NULL)
+	{
+		// the last waiter timed out after we looked
+		__atomic_add_fetch(&s->state, 2U, __ATOMIC_RELEASE);
+		__irq_restore(pm);
+		return;
+	}
+	w = wait_pop(&s->waiters);
+	w->wait_sem = NULL;
+	if(s->waiters == NULL)
+		__atomic_fetch_and(&s->state, ~KSYNC_WAITERS, __ATOMIC_RELEASE);
+	ksched_ready(w);
+	__irq_restore(pm);
+}
@@ -0,0 +1,574 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <schedule.h>
+#include <thread.h>
+#include <ktrace.h>
+#include <kreplay.h>
+#include <ktimer.h>
+#include <kdata.h>
+
+TCB_TypeDef *volatile ksched_current = NULL;
+volatile uint32_t ksched_ready_map = 0;
+volatile uint32_t ksched_switches = 0;
+volatile uint32_t ksched_fp_switches = 0;
+
+#ifndef HOST_SIM
+/* EXC_RETURN saved by PendSV_Handler above r4-r11: bit 4 clear means an FP frame */
+#define KSCHED_FRAME_FPU(task)	(!(((uint32_t*)(task)->psp)[8] & 0x10UL))
+#else
+#define KSCHED_FRAME_FPU(task)	0
+#endif
+
+static TCB_TypeDef *ready_head[KSCHED_PRIOS];
+static TCB_TypeDef *ready_tail[KSCHED_PRIOS];
+static volatile uint8_t started = 0;
+static uint32_t idle_sleeps, idle_suppressed;
+static uint32_t edf_util;           /* per mille */
+
+/* 1 when a's job is due before b's */
+static __inline uint8_t edf_before(TCB_TypeDef *a, TCB_TypeDef *b)
+{
+	return (int32_t)(a->edf.abs_deadline - b->edf.abs_deadline) < 0;
+}
+
+static void ready_push(TCB_TypeDef *task, uint8_t front)
+{
+	uint32_t p = task->priority;
+	task->status = TASK_READY_STATE;
+	task->acct_stamp = __getCycleCount(); // waiting_time runs from here
+	if(ready_head[p] == NULL)
+	{
+		task->next = NULL;
+		ready_head[p] = ready_tail[p] = task;
+	}else if(p == KSCHED_EDF_PRIO)
+	{
+		// sorted by absolute deadline, equal deadlines in FIFO order
+		TCB_TypeDef **pp = &ready_head[p];
+		while(*pp != NULL && !edf_before(task, *pp))
+			pp = &(*pp)->next;
+		task->next = *pp;
+		*pp = task;
+		if(task->next == NULL) ready_tail[p] = task;
+	}else if(front)
+	{
+		task->next = ready_head[p];
+		ready_head[p] = task;
+	}else
+	{
+		task->next = NULL;
+		ready_tail[p]->next = task;
+		ready_tail[p] = task;
+	}
+	ksched_ready_map |= 1UL << (31U - p);
+}
+
+static TCB_TypeDef *ready_pop(uint32_t p)
+{
+	TCB_TypeDef *task = ready_head[p];
+	ready_head[p] = task->next;
+	if(ready_head[p] == NULL)
+	{
+		ready_tail[p] = NULL;
+		ksched_ready_map &= ~(1UL << (31U - p));
+	}
+	task->next = NULL;
+	return task;
+}
+
+/* new EDF job at task->edf.release */
+static void edf_release(TCB_TypeDef *task)
+{
+	task->edf.abs_deadline = task->edf.release + task->edf.deadline;
+	task->edf.budget = task->edf.wcet;
+	task->edf.missed = 0;
+}
+
+/* TCB timer callback (from ktimer_tick in ksched_tick): the sleep or a timed block is over,
+   or the next job is released */
+static void task_timer_fire(void *arg)
+{
+	TCB_TypeDef *task = (TCB_TypeDef*)arg;
+	if(task->status == TASK_PERIOD_STATE)
+		edf_release(task);
+	else if(task->status == TASK_READY_STATE || task->status == TASK_RUNNING_STATE ||
+		task->status == TASK_TERMINATED_STATE)
+		return;
+	ready_push(task, 0); // sleep over, or a timed block ran out
+}
+
+static void sleep_until(TCB_TypeDef *task, uint32_t wake_tick, uint16_t state)
+{
+	task->status = state;
+	task->timer.fn = task_timer_fire;
+	task->timer.arg = task;
+	ktimer_start_at(&task->timer, wake_tick, 0);
+}
+
+/* the current job is over: wait for the next release, or run it now when it is already due */
+static void edf_next_job(TCB_TypeDef *task, uint32_t now)
+{
+	task->edf.release += task->edf.period;
+	if((int32_t)(task->edf.release - now) <= 0)
+	{
+		task->edf.release = now; // late: the missed releases collapse into this one
+		edf_release(task);
+		task->status = TASK_RUNNING_STATE;
+		task->slice = 0; // ksched_switch queues it by its new deadline
+	}else
+	{
+		sleep_until(task, task->edf.release, TASK_PERIOD_STATE);
+	}
+	ksched_pend();
+}
+
+/* unlink from a singly linked list, returns 1 when found */
+static uint8_t list_remove(TCB_TypeDef **head, TCB_TypeDef **tail, TCB_TypeDef *task)
+{
+	TCB_TypeDef *prev = NULL;
+	for(TCB_TypeDef *t = *head; t != NULL; prev = t, t = t->next)
+	{
+		if(t != task) continue;
+		if(prev == NULL) *head = t->next;
+		else prev->next = t->next;
+		if(tail != NULL && *tail == t) *tail = prev;
+		t->next = NULL;
+		return 1;
+	}
+	return 0;
+}
+
+/* ticks until the timer wheel has work, 0 when something needs every tick */
+static uint32_t next_deadline(void)
+{
+	if(kreplay_playing) return 0; // paced from SysTick
+	return ktimer_next();
+}
+
+/*
+* Idle: with nothing ready and the timer wheel idle for KSCHED_TICKLESS_MIN
+* or more ticks, SysTick is stretched up to that point (__SysTick_sleep)
+* instead of waking the core every millisecond.
+*/
+static void idle_task(void *arg)
+{
+	(void)arg;
+	for(;;)
+	{
+		uint32_t pm = __irq_save();
+		uint32_t ticks = (ksched_ready_map == 0) ? next_deadline() : 0;
+		if(ticks >= KSCHED_TICKLESS_MIN)
+		{
+			uint32_t done = __SysTick_sleep(ticks);
+			if(done != 0)
+			{
+				idle_sleeps++;
+				idle_suppressed += done;
+			}
+			__irq_restore(pm);
+		}else
+		{
+			__irq_restore(pm);
+			SYS_SLEEP_WFI();
+		}
+	}
+}
+
+void ksched_idle_stats(uint32_t *sleeps, uint32_t *ticks)
+{
+	*sleeps = idle_sleeps;
+	*ticks = idle_suppressed;
+}
+
+void ksched_init(void)
+{
+	NVIC_SetPriority(PendSV_IRQn, 15); // below SysTick and every device interrupt
+	NVIC_SetPriority(SVCall_IRQn, 15); // syscalls may wait for the USART handlers (syscall.h)
+	task_create("idle", idle_task, NULL, KSCHED_IDLE_PRIO);
+}
+
+void ksched_start(void)
+{
+	started = 1;
+	ksched_port_start();
+}
+
+uint8_t ksched_running(void)
+{
+	return started;
+}
+
+/*
+* Fold the cycles since each stamp into execution_time (running task) and
+* waiting_time (ready tasks). ksched_switch does the same for the two tasks
+* it swaps; doing it every tick as well keeps the 32-bit CYCCNT deltas far
+* below its wrap (23.8 s at 180 MHz) for a task that runs or waits long.
+*/
+static void account(uint32_t now)
+{
+	TCB_TypeDef *cur = ksched_current;
+	uint32_t map;
+	if(cur != NULL)
+	{
+		cur->execution_time += now - cur->acct_stamp;
+		cur->acct_stamp = now;
+	}
+	for(map = ksched_ready_map; map != 0; map &= ~(0x80000000UL >> __CLZ(map)))
+	{
+		for(TCB_TypeDef *t = ready_head[__CLZ(map)]; t != NULL; t = t->next)
+		{
+			t->waiting_time += now - t->acct_stamp;
+			t->acct_stamp = now;
+		}
+	}
+}
+
+void ksched_account(void)
+{
+	uint32_t pm = __irq_save();
+	account(__getCycleCount());
+	__irq_restore(pm);
+}
+
+void ksched_tick(void)
+{
+	TCB_TypeDef *cur;
+	uint32_t now, pm;
+	pm = __irq_save();
+	now = getmsTick();
+	ktimer_tick(now); // software timers run before the scheduler starts too
+	if(!started)
+	{
+		__irq_restore(pm);
+		return;
+	}
+	account(__getCycleCount());
+	cur = ksched_current;
+	// EDF jobs past their deadline, the list is sorted so the first one due ends the scan
+	for(TCB_TypeDef *t = ready_head[KSCHED_EDF_PRIO]; t != NULL && (int32_t)(now - t->edf.abs_deadline) >= 0; t = t->next)
+	{
+		if(!t->edf.missed)
+		{
+			t->edf.missed = 1;
+			t->edf.misses++;
+		}
+	}
+	if(cur != NULL && cur->status == TASK_RUNNING_STATE)
+	{
+		if(cur->priority == KSCHED_EDF_PRIO)
+		{
+			if(!cur->edf.missed && (int32_t)(now - cur->edf.abs_deadline) >= 0)
+			{
+				cur->edf.missed = 1;
+				cur->edf.misses++;
+			}
+			if(cur->edf.budget > 0 && --cur->edf.budget == 0)
+			{
+				// budget exhausted: the job is stopped and counts as missed
+				cur->edf.overruns++;
+				if(!cur->edf.missed) cur->edf.misses++;
+				edf_next_job(cur, now);
+			}else if(ready_head[KSCHED_EDF_PRIO] != NULL && edf_before(ready_head[KSCHED_EDF_PRIO], cur))
+			{
+				ksched_pend();
+			}
+		}else
+		{
+			if(cur->slice > 0) cur->slice--;
+			if(ksched_top() < cur->priority || (cur->slice == 0 && ready_head[cur->priority] != NULL))
+				ksched_pend();
+		}
+	}
+	__irq_restore(pm);
+}
+
+TCB_TypeDef *ksched_switch(void)
+{
+	uint32_t pm = __irq_save();
+	uint32_t now = __getCycleCount();
+	TCB_TypeDef *prev = ksched_current, *next;
+	if(prev != NULL)
+		prev->execution_time += now - prev->acct_stamp;
+	if(prev != NULL && KSCHED_FRAME_FPU(prev))
+	{
+		prev->fpu_used = 1;
+		ksched_fp_switches++;
+	}
+	if(prev != NULL && prev->status == TASK_RUNNING_STATE)
+	{
+		if(prev->slice == 0)
+		{
+			prev->slice = KSCHED_SLICE_TICKS;
+			ready_push(prev, 0); // slice used up: behind its peers
+		}else
+		{
+			ready_push(prev, 1); // preempted: resumes first at its level
+		}
+	}
+	next = ready_pop(ksched_top());
+	now = __getCycleCount();
+	next->waiting_time += now - next->acct_stamp;
+	next->acct_stamp = now;
+	next->status = TASK_RUNNING_STATE;
+	if(next->slice == 0) next->slice = KSCHED_SLICE_TICKS;
+	ksched_current = next;
+	if(next != prev)
+	{
+		ksched_switches++;
+		next->switches++;
+		kdata_set_pid(next->task_id);
+		KTRACE_CTX_SWITCH(next->task_id);
+	}
+	__irq_restore(pm);
+	return next;
+}
+
+void ksched_ready(TCB_TypeDef *task)
+{
+	uint32_t pm = __irq_save();
+	TCB_TypeDef *cur = ksched_current;
+	if(task->status == TASK_READY_STATE || task->status == TASK_RUNNING_STATE)
+	{
+		__irq_restore(pm); // already woken, e.g. by its timeout
+		return;
+	}
+	ktimer_cancel(&task->timer);
+	ready_push(task, 0);
+	if(started && (cur == NULL || task->priority < cur->priority ||
+		(task->priority == KSCHED_EDF_PRIO && cur->priority == KSCHED_EDF_PRIO && edf_before(task, cur))))
+		ksched_pend();
+	__irq_restore(pm);
+}
+
+void ksched_set_priority(TCB_TypeDef *task, uint8_t priority)
+{
+	uint32_t pm = __irq_save();
+	TCB_TypeDef *cur = ksched_current;
+	if(task->priority == priority)
+	{
+		__irq_restore(pm);
+		return;
+	}
+	if(task->status == TASK_READY_STATE)
+	{
+		// requeue at the new level, the wait so far stays accounted
+		uint32_t p = task->priority;
+		list_remove(&ready_head[p], &ready_tail[p], task);
+		if(ready_head[p] == NULL) ksched_ready_map &= ~(1UL << (31U - p));
+		task->waiting_time += __getCycleCount() - task->acct_stamp;
+		task->priority = priority;
+		ready_push(task, 0);
+		if(started && cur != NULL && priority < cur->priority)
+			ksched_pend();
+	}else
+	{
+		task->priority = priority;
+		if(task == cur && ksched_ready_map != 0 && ksched_top() < priority)
+			ksched_pend(); // dropped below a ready task
+	}
+	__irq_restore(pm);
+}
+
+void ksched_block(uint16_t state)
+{
+	ksched_block_timeout(state, 0);
+}
+
+void ksched_block_timeout(uint16_t state, uint32_t ticks)
+{
+	uint32_t pm = __irq_save();
+	TCB_TypeDef *cur = ksched_current;
+	if(ticks != 0)
+		sleep_until(cur, getmsTick() + ticks, state);
+	else
+		cur->status = state;
+	ksched_pend();
+	__irq_restore(pm);
+}
+
+void ksched_sleep(uint32_t ticks)
+{
+	uint32_t pm;
+	TCB_TypeDef *cur;
+	if(ticks == 0)
+	{
+		ksched_yield();
+		return;
+	}
+	pm = __irq_save();
+	cur = ksched_current;
+	sleep_until(cur, getmsTick() + ticks, TASK_SLEEPING_STATE);
+	ksched_pend();
+	__irq_restore(pm);
+}
+
+void ksched_yield(void)
+{
+	uint32_t pm = __irq_save();
+	ksched_current->slice = 0;
+	ksched_pend();
+	__irq_restore(pm);
+}
+
+void ksched_remove(TCB_TypeDef *task)
+{
+	uint32_t pm = __irq_save();
+	if(task->status == TASK_READY_STATE)
+	{
+		uint32_t p = task->priority;
+		list_remove(&ready_head[p], &ready_tail[p], task);
+		if(ready_head[p] == NULL) ksched_ready_map &= ~(1UL << (31U - p));
+	}
+	ktimer_cancel(&task->timer);
+	if(task->priority == KSCHED_EDF_PRIO)
+	{
+		edf_util -= task->edf.util;
+		task->edf.util = 0;
+	}
+	task->status = TASK_TERMINATED_STATE;
+	if(task == ksched_current) ksched_pend();
+	__irq_restore(pm);
+}
+
+StatusTypeDef ksched_edf_admit(TCB_TypeDef *task, uint32_t period, uint32_t wcet, uint32_t deadline)
+{
+	uint32_t pm, window, util;
+	if(period == 0 || wcet == 0 || deadline == 0 || deadline > period || wcet > deadline)
+		return SYS_ERROR;
+	window = deadline; // density wcet/min(period, deadline), deadline <= period
+	util = (wcet * 1000U + window - 1U) / window;
+	pm = __irq_save();
+	if(edf_util + util > KSCHED_EDF_UTIL_MAX)
+	{
+		__irq_restore(pm);
+		return SYS_ERROR;
+	}
+	edf_util += util;
+	__irq_restore(pm);
+	task->edf.period = period;
+	task->edf.wcet = wcet;
+	task->edf.deadline = deadline;
+	task->edf.util = (uint16_t)util;
+	task->edf.jobs = 0;
+	task->edf.misses = 0;
+	task->edf.overruns = 0;
+	task->edf.release = getmsTick();
+	edf_release(task);
+	return SYS_OK;
+}
+
+void ksched_wait_period(void)
+{
+	uint32_t pm = __irq_save();
+	TCB_TypeDef *cur = ksched_current;
+	uint32_t now = getmsTick();
+	if(cur->priority != KSCHED_EDF_PRIO)
+	{
+		__irq_restore(pm);
+		return;
+	}
+	if(!cur->edf.missed && (int32_t)(now - cur->edf.abs_deadline) >= 0)
+		cur->edf.misses++;
+	cur->edf.jobs++;
+	edf_next_job(cur, now);
+	__irq_restore(pm);
+}
+
+uint32_t ksched_edf_util(void)
+{
+	return edf_util;
+}
+
+#ifndef HOST_SIM
+/*
+* First frame of a task, laid out as PendSV_Handler leaves a preempted one:
+* r4-r11 and EXC_RETURN below the hardware frame (r0-r3, r12, lr, pc, xPSR).
+* Returning from entry lands in task_exit.
+*/
+void ksched_port_init_stack(TCB_TypeDef *task, void (*entry)(void *), void *arg)
+{
+	uint32_t *sp = (uint32_t*)(((uint32_t)task->stack + task->stack_size) & ~7UL);
+	*--sp = DUMMY_XPSR;                     // xPSR, Thumb bit
+	*--sp = (uint32_t)entry & ~1UL;         // pc
+	*--sp = (uint32_t)task_exit;            // lr
+	*--sp = 0;                              // r12
+	*--sp = 0;                              // r3
+	*--sp = 0;                              // r2
+	*--sp = 0;                              // r1
+	*--sp = (uint32_t)arg;                  // r0
+	*--sp = EXC_RETURN_THREAD_PSP;          // lr in the handler: thread mode, PSP, no FP context
+	for(uint32_t i = 0; i < 8; i++)
+		*--sp = 0;                          // r11..r4
+	task->psp = sp;
+}
+
+/*
+* Save the outgoing context on its PSP stack, pick the next task, restore.
+* Bit 4 of EXC_RETURN is clear only when the task had an FP context (CONTROL.FPCA):
+* the hardware reserved s0-s15/FPSCR (lazy stacking, written on the first FP
+* instruction in handler mode, here the vstmdb) and s16-s31 are ours to save.
+* Tasks that never touched the FPU take neither cost.
+*/
+__attribute__((naked)) void PendSV_Handler(void)
+{
+	asm volatile(
+		"mrs r0, psp\n\t"
+		"movw r2, #:lower16:ksched_current\n\t"
+		"movt r2, #:upper16:ksched_current\n\t"
+		"ldr r1, [r2]\n\t"
+		"cbz r1, 1f\n\t"                // first switch, nothing to save
+		"tst lr, #0x10\n\t"
+		"it eq\n\t"
+		"vstmdbeq r0!, {s16-s31}\n\t"
+		"stmdb r0!, {r4-r11, lr}\n\t"
+		"str r0, [r1, #8]\n\t"          // TCB_TypeDef.psp
+		"1:\n\t"
+		"bl ksched_switch\n\t"
+		"ldr r0, [r0, #8]\n\t"
+		"ldmia r0!, {r4-r11, lr}\n\t"
+		"tst lr, #0x10\n\t"
+		"it eq\n\t"
+		"vldmiaeq r0!, {s16-s31}\n\t"
+		"msr psp, r0\n\t"
+		"isb\n\t"
+		"bx lr\n\t"
+	);
+}
+
+void ksched_port_start(void)
+{
+	ksched_pend(); // PendSV with ksched_current == NULL starts the first task
+	__ISB();
+	for(;;)
+	{
+		__WFI();
+	}
+}
+#endif
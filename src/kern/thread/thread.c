@@ -29,4 +29,392 @@
  */
 #include <types.h> 
 #include <thread.h>
+#include <schedule.h>
+#include <kstack.h>
+#include <kconsole.h>
+#include <kstdio.h>
+#include <kstring.h>
+#include <kmath.h>
+#include <kprobe.h>
+#include <ktimer.h>
+#include <vfs.h>
+#include <ksync.h>
+#include <sys_clock.h>
 
+static TCB_TypeDef task_pool[MAX_TASKS];
+static uint32_t task_stacks[MAX_TASKS][SIZE_TASK_STACK / 4U] __attribute__((aligned(8)));
+static uint16_t next_task_id = TASK_FIRST_ID;
+
+/* claim a pool slot and set up the TCB and its stack, the task is not ready yet */
+static TCB_TypeDef *task_alloc(const char *name, uint8_t priority)
+{
+	TCB_TypeDef *task = NULL;
+	uint32_t pm, i;
+	pm = __irq_save();
+	for(i = 0; i < MAX_TASKS; i++)
+	{
+		// an exited task still owning a mutex keeps its slot, see kmutex_exit
+		if(task_pool[i].magic_number != TASK_MAGIC ||
+			(task_pool[i].status == TASK_TERMINATED_STATE && task_pool[i].mutexes == 0))
+		{
+			task = &task_pool[i];
+			task->magic_number = TASK_MAGIC;
+			task->status = TASK_BLOCKED_STATE; // claimed, not runnable yet
+			task->task_id = next_task_id++;
+			break;
+		}
+	}
+	__irq_restore(pm);
+	if(task == NULL) return NULL;
+	kstack_unregister(task_stacks[i]);
+	task->execution_time = 0;
+	task->waiting_time = 0;
+	task->acct_stamp = 0;
+	task->switches = 0;
+	task->digital_sinature = 0x00000001;
+	task->priority = priority;
+	task->base_priority = priority;
+	task->held = NULL;
+	task->mutexes = 0;
+	task->wait_mutex = NULL;
+	task->wait_sem = NULL;
+	task->wait_next = NULL;
+	task->sys_errno = 0;
+	task->strace_cycles = 0;
+	vfs_task_init(task);
+	task->slice = KSCHED_SLICE_TICKS;
+	ktimer_init(&task->timer, NULL, task); // armed by the scheduler
+	task->next = NULL;
+	task->name = name;
+	task->stack = task_stacks[i];
+	task->stack_size = SIZE_TASK_STACK;
+	kstack_paint(task->stack, task->stack_size);
+	kstack_register(name, task->stack, task->stack_size);
+	return task;
+}
+
+TCB_TypeDef *task_create(const char *name, task_fn fn, void *arg, uint8_t priority)
+{
+	TCB_TypeDef *task;
+	if(fn == NULL || priority == KSCHED_EDF_PRIO || priority > KSCHED_IDLE_PRIO) return NULL;
+	task = task_alloc(name, priority);
+	if(task == NULL) return NULL;
+	ksched_port_init_stack(task, fn, arg);
+	ksched_ready(task);
+	return task;
+}
+
+TCB_TypeDef *task_create_edf(const char *name, task_fn fn, void *arg, uint32_t period_ms,
+	uint32_t wcet_ms, uint32_t deadline_ms)
+{
+	TCB_TypeDef *task;
+	if(fn == NULL) return NULL;
+	task = task_alloc(name, KSCHED_EDF_PRIO);
+	if(task == NULL) return NULL;
+	if(ksched_edf_admit(task, (period_ms * TICK_HZ) / 1000U, (wcet_ms * TICK_HZ) / 1000U,
+		(deadline_ms * TICK_HZ) / 1000U) != SYS_OK)
+	{
+		kstack_unregister(task->stack);
+		task->status = TASK_TERMINATED_STATE; // slot back to the pool
+		return NULL;
+	}
+	ksched_port_init_stack(task, fn, arg);
+	ksched_ready(task);
+	return task;
+}
+
+void task_wait_period(void)
+{
+	ksched_wait_period();
+}
+
+void task_exit(void)
+{
+	uint32_t pm;
+	vfs_task_exit(ksched_current);
+	pm = __irq_save();
+	kmutex_exit(ksched_current);
+	ksched_remove(ksched_current);
+	__irq_restore(pm);
+	for(;;); // PendSV is pending, never scheduled again
+}
+
+TCB_TypeDef *task_self(void)
+{
+	return ksched_current;
+}
+
+/* a sleep worked out in 64 bits, cut to TASK_SLEEP_MAX ticks */
+static uint32_t sleep_ticks(uint64_t ticks)
+{
+	return ticks > TASK_SLEEP_MAX ? TASK_SLEEP_MAX : (uint32_t)ticks;
+}
+
+void task_sleep(uint32_t ms)
+{
+	ksched_sleep(sleep_ticks(((uint64_t)ms * TICK_HZ) / 1000U));
+}
+
+void task_nanosleep(uint32_t sec, uint32_t nsec)
+{
+	uint32_t tick_ns = 1000000000UL / TICK_HZ;
+	ksched_sleep(sleep_ticks((uint64_t)sec * TICK_HZ + ((uint64_t)nsec + tick_ns - 1U) / tick_ns));
+}
+
+void task_yield(void)
+{
+	ksched_yield();
+}
+
+TCB_TypeDef *task_at(uint32_t i)
+{
+	if(i >= MAX_TASKS || task_pool[i].magic_number != TASK_MAGIC) return NULL;
+	return &task_pool[i];
+}
+
+static char *state_name(uint16_t status)
+{
+	switch(status)
+	{
+	case TASK_READY_STATE: return "ready";
+	case TASK_RUNNING_STATE: return "running";
+	case TASK_SLEEPING_STATE: return "sleeping";
+	case TASK_TERMINATED_STATE: return "terminated";
+	case TASK_PERIOD_STATE: return "period";
+	default: return "blocked";
+	}
+}
+
+/* core clock in MHz, CYCCNT counts per microsecond */
+static uint32_t task_mhz(void)
+{
+#ifndef HOST_SIM
+	return __AHB_CLK();
+#else
+	return HOST_SIM_HCLK / 1000000UL;
+#endif
+}
+
+static uint32_t task_ms(uint64_t cycles)
+{
+	return (uint32_t)__udiv64(cycles, (uint64_t)task_mhz() * 1000ULL);
+}
+
+void task_report(void)
+{
+	uint32_t sleeps, ticks;
+	ksched_account();
+	kprintf("id,name,prio,state,exec_ms,wait_ms,stack_used,fpu\n");
+	for(uint32_t i = 0; i < MAX_TASKS; i++)
+	{
+		TCB_TypeDef *t = task_at(i);
+		if(t == NULL || t->status == TASK_TERMINATED_STATE) continue;
+		kprintf("%d,%s,%d,%s,%d,%d,%d,%d\n", t->task_id, t->name, t->priority, state_name(t->status),
+			task_ms(t->execution_time), task_ms(t->waiting_time), kstack_used(t->stack, t->stack_size),
+			t->fpu_used);
+	}
+	ksched_idle_stats(&sleeps, &ticks);
+	kprintf("tickless: %d sleeps, %d ticks suppressed\n", sleeps, ticks);
+	kprintf("switches: %d, %d with an FP context\n", ksched_switches, ksched_fp_switches);
+}
+
+void task_edf_report(void)
+{
+	uint32_t util = ksched_edf_util();
+	kprintf("id,name,period,wcet,deadline,util_pm,jobs,misses,overruns\n");
+	for(uint32_t i = 0; i < MAX_TASKS; i++)
+	{
+		TCB_TypeDef *t = task_at(i);
+		if(t == NULL || t->status == TASK_TERMINATED_STATE || t->priority != KSCHED_EDF_PRIO) continue;
+		kprintf("%d,%s,%d,%d,%d,%d,%d,%d,%d\n", t->task_id, t->name, t->edf.period, t->edf.wcet,
+			t->edf.deadline, t->edf.util, t->edf.jobs, t->edf.misses, t->edf.overruns);
+	}
+	kprintf("edf utilization: %d.%d%d%d of %d\n", util / 1000U, (util / 100U) % 10U, (util / 10U) % 10U,
+		util % 10U, KSCHED_EDF_UTIL_MAX / 1000U);
+}
+
+/* what top compares against: one copy per pool slot plus the global counters */
+typedef struct
+{
+	uint64_t exec[MAX_TASKS];
+	uint64_t wait[MAX_TASKS];
+	uint32_t switches[MAX_TASKS];
+	uint16_t id[MAX_TASKS];
+	uint32_t all_switches;
+	uint64_t isr;
+	uint32_t ms;
+}task_sample;
+
+static task_sample top_before, top_after;
+
+/* interrupt handlers that carry a kprobe: USART2/6, SysTick (scheduler tick included), TIM2 */
+static uint64_t task_isr_cycles(void)
+{
+	return kprobe_table[KPROBE_UART_ISR].sum + kprobe_table[KPROBE_SYSTICK].sum +
+		kprobe_table[KPROBE_TIM2].sum;
+}
+
+static void task_sample_take(task_sample *s)
+{
+	uint32_t pm = __irq_save();
+	ksched_account();
+	for(uint32_t i = 0; i < MAX_TASKS; i++)
+	{
+		TCB_TypeDef *t = task_at(i);
+		s->id[i] = (t != NULL && t->status != TASK_TERMINATED_STATE) ? t->task_id : 0;
+		s->exec[i] = (t != NULL) ? t->execution_time : 0;
+		s->wait[i] = (t != NULL) ? t->waiting_time : 0;
+		s->switches[i] = (t != NULL) ? t->switches : 0;
+	}
+	s->all_switches = ksched_switches;
+	s->isr = task_isr_cycles();
+	s->ms = getmsTick();
+	__irq_restore(pm);
+}
+
+/* per mille of window, printed as x.y */
+static void task_print_share(uint64_t cycles, uint64_t window, char sep)
+{
+	uint32_t pm = (window != 0) ? (uint32_t)__udiv64(cycles * 1000ULL, window) : 0;
+	kprintf("%d.%d%c", pm / 10U, pm % 10U, sep);
+}
+
+void task_top(uint32_t ms)
+{
+	uint64_t window, busy = 0, isr;
+	uint32_t elapsed, sw;
+	task_sample_take(&top_before);
+	task_sleep(ms);
+	task_sample_take(&top_after);
+	elapsed = top_after.ms - top_before.ms;
+	if(elapsed == 0) return;
+	window = (uint64_t)elapsed * task_mhz() * 1000ULL;
+	// "probe reset" in the window: count from zero
+	isr = (top_after.isr >= top_before.isr) ? top_after.isr - top_before.isr : top_after.isr;
+	sw = top_after.all_switches - top_before.all_switches;
+	kprintf("id,name,prio,cpu,wait,switches_s\n");
+	for(uint32_t i = 0; i < MAX_TASKS; i++)
+	{
+		uint64_t exec, wait;
+		uint32_t n;
+		TCB_TypeDef *t = task_at(i);
+		if(top_after.id[i] == 0 || t == NULL) continue;
+		exec = top_after.exec[i];
+		wait = top_after.wait[i];
+		n = top_after.switches[i];
+		if(top_before.id[i] == top_after.id[i]) // same task at both ends, else it started in the window
+		{
+			exec -= top_before.exec[i];
+			wait -= top_before.wait[i];
+			n -= top_before.switches[i];
+		}
+		busy += exec;
+		kprintf("%d,%s,%d,", t->task_id, t->name, t->priority);
+		task_print_share(exec, window, ',');
+		task_print_share(wait, window, ',');
+		kprintf("%d\n", (uint32_t)__udiv64((uint64_t)n * 1000ULL, elapsed));
+	}
+	kprintf("window %d ms, %d switches/s, isr ", elapsed, (uint32_t)__udiv64((uint64_t)sw * 1000ULL, elapsed));
+	task_print_share(isr, window, ',');
+	// CYCCNT stops while the core sleeps in WFI: the part of the window nobody accounted for
+	kprintf(" sleep ");
+	task_print_share((busy < window) ? window - busy : 0, window, '\n');
+}
+
+static volatile uint32_t ctxsw_left;
+static volatile float ctxsw_acc = 1.0f;
+
+static void ctxsw_int(void *arg)
+{
+	(void)arg;
+	while(ctxsw_left > 0)
+	{
+		ctxsw_left--;
+		task_yield();
+	}
+}
+
+static void ctxsw_fp(void *arg)
+{
+	(void)arg;
+	while(ctxsw_left > 0)
+	{
+		ctxsw_left--;
+		ctxsw_acc = ctxsw_acc * 1.0001f; // FP context live at every switch
+		task_yield();
+	}
+}
+
+uint32_t task_ctxsw_cycles(uint8_t fpu, uint32_t n)
+{
+	task_fn fn = fpu ? ctxsw_fp : ctxsw_int;
+	uint32_t pm, t0, t1;
+	TCB_TypeDef *a, *b;
+	if(n == 0) return 0;
+	ctxsw_left = 2U * n;
+	pm = __irq_save(); // both exist before either runs
+	a = task_create("ctxsw_a", fn, NULL, TASK_CTXSW_PRIO);
+	b = task_create("ctxsw_b", fn, NULL, TASK_CTXSW_PRIO);
+	if(a == NULL || b == NULL)
+	{
+		ctxsw_left = 0; // the one that was created exits right away
+		__irq_restore(pm);
+		return 0;
+	}
+	t0 = __getCycleCount();
+	__irq_restore(pm);
+	// the pair outranks the caller: back here once both returned
+	t1 = __getCycleCount();
+	return (t1 - t0) / (2U * n);
+}
+
+static void cmd_ctxsw(char *args)
+{
+	uint32_t n = 1000, c_int, c_fp;
+	char *w = kconsole_word(&args);
+	if(w[0] != '\0')
+		n = (uint32_t)__str_to_num((uint8_t*)w, 10);
+	if(task_self() == NULL || task_self()->priority <= TASK_CTXSW_PRIO)
+	{
+		kprintf("ctxsw: run from a task below priority %d\n", TASK_CTXSW_PRIO);
+		return;
+	}
+	c_int = task_ctxsw_cycles(0, n);
+	c_fp = task_ctxsw_cycles(1, n);
+	kprintf("ctxsw,switches,cycles_int,cycles_fp,fp_extra\n");
+	kprintf("yield,%d,%d,%d,%d\n", 2U * n, c_int, c_fp, c_fp - c_int);
+}
+
+static void cmd_top(char *args)
+{
+	uint32_t ms = 1000;
+	char *w = kconsole_word(&args);
+	if(w[0] != '\0')
+		ms = (uint32_t)__str_to_num((uint8_t*)w, 10) * 1000U;
+	if(task_self() == NULL || ms == 0 || ms > TASK_TOP_MAX_MS)
+	{
+		kprintf("top: from a task, 1 to %d seconds\n", TASK_TOP_MAX_MS / 1000U);
+		return;
+	}
+	task_top(ms);
+}
+
+static void cmd_ps(char *args)
+{
+	(void)args;
+	task_report();
+}
+
+static void cmd_edf(char *args)
+{
+	(void)args;
+	task_edf_report();
+}
+
+void task_init(void)
+{
+	kconsole_register("ps", cmd_ps, "tasks: id,name,prio,state,exec_ms,wait_ms,stack_used");
+	kconsole_register("edf", cmd_edf, "EDF tasks: period,wcet,deadline,jobs,misses,overruns");
+	kconsole_register("top", cmd_top, "CPU share, ready-wait, switches/s and ISR time: top [seconds]");
+	kconsole_register("ctxsw", cmd_ctxsw, "context switch cost, integer and FP tasks: ctxsw [n]");
+}
@@ -0,0 +1,900 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <vfs.h>
+#include <errno.h>
+#include <cm4.h>
+#include <kconsole.h>
+#include <kstdio.h>
+#include <thread.h>
+#include <schedule.h>
+#include <syscall.h>
+#include <UsartRingBuffer.h>
+#include <system_config.h>
+#include <sys_spi.h>
+#include <kwork.h>
+
+extern UART_HandleTypeDef huart6;
+
+static const vfs_node *vfs_nodes[VFS_MAX_NODES];
+static uint32_t vfs_node_count = 0;
+static vfs_file vfs_pool[VFS_MAX_FILES];
+static vfs_file *vfs_boot_files[TASK_FILES]; // descriptors before the first task runs
+static uint32_t vfs_opens, vfs_emfile, vfs_enfile;
+/* nodes with one reader, see vfs_own; vfs_readers holds it by node index */
+static uint32_t vfs_owned;
+static TCB_TypeDef *vfs_readers[VFS_MAX_NODES];
+
+/* a task inside vfs_poll; in and out are node bits (index in vfs_nodes) */
+typedef struct vfs_poller_t
+{
+	TCB_TypeDef *task;          /* NULL: free */
+	uint32_t in;
+	uint32_t out;
+	uint32_t deadline;          /* tick the timeout ends at */
+	uint8_t forever;
+	volatile uint8_t woken;     /* vfs_notify came since the scan started */
+}vfs_poller;
+
+static vfs_poller vfs_pollers[MAX_TASKS];
+static volatile uint32_t vfs_poll_waiting; // claimed pollers, vfs_notify returns at once without
+static uint32_t vfs_polls, vfs_poll_sleeps, vfs_poll_wakeups;
+
+/* a read or write of a VFS_NODE_TASK node the svc gave to the vfs task */
+typedef struct vfs_handoff_t
+{
+	kwork work;
+	TCB_TypeDef *task;          /* NULL: free */
+	const vfs_node *node;
+	void *buf;
+	uint32_t len;
+	uint32_t off;
+	uint8_t write;
+	volatile uint8_t done;
+	int32_t ret;
+}vfs_handoff;
+
+static vfs_handoff vfs_handoffs[MAX_TASKS];
+static kworkq vfs_wq;
+static TCB_TypeDef *vfs_task_tcb;
+static uint32_t vfs_handoff_count;
+
+/* 0, 1 and 2 of every task; the base reference keeps them out of the pool */
+static vfs_file vfs_console_in = { &vfs_tty0, 0, O_RDONLY, 1 };
+static vfs_file vfs_console_out = { &vfs_tty0, 0, O_WRONLY, 1 };
+
+/* ---- device nodes ---- */
+
+/* console and USART6: what has arrived, never waits; -EAGAIN when nothing has */
+static int32_t uart_node_read(const vfs_node *n, void *buf, uint32_t len, uint32_t off)
+{
+	UART_HandleTypeDef *uart = (UART_HandleTypeDef*)n->dev;
+	uint8_t *p = (uint8_t*)buf;
+	uint32_t i = 0;
+	int c;
+	(void)off;
+	while(i < len && (c = Uart_read(uart)) >= 0)
+		p[i++] = (uint8_t)c;
+	return i != 0 || len == 0 ? (int32_t)i : -EAGAIN;
+}
+
+static int32_t uart_node_write(const vfs_node *n, const void *buf, uint32_t len, uint32_t off)
+{
+	UART_HandleTypeDef *uart = (UART_HandleTypeDef*)n->dev;
+	const uint8_t *p = (const uint8_t*)buf;
+	(void)off;
+	for(uint32_t i = 0; i < len; i++)
+		Uart_write(p[i], uart);
+	return (int32_t)len;
+}
+
+static uint32_t uart_node_poll(const vfs_node *n)
+{
+	UART_HandleTypeDef *uart = (UART_HandleTypeDef*)n->dev;
+	ring_buffer *tx = uart->pTxBuffPtr;
+	uint32_t ev = IsDataAvailable(uart) > 0 ? POLLIN : 0U;
+	if((tx->head + 1U) % uart->TxXferSize != tx->tail) ev |= POLLOUT;
+	return ev;
+}
+
+static int32_t uart_node_ioctl(const vfs_node *n, uint32_t req, uintptr_t arg)
+{
+	if(req != IOC_NREAD) return -EIOCTL;
+	if(arg == 0) return -EFAULT;
+	*(uint32_t*)arg = (uint32_t)IsDataAvailable((UART_HandleTypeDef*)n->dev);
+	return 0;
+}
+
+/*
+* One chip-select cycle, at most 255 bytes (spi_rw counts in a byte); a
+* longer transfer is a short one. A task waits for the bus; a call from the
+* svc runs in the vfs task (vfs_node_rw) and only tries the bus when that
+* task could not be started.
+*/
+static int32_t spi_node_rw(const vfs_node *n, const void *buf, uint32_t len, uint32_t off)
+{
+	uint8_t size = len > 0xFFU ? 0xFFU : (uint8_t)len;
+	StatusTypeDef status;
+	(void)n; (void)off;
+	if(size == 0) return 0;
+	if(!__in_handler())
+		status = spi_rw((uint8_t*)buf, size);
+	else
+		status = spi_rw_try((uint8_t*)buf, size);
+	if(status == SYS_BUSY) return -EAGAIN;
+	return status == SYS_OK ? size : -EIO;
+}
+
+static int32_t spi_node_read(const vfs_node *n, void *buf, uint32_t len, uint32_t off)
+{
+	return spi_node_rw(n, buf, len, off);
+}
+
+static uint8_t vfs_ramdisk[VFS_RAMDISK_SIZE];
+
+/* reads stop at the end, writes past it are -ENOSPC */
+static int32_t ram_node_read(const vfs_node *n, void *buf, uint32_t len, uint32_t off)
+{
+	if(off >= n->size) return 0;
+	if(len > n->size - off) len = n->size - off;
+	__builtin_memcpy(buf, (uint8_t*)n->dev + off, len);
+	return (int32_t)len;
+}
+
+static int32_t ram_node_write(const vfs_node *n, const void *buf, uint32_t len, uint32_t off)
+{
+	if(len == 0) return 0;
+	if(off >= n->size) return -ENOSPC;
+	if(len > n->size - off) len = n->size - off;
+	__builtin_memcpy((uint8_t*)n->dev + off, buf, len);
+	return (int32_t)len;
+}
+
+/* one reader and one writer side, indices run free */
+typedef struct vfs_fifo_t
+{
+	uint8_t buf[VFS_FIFO_SIZE];
+	volatile uint32_t head;     /* writer */
+	volatile uint32_t tail;     /* reader */
+}vfs_fifo;
+
+static vfs_fifo vfs_fifos[2];
+
+static int32_t fifo_node_read(const vfs_node *n, void *buf, uint32_t len, uint32_t off)
+{
+	vfs_fifo *q = (vfs_fifo*)n->dev;
+	uint8_t *p = (uint8_t*)buf;
+	uint32_t i = 0, pm;
+	(void)off;
+	if(len == 0) return 0;
+	pm = __irq_save();
+	for(; i < len && q->tail != q->head; i++)
+		p[i] = q->buf[q->tail++ & (VFS_FIFO_SIZE - 1U)];
+	__irq_restore(pm);
+	if(i == 0) return -EAGAIN;
+	vfs_notify(q, POLLOUT);
+	return (int32_t)i;
+}
+
+static int32_t fifo_node_write(const vfs_node *n, const void *buf, uint32_t len, uint32_t off)
+{
+	vfs_fifo *q = (vfs_fifo*)n->dev;
+	const uint8_t *p = (const uint8_t*)buf;
+	uint32_t i = 0, pm;
+	(void)off;
+	if(len == 0) return 0;
+	pm = __irq_save();
+	for(; i < len && q->head - q->tail < VFS_FIFO_SIZE; i++)
+		q->buf[q->head++ & (VFS_FIFO_SIZE - 1U)] = p[i];
+	__irq_restore(pm);
+	if(i == 0) return -EAGAIN;
+	vfs_notify(q, POLLIN);
+	return (int32_t)i;
+}
+
+static uint32_t fifo_node_poll(const vfs_node *n)
+{
+	vfs_fifo *q = (vfs_fifo*)n->dev;
+	uint32_t used = q->head - q->tail;
+	return (used != 0 ? POLLIN : 0U) | (used < VFS_FIFO_SIZE ? POLLOUT : 0U);
+}
+
+static int32_t fifo_node_ioctl(const vfs_node *n, uint32_t req, uintptr_t arg)
+{
+	vfs_fifo *q = (vfs_fifo*)n->dev;
+	if(req != IOC_NREAD) return -EIOCTL;
+	if(arg == 0) return -EFAULT;
+	*(uint32_t*)arg = q->head - q->tail;
+	return 0;
+}
+
+static const vfs_ops uart_ops = { uart_node_read, uart_node_write, uart_node_ioctl, uart_node_poll };
+static const vfs_ops spi_ops = { spi_node_read, spi_node_rw, NULL, NULL };
+static const vfs_ops ram_ops = { ram_node_read, ram_node_write, NULL, NULL };
+static const vfs_ops fifo_ops = { fifo_node_read, fifo_node_write, fifo_node_ioctl, fifo_node_poll };
+
+const vfs_node vfs_tty0 = { "/dev/tty0", &uart_ops, __CONSOLE, 0, VFS_NODE_TTY };
+const vfs_node vfs_tty1 = { "/dev/tty1", &uart_ops, &huart6, 0, VFS_NODE_TTY };
+const vfs_node vfs_spi1 = { "/dev/spi1", &spi_ops, NULL, 0, VFS_NODE_TASK };
+const vfs_node vfs_ram0 = { "/dev/ram0", &ram_ops, vfs_ramdisk, VFS_RAMDISK_SIZE, 0 };
+const vfs_node vfs_fifo0 = { "/dev/fifo0", &fifo_ops, &vfs_fifos[0], 0, 0 };
+const vfs_node vfs_fifo1 = { "/dev/fifo1", &fifo_ops, &vfs_fifos[1], 0, 0 };
+
+/* ---- nodes and files ---- */
+
+static uint8_t vfs_name_eq(const char *a, const char *b)
+{
+	for(uint32_t i = 0; i < VFS_NAME_MAX; i++)
+	{
+		if(a[i] != b[i]) return 0;
+		if(a[i] == '\0') return 1;
+	}
+	return 0;
+}
+
+StatusTypeDef vfs_register(const vfs_node *n)
+{
+	uint32_t pm;
+	StatusTypeDef ret = SYS_OK;
+	if(n == NULL || n->name == NULL || n->ops == NULL) return SYS_ERROR;
+	pm = __irq_save();
+	if(vfs_node_count == VFS_MAX_NODES || vfs_lookup(n->name) != NULL)
+		ret = SYS_ERROR;
+	else
+		vfs_nodes[vfs_node_count++] = n;
+	__irq_restore(pm);
+	return ret;
+}
+
+const vfs_node *vfs_lookup(const char *path)
+{
+	if(path == NULL) return NULL;
+	for(uint32_t i = 0; i < vfs_node_count; i++)
+		if(vfs_name_eq(vfs_nodes[i]->name, path)) return vfs_nodes[i];
+	return NULL;
+}
+
+static int32_t vfs_node_index(const vfs_node *n)
+{
+	for(uint32_t i = 0; i < vfs_node_count; i++)
+		if(vfs_nodes[i] == n) return (int32_t)i;
+	return -1;
+}
+
+const vfs_node *vfs_lookup_dev(void *dev)
+{
+	for(uint32_t i = 0; i < vfs_node_count; i++)
+		if(vfs_nodes[i]->dev == dev) return vfs_nodes[i];
+	return NULL;
+}
+
+StatusTypeDef vfs_own(const vfs_node *n)
+{
+	int32_t i;
+	StatusTypeDef ret = SYS_OK;
+	uint32_t pm;
+	if(!(n->flags & VFS_NODE_TTY)) return SYS_OK;
+	i = vfs_node_index(n);
+	if(i < 0) return SYS_ERROR;
+	pm = __irq_save();
+	if(!(vfs_owned & (1UL << i)))
+	{
+		vfs_readers[i] = task_self();
+		vfs_owned |= 1UL << i;
+	}else if(vfs_readers[i] != task_self())
+		ret = SYS_BUSY;
+	__irq_restore(pm);
+	return ret;
+}
+
+/* frees node i of task, the pollers waiting for it scan again; 1 when it was task's */
+static uint8_t vfs_disown(uint32_t i, TCB_TypeDef *task)
+{
+	uint32_t pm = __irq_save();
+	if(!(vfs_owned & (1UL << i)) || vfs_readers[i] != task)
+	{
+		__irq_restore(pm);
+		return 0;
+	}
+	vfs_owned &= ~(1UL << i);
+	__irq_restore(pm);
+	vfs_notify(vfs_nodes[i]->dev, POLLIN);
+	return 1;
+}
+
+void vfs_release(const vfs_node *n)
+{
+	int32_t i = vfs_node_index(n);
+	if(i >= 0) vfs_disown((uint32_t)i, task_self());
+}
+
+/* a task let go of tty0: the console reads what came in meanwhile */
+static void vfs_task_release(uint32_t i, TCB_TypeDef *task)
+{
+	if(vfs_disown(i, task) && vfs_nodes[i] == &vfs_tty0) kconsole_rx_notify();
+}
+
+static vfs_file **vfs_table(void)
+{
+	TCB_TypeDef *t = task_self();
+	return t != NULL ? t->files : vfs_boot_files;
+}
+
+static vfs_file *vfs_get(int32_t fd)
+{
+	if(fd < 0 || (uint32_t)fd >= TASK_FILES) return NULL;
+	return vfs_table()[fd];
+}
+
+/* drops one reference; a pool file is free again at 0 */
+static void vfs_put(vfs_file *f)
+{
+	uint32_t pm = __irq_save();
+	f->refs--;
+	__irq_restore(pm);
+}
+
+/* f in the lowest free slot of the table, with a reference taken for it */
+static int32_t vfs_install(vfs_file **tab, vfs_file *f)
+{
+	int32_t fd = -EMFILE;
+	uint32_t pm = __irq_save();
+	for(uint32_t i = 0; i < TASK_FILES; i++)
+	{
+		if(tab[i] == NULL)
+		{
+			tab[i] = f;
+			f->refs++;
+			fd = (int32_t)i;
+			break;
+		}
+	}
+	__irq_restore(pm);
+	return fd;
+}
+
+int32_t vfs_open(const char *path, uint32_t flags)
+{
+	const vfs_node *n;
+	vfs_file *f = NULL;
+	int32_t fd;
+	uint32_t pm;
+	if(path == NULL) return -EFAULT;
+	if((flags & ~(uint32_t)O_ACCMODE) || (flags & O_ACCMODE) == O_ACCMODE) return -EINVAL;
+	n = vfs_lookup(path);
+	if(n == NULL) return -ENOENT;
+	pm = __irq_save();
+	for(uint32_t i = 0; i < VFS_MAX_FILES; i++)
+	{
+		if(vfs_pool[i].refs == 0)
+		{
+			f = &vfs_pool[i];
+			f->node = n;
+			f->off = 0;
+			f->flags = (uint16_t)flags;
+			f->refs = 1; // held until installed
+			break;
+		}
+	}
+	__irq_restore(pm);
+	if(f == NULL)
+	{
+		vfs_enfile++;
+		return -ENFILE;
+	}
+	fd = vfs_install(vfs_table(), f);
+	vfs_put(f);
+	if(fd < 0) vfs_emfile++;
+	else vfs_opens++;
+	return fd;
+}
+
+int32_t vfs_close(int32_t fd)
+{
+	vfs_file **tab = vfs_table();
+	vfs_file *f = NULL;
+	uint32_t pm;
+	if(fd < 0 || (uint32_t)fd >= TASK_FILES) return -EBADF;
+	pm = __irq_save();
+	f = tab[fd];
+	tab[fd] = NULL;
+	__irq_restore(pm);
+	if(f == NULL) return -EBADF;
+	vfs_put(f);
+	return 0;
+}
+
+/* in the vfs task: run the op and wake the task that waits in the svc */
+static void vfs_handoff_run(void *arg)
+{
+	vfs_handoff *h = (vfs_handoff*)arg;
+	uint32_t pm;
+	int32_t ret = h->write ? h->node->ops->write(h->node, h->buf, h->len, h->off)
+		: h->node->ops->read(h->node, h->buf, h->len, h->off);
+	pm = __irq_save();
+	h->ret = ret;
+	h->done = 1;
+	ksched_ready(h->task);
+	__irq_restore(pm);
+}
+
+/*
+* A node's read or write. Inside the svc a VFS_NODE_TASK node goes to the
+* vfs task: the caller blocks and the restarted svc collects the result.
+*/
+static int32_t vfs_node_rw(const vfs_node *n, void *buf, uint32_t len, uint32_t off, uint8_t write)
+{
+	TCB_TypeDef *self = task_self();
+	vfs_handoff *h = NULL, *slot = NULL;
+	uint32_t pm;
+	int32_t ret;
+	if(!(n->flags & VFS_NODE_TASK) || !__in_handler() || self == NULL)
+		return write ? n->ops->write(n, buf, len, off) : n->ops->read(n, buf, len, off);
+	if(vfs_task_tcb == NULL)
+		vfs_task_tcb = kworkq_start(&vfs_wq, KWORK_PRIO);
+	if(vfs_task_tcb == NULL) // no task slot left, the node tries without waiting
+		return write ? n->ops->write(n, buf, len, off) : n->ops->read(n, buf, len, off);
+	pm = __irq_save();
+	for(uint32_t i = 0; i < MAX_TASKS; i++)
+	{
+		if(vfs_handoffs[i].task == self)
+		{
+			h = &vfs_handoffs[i];
+			break;
+		}
+		if(slot == NULL && vfs_handoffs[i].task == NULL) slot = &vfs_handoffs[i];
+	}
+	if(h != NULL && h->done)
+	{
+		ret = h->ret;
+		h->task = NULL;
+		__irq_restore(pm);
+		return ret;
+	}
+	if(h == NULL)
+	{
+		h = slot; // one per task, a task waits for one at a time
+		h->task = self;
+		h->node = n;
+		h->buf = buf;
+		h->len = len;
+		h->off = off;
+		h->write = write;
+		h->done = 0;
+		kwork_queue(&vfs_wq, &h->work);
+		vfs_handoff_count++;
+	}
+	ksched_block_timeout(TASK_BLOCKED_STATE, 0);
+	__irq_restore(pm);
+	return -(int32_t)SYSCALL_RESTART; // blocked when the svc returns
+}
+
+static __inline uint8_t vfs_can_read(const vfs_file *f)
+{
+	return (f->flags & O_ACCMODE) != O_WRONLY;
+}
+
+static __inline uint8_t vfs_can_write(const vfs_file *f)
+{
+	return (f->flags & O_ACCMODE) != O_RDONLY;
+}
+
+int32_t vfs_read(int32_t fd, void *buf, uint32_t len)
+{
+	vfs_file *f = vfs_get(fd);
+	int32_t ret;
+	if(f == NULL || !vfs_can_read(f)) return -EBADF;
+	if(buf == NULL) return -EFAULT;
+	if(vfs_own(f->node) != SYS_OK) return -EAGAIN; // another reader has it
+	ret = vfs_node_rw(f->node, buf, len, f->off, 0);
+	if(ret > 0 && f->node->size != 0) f->off += (uint32_t)ret;
+	return ret;
+}
+
+int32_t vfs_write(int32_t fd, const void *buf, uint32_t len)
+{
+	vfs_file *f = vfs_get(fd);
+	int32_t ret;
+	if(f == NULL || !vfs_can_write(f)) return -EBADF;
+	if(buf == NULL) return -EFAULT;
+	ret = vfs_node_rw(f->node, (void*)buf, len, f->off, 1);
+	if(ret > 0 && f->node->size != 0) f->off += (uint32_t)ret;
+	return ret;
+}
+
+int32_t vfs_pread(int32_t fd, void *buf, uint32_t len, uint32_t off)
+{
+	vfs_file *f = vfs_get(fd);
+	if(f == NULL || !vfs_can_read(f)) return -EBADF;
+	if(f->node->size == 0) return -ESPIPE;
+	if(buf == NULL) return -EFAULT;
+	return vfs_node_rw(f->node, buf, len, off, 0);
+}
+
+int32_t vfs_pwrite(int32_t fd, const void *buf, uint32_t len, uint32_t off)
+{
+	vfs_file *f = vfs_get(fd);
+	if(f == NULL || !vfs_can_write(f)) return -EBADF;
+	if(f->node->size == 0) return -ESPIPE;
+	if(buf == NULL) return -EFAULT;
+	return vfs_node_rw(f->node, (void*)buf, len, off, 1);
+}
+
+/* anywhere from 0 to the size, reads there give 0 and writes -ENOSPC */
+int32_t vfs_lseek(int32_t fd, int32_t off, uint32_t whence)
+{
+	vfs_file *f = vfs_get(fd);
+	int32_t base;
+	if(f == NULL) return -EBADF;
+	if(f->node->size == 0) return -ESPIPE;
+	if(whence == SEEK_SET) base = 0;
+	else if(whence == SEEK_CUR) base = (int32_t)f->off;
+	else if(whence == SEEK_END) base = (int32_t)f->node->size;
+	else return -EINVAL;
+	if(off < -base || off > (int32_t)f->node->size - base) return -EINVAL;
+	f->off = (uint32_t)(base + off);
+	return (int32_t)f->off;
+}
+
+int32_t vfs_ioctl(int32_t fd, uint32_t req, uintptr_t arg)
+{
+	vfs_file *f = vfs_get(fd);
+	if(f == NULL) return -EBADF;
+	if(req == IOC_RELEASE)
+	{
+		int32_t i = vfs_node_index(f->node);
+		if(i >= 0) vfs_task_release((uint32_t)i, task_self());
+		return 0;
+	}
+	if(req == IOC_SIZE || (req == IOC_NREAD && f->node->size != 0))
+	{
+		if(arg == 0) return -EFAULT;
+		*(uint32_t*)arg = req == IOC_SIZE ? f->node->size : f->node->size - f->off;
+		return 0;
+	}
+	if(f->node->ops->ioctl == NULL) return -EIOCTL;
+	return f->node->ops->ioctl(f->node, req, arg);
+}
+
+int32_t vfs_dup(int32_t fd)
+{
+	vfs_file *f = vfs_get(fd);
+	if(f == NULL) return -EBADF;
+	return vfs_install(vfs_table(), f);
+}
+
+int32_t vfs_dup2(int32_t fd, int32_t fd2)
+{
+	vfs_file **tab = vfs_table();
+	vfs_file *f = vfs_get(fd), *old;
+	uint32_t pm;
+	if(f == NULL || fd2 < 0 || (uint32_t)fd2 >= TASK_FILES) return -EBADF;
+	if(fd2 == fd) return fd2;
+	pm = __irq_save();
+	old = tab[fd2];
+	tab[fd2] = f;
+	f->refs++;
+	__irq_restore(pm);
+	if(old != NULL) vfs_put(old);
+	return fd2;
+}
+
+/* ---- readiness ---- */
+
+static uint32_t vfs_node_bit(const vfs_node *n)
+{
+	int32_t i = vfs_node_index(n);
+	return i < 0 ? 0U : 1UL << i;
+}
+
+/* what a poller waits for: entries ready now, in and out collect the nodes to wait on */
+typedef int32_t (*vfs_scan_fn)(void *arg, uint32_t *in, uint32_t *out);
+
+typedef struct vfs_pollset_t
+{
+	struct pollfd *fds;
+	uint32_t nfds;
+}vfs_pollset;
+
+typedef struct vfs_devwait_t
+{
+	void *dev;
+	uint32_t events;
+}vfs_devwait;
+
+/* revents of every entry */
+static int32_t vfs_poll_scan(void *arg, uint32_t *in, uint32_t *out)
+{
+	struct pollfd *fds = ((vfs_pollset*)arg)->fds;
+	uint32_t nfds = ((vfs_pollset*)arg)->nfds;
+	int32_t ready = 0;
+	*in = *out = 0;
+	for(uint32_t i = 0; i < nfds; i++)
+	{
+		vfs_file *f;
+		uint32_t ev, bit;
+		fds[i].revents = 0;
+		if(fds[i].fd < 0) continue;
+		f = vfs_get(fds[i].fd);
+		if(f == NULL)
+		{
+			fds[i].revents = POLLNVAL;
+			ready++;
+			continue;
+		}
+		ev = f->node->ops->poll != NULL ? f->node->ops->poll(f->node) : (POLLIN | POLLOUT);
+		ev &= (uint32_t)(uint16_t)fds[i].events;
+		if((fds[i].events & POLLIN) && vfs_own(f->node) != SYS_OK)
+			ev &= ~(uint32_t)POLLIN; // another reader has it, wait for its release
+		fds[i].revents = (int16_t)ev;
+		if(ev != 0) ready++;
+		bit = vfs_node_bit(f->node);
+		if(fds[i].events & POLLIN) *in |= bit;
+		if(fds[i].events & POLLOUT) *out |= bit;
+	}
+	return ready;
+}
+
+/* the task's poller: the one a restarted svc left, else a free one with a new deadline */
+static vfs_poller *vfs_poller_get(TCB_TypeDef *task, int32_t timeout_ms)
+{
+	vfs_poller *p = NULL;
+	uint32_t pm = __irq_save();
+	for(uint32_t i = 0; i < MAX_TASKS; i++)
+	{
+		if(vfs_pollers[i].task == task)
+		{
+			__irq_restore(pm);
+			return &vfs_pollers[i];
+		}
+		if(p == NULL && vfs_pollers[i].task == NULL) p = &vfs_pollers[i];
+	}
+	if(p != NULL)
+	{
+		p->task = task;
+		p->in = p->out = 0;
+		p->woken = 0;
+		p->forever = timeout_ms < 0;
+		p->deadline = getmsTick() + (uint32_t)(timeout_ms < 0 ? 0 : timeout_ms);
+		vfs_poll_waiting++;
+		vfs_polls++;
+	}
+	__irq_restore(pm);
+	return p;
+}
+
+static void vfs_poller_put(vfs_poller *p)
+{
+	uint32_t pm;
+	if(p == NULL) return;
+	pm = __irq_save();
+	p->task = NULL;
+	vfs_poll_waiting--;
+	__irq_restore(pm);
+}
+
+/* 1 when a node on dev has one of the events */
+static int32_t vfs_dev_scan(void *arg, uint32_t *in, uint32_t *out)
+{
+	vfs_devwait *w = (vfs_devwait*)arg;
+	uint32_t ev = 0;
+	*in = *out = 0;
+	for(uint32_t i = 0; i < vfs_node_count; i++)
+	{
+		const vfs_node *n = vfs_nodes[i];
+		if(n->dev != w->dev) continue;
+		ev |= (n->ops->poll != NULL ? n->ops->poll(n) : (POLLIN | POLLOUT)) & w->events;
+		if(w->events & POLLIN) *in |= 1UL << i;
+		if(w->events & POLLOUT) *out |= 1UL << i;
+	}
+	return ev != 0;
+}
+
+/* scan until something is ready or timeout_ms ran out, blocking the task in between */
+static int32_t vfs_wait_scan(vfs_scan_fn scan, void *arg, int32_t timeout_ms)
+{
+	TCB_TypeDef *self = task_self();
+	vfs_poller *p;
+	uint32_t in, out, pm, left;
+	int32_t n;
+	if(timeout_ms == 0 || self == NULL)
+		return scan(arg, &in, &out);
+	p = vfs_poller_get(self, timeout_ms);
+	if(p == NULL) return scan(arg, &in, &out); // cannot happen, one per task
+	for(;;)
+	{
+		pm = __irq_save();
+		p->in = p->out = 0xFFFFFFFFUL; // any notify during the scan is a reason to scan again
+		p->woken = 0;
+		__irq_restore(pm);
+		n = scan(arg, &in, &out);
+		left = p->deadline - getmsTick();
+		if(n != 0 || (!p->forever && (left == 0 || (int32_t)left < 0)))
+		{
+			vfs_poller_put(p);
+			return n;
+		}
+		pm = __irq_save();
+		p->in = in;
+		p->out = out;
+		if(!p->woken)
+		{
+			ksched_block_timeout(TASK_BLOCKED_STATE, p->forever ? 0U : left);
+			vfs_poll_sleeps++;
+		}
+		__irq_restore(pm);
+		if(__in_handler()) return -(int32_t)SYSCALL_RESTART; // blocked when the svc returns
+	}
+}
+
+int32_t vfs_poll(struct pollfd *fds, uint32_t nfds, int32_t timeout_ms)
+{
+	vfs_pollset set = { fds, nfds };
+	if(nfds > VFS_POLL_MAX) return -EINVAL;
+	if(fds == NULL && nfds != 0) return -EFAULT;
+	return vfs_wait_scan(vfs_poll_scan, &set, timeout_ms);
+}
+
+int32_t vfs_wait(void *dev, uint32_t events, int32_t timeout_ms)
+{
+	vfs_devwait w = { dev, events };
+	uint32_t in, out;
+	if(__in_handler()) return -EPERM;
+	vfs_dev_scan(&w, &in, &out);
+	if(in == 0 && out == 0) return -ENODEV;
+	return vfs_wait_scan(vfs_dev_scan, &w, timeout_ms);
+}
+
+int32_t vfs_select(uint32_t nfds, fd_set *rfds, fd_set *wfds, int32_t timeout_ms)
+{
+	struct pollfd pfd[TASK_FILES];
+	uint32_t r = rfds != NULL ? rfds->bits : 0U, w = wfds != NULL ? wfds->bits : 0U;
+	uint32_t n = 0, rr = 0, wr = 0;
+	int32_t ret, count = 0;
+	if(nfds > FD_SETSIZE) return -EINVAL;
+	if(nfds < FD_SETSIZE)
+	{
+		r &= (1UL << nfds) - 1U;
+		w &= (1UL << nfds) - 1U;
+	}
+	if((r | w) >> TASK_FILES) return -EBADF;
+	for(uint32_t fd = 0; fd < TASK_FILES; fd++)
+	{
+		int16_t ev = (int16_t)((((r >> fd) & 1U) ? POLLIN : 0) | (((w >> fd) & 1U) ? POLLOUT : 0));
+		if(ev == 0) continue;
+		pfd[n].fd = (int32_t)fd;
+		pfd[n].events = ev;
+		n++;
+	}
+	ret = vfs_poll(pfd, n, timeout_ms);
+	if(ret < 0) return ret; // the sets stay as they are for a restart
+	for(uint32_t i = 0; i < n; i++)
+	{
+		if(pfd[i].revents & POLLNVAL) return -EBADF;
+		if(pfd[i].revents & POLLIN) { rr |= 1UL << pfd[i].fd; count++; }
+		if(pfd[i].revents & POLLOUT) { wr |= 1UL << pfd[i].fd; count++; }
+	}
+	if(rfds != NULL) rfds->bits = rr;
+	if(wfds != NULL) wfds->bits = wr;
+	return count;
+}
+
+void vfs_notify(void *dev, uint32_t events)
+{
+	uint32_t bits = 0, pm;
+	if(vfs_poll_waiting == 0) return;
+	for(uint32_t i = 0; i < vfs_node_count; i++)
+		if(vfs_nodes[i]->dev == dev) bits |= 1UL << i;
+	if(bits == 0) return;
+	pm = __irq_save();
+	for(uint32_t i = 0; i < MAX_TASKS; i++)
+	{
+		vfs_poller *p = &vfs_pollers[i];
+		if(p->task == NULL) continue;
+		if(((events & POLLIN) && (p->in & bits)) || ((events & POLLOUT) && (p->out & bits)))
+		{
+			p->woken = 1;
+			ksched_ready(p->task);
+			vfs_poll_wakeups++;
+		}
+	}
+	__irq_restore(pm);
+}
+
+/* ---- task tables ---- */
+
+static void vfs_table_close(vfs_file **tab)
+{
+	for(uint32_t i = 0; i < TASK_FILES; i++)
+	{
+		vfs_file *f;
+		uint32_t pm = __irq_save();
+		f = tab[i];
+		tab[i] = NULL;
+		__irq_restore(pm);
+		if(f != NULL) vfs_put(f);
+	}
+}
+
+static void vfs_table_init(vfs_file **tab)
+{
+	vfs_table_close(tab);
+	vfs_install(tab, &vfs_console_in);
+	vfs_install(tab, &vfs_console_out);
+	vfs_install(tab, &vfs_console_out);
+}
+
+void vfs_task_init(TCB_TypeDef *task)
+{
+	vfs_table_init(task->files);
+}
+
+void vfs_task_exit(TCB_TypeDef *task)
+{
+	for(uint32_t i = 0; i < vfs_node_count; i++)
+		vfs_task_release(i, task);
+	for(uint32_t i = 0; i < MAX_TASKS; i++)
+		if(vfs_pollers[i].task == task) vfs_poller_put(&vfs_pollers[i]);
+	vfs_table_close(task->files);
+}
+
+static void cmd_vfs(char *args)
+{
+	(void)args;
+	kprintf("node,size,flags\n");
+	for(uint32_t i = 0; i < vfs_node_count; i++)
+		kprintf("%s,%d,%x\n", vfs_nodes[i]->name, vfs_nodes[i]->size, vfs_nodes[i]->flags);
+	kprintf("file,node,mode,off,refs\n");
+	for(uint32_t i = 0; i < VFS_MAX_FILES; i++)
+	{
+		vfs_file *f = &vfs_pool[i];
+		if(f->refs != 0)
+			kprintf("%d,%s,%d,%d,%d\n", i, f->node->name, f->flags & O_ACCMODE, f->off, f->refs);
+	}
+	kprintf("opens %d, emfile %d, enfile %d\n", vfs_opens, vfs_emfile, vfs_enfile);
+	kprintf("polls %d, sleeps %d, wakeups %d, polling %d\n", vfs_polls, vfs_poll_sleeps, vfs_poll_wakeups,
+		vfs_poll_waiting);
+	kprintf("task handoffs %d\n", vfs_handoff_count);
+}
+
+void vfs_sys_init(void)
+{
+	vfs_register(&vfs_tty0);
+	vfs_register(&vfs_tty1);
+	vfs_register(&vfs_spi1);
+	vfs_register(&vfs_ram0);
+	vfs_register(&vfs_fifo0);
+	vfs_register(&vfs_fifo1);
+	vfs_table_init(vfs_boot_files);
+	kworkq_init(&vfs_wq, "vfs");
+	for(uint32_t i = 0; i < MAX_TASKS; i++)
+		kwork_init(&vfs_handoffs[i].work, vfs_handoff_run, &vfs_handoffs[i]);
+	kconsole_register("vfs", cmd_vfs, "device nodes and open files: vfs");
+}
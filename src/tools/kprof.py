@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2022
+# Computer Science and Engineering, University of Dhaka
+# Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+#
+# Symbolizes the PC sampling stream produced by kern/lib/kern/kprof.c
+# (USART6, "prof start") into a flat profile and a call-edge profile.
+#
+#   kprof.py /dev/ttyUSB1 build/final.elf --seconds 10
+#   kprof.py capture.bin build/final.elf --top 30
+#
+# kstream frame 'P': drop16 {pc32 lr32}*n   (see kprof.h)
+
+import argparse
+import bisect
+import collections
+import struct
+import subprocess
+import sys
+
+from kstream import open_stream, read_frames
+
+TYPE_SAMPLES = ord("P")
+
+
+class Symbols:
+    def __init__(self, elf, nm):
+        out = subprocess.run([nm, "-n", "--defined-only", elf], check=True,
+                             capture_output=True, text=True).stdout
+        self.addr, self.name = [], []
+        for line in out.splitlines():
+            parts = line.split()
+            if len(parts) != 3 or parts[1] not in "TtWw":
+                continue
+            self.addr.append(int(parts[0], 16) & ~1)
+            self.name.append(parts[2])
+
+    def lookup(self, pc):
+        i = bisect.bisect_right(self.addr, pc & ~1) - 1
+        return self.name[i] if i >= 0 else "0x%08x" % pc
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__)
+    ap.add_argument("stream", help="serial device or captured file")
+    ap.add_argument("elf", help="final.elf the firmware was built as")
+    ap.add_argument("--nm", default="arm-none-eabi-nm")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--seconds", type=float, default=0,
+                    help="capture time for a serial device (0: until EOF)")
+    ap.add_argument("--top", type=int, default=25)
+    args = ap.parse_args()
+
+    syms = Symbols(args.elf, args.nm)
+    flat = collections.Counter()
+    edges = collections.Counter()
+    total = dropped = 0
+    with open_stream(args.stream, args.baud) as f:
+        for ftype, n, payload in read_frames(f, args.seconds):
+            if ftype != TYPE_SAMPLES:
+                continue
+            dropped += struct.unpack_from("<H", payload)[0]
+            for k in range(n):
+                pc, lr = struct.unpack_from("<II", payload, 2 + 8 * k)
+                total += 1
+                callee = syms.lookup(pc)
+                flat[callee] += 1
+                if 0 < lr < 0xFFFFFF00:     # EXC_RETURN is not a call site
+                    edges[(syms.lookup(lr), callee)] += 1
+
+    if total == 0:
+        print("no samples", file=sys.stderr)
+        return 1
+    print("# %d samples, %d dropped" % (total, dropped))
+    print("\n# flat profile\n%8s %7s  %s" % ("samples", "%", "function"))
+    for fn, n in flat.most_common(args.top):
+        print("%8d %6.2f%%  %s" % (n, 100.0 * n / total, fn))
+    print("\n# call edges (caller from stacked LR; approximate in non-leaf code)")
+    print("%8s %7s  %s" % ("samples", "%", "caller -> callee"))
+    for (caller, callee), n in edges.most_common(args.top):
+        print("%8d %6.2f%%  %s -> %s" % (n, 100.0 * n / total, caller, callee))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2022
+# Computer Science and Engineering, University of Dhaka
+# Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+#
+# Captures for the UART record/replay of kern/lib/kern/kreplay.c.
+#
+#   kreplay.py record /dev/ttyUSB1 -o field.cap --seconds 60   ("replay rec start")
+#   kreplay.py text lines.txt -o synth.cap --port 2 --baud 115200
+#   kreplay.py info field.cap
+#   kreplay.py c field.cap -o kreplay_capture.c                 (link into the firmware)
+#
+# .cap file: "DUOSCAP1" then {t_us32 port8 byte8} little endian records,
+# t_us from the start of the capture.
+# kstream frame 'U': {dt_us32 port8 byte8}*n, dt from the previous record.
+
+import argparse
+import struct
+import sys
+
+from kstream import open_stream, read_frames
+
+MAGIC = b"DUOSCAP1"
+TYPE_BYTES = ord("U")
+
+
+def write_cap(path, records):
+    with open(path, "wb") as f:
+        f.write(MAGIC)
+        for t_us, port, byte in records:
+            f.write(struct.pack("<IBB", t_us & 0xFFFFFFFF, port, byte))
+
+
+def read_cap(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:8] != MAGIC:
+        raise SystemExit("%s: not a DUOSCAP1 file" % path)
+    return [struct.unpack_from("<IBB", data, off) for off in range(8, len(data) - 5, 6)]
+
+
+def cmd_record(args):
+    records, t = [], 0
+    with open_stream(args.stream, args.baud) as f:
+        for ftype, n, payload in read_frames(f, args.seconds):
+            if ftype != TYPE_BYTES:
+                continue
+            for k in range(n):
+                dt, port, byte = struct.unpack_from("<IBB", payload, 6 * k)
+                t += dt
+                records.append((t, port, byte))
+    write_cap(args.output, records)
+    print("%d bytes, %.3f s" % (len(records), t / 1e6), file=sys.stderr)
+
+
+def cmd_text(args):
+    # back to back bytes at the line rate: 10 bits per byte (8N1)
+    data = open(args.input, "rb").read()
+    byte_us = 10e6 / args.baud
+    write_cap(args.output, [(int(i * byte_us), args.port, b) for i, b in enumerate(data)])
+
+
+def cmd_info(args):
+    recs = read_cap(args.capture)
+    for port in (2, 6):
+        mine = [r for r in recs if r[1] == port]
+        if not mine:
+            continue
+        span = (mine[-1][0] - mine[0][0]) / 1e6
+        rate = len(mine) / span if span > 0 else 0
+        print("USART%d: %d bytes over %.3f s, %.0f bytes/s" % (port, len(mine), span, rate))
+
+
+def cmd_c(args):
+    recs = read_cap(args.capture)
+    out = ["/* generated by src/tools/kreplay.py from %s */" % args.capture,
+           "#include <kreplay.h>", "",
+           "const uint32_t kreplay_capture_len = %d;" % len(recs),
+           "const kreplay_cap kreplay_capture[%d] = {" % max(len(recs), 1)]
+    out += ["\t{ %d, %d, 0x%02x }," % r for r in recs]
+    out += ["};", ""]
+    with open(args.output, "w") as f:
+        f.write("\n".join(out))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__)
+    sub = ap.add_subparsers(dest="cmd", required=True)
+    p = sub.add_parser("record", help="kstream 'U' frames to a .cap file")
+    p.add_argument("stream", help="serial device or captured file")
+    p.add_argument("-o", "--output", required=True)
+    p.add_argument("--baud", type=int, default=115200)
+    p.add_argument("--seconds", type=float, default=0,
+                   help="capture time for a serial device (0: until EOF)")
+    p.set_defaults(fn=cmd_record)
+    p = sub.add_parser("text", help="file contents as back to back bytes")
+    p.add_argument("input")
+    p.add_argument("-o", "--output", required=True)
+    p.add_argument("--port", type=int, choices=(2, 6), default=2)
+    p.add_argument("--baud", type=int, default=115200)
+    p.set_defaults(fn=cmd_text)
+    p = sub.add_parser("info", help="bytes and rate per port")
+    p.add_argument("capture")
+    p.set_defaults(fn=cmd_info)
+    p = sub.add_parser("c", help="C source defining kreplay_capture")
+    p.add_argument("capture")
+    p.add_argument("-o", "--output", required=True)
+    p.set_defaults(fn=cmd_c)
+    args = ap.parse_args()
+    return args.fn(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
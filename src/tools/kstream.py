@@ -0,0 +1,79 @@
+#
+# Copyright (c) 2022
+# Computer Science and Engineering, University of Dhaka
+# Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+#
+# Reader for the binary frames of kern/lib/kern/kstream.c:
+#   A5 5A type n payload xor      (xor over type, n and payload)
+# The payload length is not on the wire; each frame type gives it as a
+# function of n (see FRAME_LEN).
+
+import os
+import time
+
+SYNC = b"\xa5\x5a"
+
+# type -> payload length for n records
+FRAME_LEN = {
+    ord("P"): lambda n: 2 + 8 * n,      # kprof samples
+    ord("H"): lambda n: 12,             # ktrace header
+    ord("T"): lambda n: 8 * n,          # ktrace events
+    ord("U"): lambda n: 6 * n,          # kreplay recorded bytes
+}
+
+
+def open_stream(path, baud=115200):
+    f = open(path, "rb", buffering=0)
+    if os.isatty(f.fileno()):
+        import termios
+        attrs = termios.tcgetattr(f.fileno())
+        speed = getattr(termios, "B%d" % baud)
+        attrs[0] = 0                                  # iflag
+        attrs[1] = 0                                  # oflag
+        attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+        attrs[3] = 0                                  # lflag: raw
+        attrs[4] = attrs[5] = speed
+        attrs[6][termios.VMIN] = 0
+        attrs[6][termios.VTIME] = 1
+        termios.tcsetattr(f.fileno(), termios.TCSANOW, attrs)
+    return f
+
+
+def read_frames(f, seconds=0):
+    """Yields (type, n, payload); resynchronises on unknown types and bad xor."""
+    buf = bytearray()
+    tty = os.isatty(f.fileno())
+    deadline = time.time() + seconds if seconds else None
+    while True:
+        chunk = f.read(4096)
+        if not chunk:
+            if not tty or (deadline is not None and time.time() >= deadline):
+                break
+            continue
+        buf += chunk
+        while True:
+            i = buf.find(SYNC)
+            if i < 0:
+                del buf[:-1]
+                break
+            del buf[:i]
+            if len(buf) < 4:
+                break
+            ftype, n = buf[2], buf[3]
+            if ftype not in FRAME_LEN:
+                del buf[:2]
+                continue
+            size = 4 + FRAME_LEN[ftype](n) + 1
+            if len(buf) < size:
+                break
+            csum = 0
+            for b in buf[2:size - 1]:
+                csum ^= b
+            if csum != buf[size - 1]:
+                del buf[:2]
+                continue
+            payload = bytes(buf[4:size - 1])
+            del buf[:size]
+            yield ftype, n, payload
+        if deadline is not None and time.time() >= deadline:
+            break
@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2022
+# Computer Science and Engineering, University of Dhaka
+# Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+#
+# Decodes a "trace dump" capture from USART6 (kern/lib/kern/ktrace.c) into
+# Chrome trace event JSON, which chrome://tracing and ui.perfetto.dev load.
+#
+#   ktrace.py /dev/ttyUSB1 --seconds 5 -o trace.json
+#   ktrace.py capture.bin -o trace.json
+#
+# kstream frames: 'H' hz32 lost32 count32, then 'T' {ts32 type8 id8 arg16}*n
+
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+from kstream import open_stream, read_frames
+
+ISR_ENTER, ISR_EXIT, CTX_SWITCH, SYSCALL_ENTER, SYSCALL_EXIT, MARK, \
+    MARK_BEGIN, MARK_END = range(1, 9)
+
+TID_IRQ, TID_TASK, TID_SYSCALL, TID_MARK = 1, 2, 3, 4
+TRACKS = {TID_IRQ: "interrupts", TID_TASK: "tasks",
+          TID_SYSCALL: "syscalls", TID_MARK: "markers"}
+
+# exception number (IRQn + 16) -> name
+EXCEPTIONS = {11: "SVCall", 14: "PendSV", 15: "SysTick", 44: "TIM2",
+              51: "SPI1", 53: "USART1", 54: "USART2", 55: "USART3",
+              66: "TIM5", 87: "USART6"}
+
+SYSCALL_DEF = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                           "..", "kern", "include", "kern", "syscall_def.h")
+
+
+def syscall_names(path):
+    names = {}
+    try:
+        with open(path) as f:
+            for m in re.finditer(r"#define\s+SYS_(\w+)\s+(\d+)", f.read()):
+                names[int(m.group(2))] = m.group(1)
+    except OSError:
+        pass
+    return names
+
+
+def decode(frames, sysnames):
+    hz, lost, events = 180000000, 0, []
+    for ftype, n, payload in frames:
+        if ftype == ord("H"):
+            hz, lost, _ = struct.unpack_from("<III", payload)
+            events = []                     # a new dump starts
+        elif ftype == ord("T"):
+            for k in range(n):
+                events.append(struct.unpack_from("<IBBH", payload, 8 * k))
+
+    out = [{"ph": "M", "pid": 0, "name": "process_name", "args": {"name": "DUOS"}}]
+    for tid, name in TRACKS.items():
+        out.append({"ph": "M", "pid": 0, "tid": tid, "name": "thread_name",
+                    "args": {"name": name}})
+    depth = {tid: 0 for tid in TRACKS}
+    cycles, prev, task = 0, None, None
+
+    def slice_begin(tid, name, ts, args=None):
+        depth[tid] += 1
+        e = {"ph": "B", "pid": 0, "tid": tid, "name": name, "ts": ts}
+        if args:
+            e["args"] = args
+        out.append(e)
+
+    def slice_end(tid, ts, args=None):
+        if depth[tid] == 0:                 # begin was overwritten in the ring
+            return
+        depth[tid] -= 1
+        e = {"ph": "E", "pid": 0, "tid": tid, "ts": ts}
+        if args:
+            e["args"] = args
+        out.append(e)
+
+    for raw, etype, eid, arg in events:
+        if prev is not None:
+            delta = (raw - prev) & 0xFFFFFFFF
+            if delta >= 0x80000000:         # recorded slightly out of order
+                delta -= 0x100000000
+            cycles += delta
+        prev = raw
+        ts = cycles * 1e6 / hz
+        if etype == ISR_ENTER:
+            slice_begin(TID_IRQ, EXCEPTIONS.get(eid, "IRQ%d" % (eid - 16)), ts)
+        elif etype == ISR_EXIT:
+            slice_end(TID_IRQ, ts)
+        elif etype == CTX_SWITCH:
+            # only the next task is recorded, the previous one ran since
+            # the last switch (None before the first in the capture)
+            if task is not None:
+                slice_end(TID_TASK, ts)
+            slice_begin(TID_TASK, "task %d" % arg, ts, {"from": task})
+            task = arg
+        elif etype == SYSCALL_ENTER:
+            slice_begin(TID_SYSCALL, sysnames.get(eid, "syscall %d" % eid), ts)
+        elif etype == SYSCALL_EXIT:
+            slice_end(TID_SYSCALL, ts, {"ret": arg})
+        elif etype == MARK:
+            out.append({"ph": "i", "pid": 0, "tid": TID_MARK, "s": "t",
+                        "name": "mark %d" % eid, "ts": ts, "args": {"value": arg}})
+        elif etype == MARK_BEGIN:
+            slice_begin(TID_MARK, "mark %d" % eid, ts)
+        elif etype == MARK_END:
+            slice_end(TID_MARK, ts)
+    return out, len(events), lost
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__)
+    ap.add_argument("stream", help="serial device or captured file")
+    ap.add_argument("-o", "--output", default="-")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--seconds", type=float, default=0,
+                    help="capture time for a serial device (0: until EOF)")
+    ap.add_argument("--syscalls", default=SYSCALL_DEF,
+                    help="syscall_def.h used to name syscall numbers")
+    args = ap.parse_args()
+
+    with open_stream(args.stream, args.baud) as f:
+        out, count, lost = decode(read_frames(f, args.seconds),
+                                  syscall_names(args.syscalls))
+    doc = json.dumps({"traceEvents": out, "displayTimeUnit": "ns"})
+    if args.output == "-":
+        print(doc)
+    else:
+        with open(args.output, "w") as f:
+            f.write(doc)
+    print("%d events decoded, %d overwritten before the dump" % (count, lost),
+          file=sys.stderr)
+    return 0 if count else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#ifndef __STDIO_H
+#define __STDIO_H
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <kunistd.h>
+/*
+* Buffered streams over SYS_read and SYS_write. Output collects in the
+* stream's buffer and leaves in one write when the buffer is full (_IOFBF),
+* also at every newline (_IOLBF), or at the end of each call (_IONBF: a
+* printf still goes out in one write); fflush sends what is buffered.
+* stdout is line buffered, stderr unbuffered, stdin fully buffered.
+*
+* SYS_read does not wait, so a read that finds nothing flushes stdout and
+* blocks in poll(POLLIN) until the descriptor has input, then asks again.
+*
+* A stream has no lock: each stream is written by one task. A task that
+* logs a lot gets its own, e.g.
+*   static char logbuf[256];
+*   static FILE log = FILE_INIT(STDOUT_FILENO, logbuf, sizeof(logbuf), _IOFBF);
+* snprintf/sscanf run the same code on a stream over memory (fd -1).
+*/
+#define EOF             (-1)
+#define BUFSIZ          128
+#define _IOFBF          0
+#define _IOLBF          1
+#define _IONBF          2
+
+/* FILE.flags */
+#define __SRD           0x01U   /* buf holds input */
+#define __SWR           0x02U   /* buf holds output */
+#define __SEOF          0x04U
+#define __SERR          0x08U
+
+typedef struct __FILE_t
+{
+	int32_t fd;                 /* -1: memory, nothing is read or written */
+	uint8_t mode;               /* _IOFBF, _IOLBF, _IONBF */
+	uint8_t flags;
+	int16_t unget;              /* ungetc, -1 when empty */
+	uint8_t *buf;
+	uint32_t size;
+	uint32_t pos;               /* output: bytes buffered, input: next byte */
+	uint32_t len;               /* input: bytes in buf */
+	uint8_t ch;                 /* the buffer of an _IONBF stream */
+}FILE;
+
+#define FILE_INIT(fd, buf, size, mode) { (fd), (mode), 0, -1, (uint8_t*)(buf), (size), 0, 0, 0 }
+
+extern FILE __sF[3];
+#define stdin           (&__sF[0])
+#define stdout          (&__sF[1])
+#define stderr          (&__sF[2])
+
+/* buf NULL keeps the current buffer; before the first I/O on the stream */
+int setvbuf(FILE *f, char *buf, int mode, size_t size);
+int fflush(FILE *f);
+int ferror(FILE *f);
+int feof(FILE *f);
+void clearerr(FILE *f);
+
+int fputc(int c, FILE *f);
+int fputs(const char *s, FILE *f);
+size_t fwrite(const void *p, size_t size, size_t n, FILE *f);
+int putchar(int c);
+int puts(const char *s);
+#define putc(c, f)      fputc(c, f)
+
+int fgetc(FILE *f);
+int ungetc(int c, FILE *f);
+char *fgets(char *s, int n, FILE *f);
+size_t fread(void *p, size_t size, size_t n, FILE *f);
+int getchar(void);
+#define getc(f)         fgetc(f)
+
+/*
+* %d %i %u %x %X %o %c %s %p %f %%, flags - + space 0 #, width and
+* precision (also *), length hh h l ll z.
+*/
+int printf(const char *fmt, ...);
+int fprintf(FILE *f, const char *fmt, ...);
+int vfprintf(FILE *f, const char *fmt, va_list ap);
+int snprintf(char *s, size_t n, const char *fmt, ...);
+int vsnprintf(char *s, size_t n, const char *fmt, va_list ap);
+
+/* %d %i %u %x %o %c %s %n %%, width, * to skip, length hh h l ll */
+int scanf(const char *fmt, ...);
+int fscanf(FILE *f, const char *fmt, ...);
+int vfscanf(FILE *f, const char *fmt, va_list ap);
+int sscanf(const char *s, const char *fmt, ...);
+#endif
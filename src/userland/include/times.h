@@ -30,5 +30,28 @@
  
 #ifndef __TIMES_H
 #define __TIMES_H
-/* Define times function prototypes here */
+#include <stdint.h>
+/*
+* Time without a syscall: everything is read from the kernel data page
+* (kdata.h) with plain loads.
+*/
+typedef struct walltime_t
+{
+	uint16_t year;
+	uint8_t month;
+	uint8_t day;
+	uint8_t weekday;    /* 1 Monday .. 7 Sunday, as the RTC counts */
+	uint8_t hour;
+	uint8_t min;
+	uint8_t sec;
+}walltime;
+
+/* seconds since boot, sec/nsec filled when not NULL; the same as SYS___time */
+uint32_t __time(uint32_t *sec, uint32_t *nsec);
+/* SysTick periods since boot */
+uint32_t get_ticks(void);
+/* microseconds since boot */
+uint64_t get_time_us(void);
+/* RTC date and time, -1 while the RTC is not running */
+int32_t get_walltime(walltime *wt);
 #endif
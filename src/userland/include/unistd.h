@@ -30,6 +30,27 @@
  
 #ifndef __UNISTD_H
 #define __UNISTD_H
+#include <stdint.h>
+#include <kunistd.h>
 /* Basic input and output function */
 
+/* id of the calling task, read from the kernel data page */
+uint32_t getpid(void);
+/* SYS_read: what the node has, -1 with errno EAGAIN from a stream with nothing */
+int32_t read(int32_t fd, void *buf, uint32_t len);
+/* SYS_write: len, or -1 with the errno */
+int32_t write(int32_t fd, const void *buf, uint32_t len);
+/* at off of a seekable node, the file offset stays */
+int32_t pread(int32_t fd, void *buf, uint32_t len, uint32_t off);
+int32_t pwrite(int32_t fd, const void *buf, uint32_t len, uint32_t off);
+/* SEEK_SET, SEEK_CUR or SEEK_END (fcntl.h); the new offset */
+int32_t lseek(int32_t fd, int32_t off, uint32_t whence);
+int32_t close(int32_t fd);
+/* a second descriptor on the file, offset shared */
+int32_t dup(int32_t fd);
+int32_t dup2(int32_t fd, int32_t fd2);
+/* IOC_NREAD, IOC_SIZE (fcntl.h) or a node's own request */
+int32_t ioctl(int32_t fd, uint32_t req, void *arg);
+/* SYS_nanosleep: the calling task sleeps at least ms milliseconds */
+int32_t msleep(uint32_t ms);
 #endif
@@ -0,0 +1,797 @@
+/*
+ * Copyright (c) 2022 
+ * Computer Science and Engineering, University of Dhaka
+ * Credit: CSE Batch 25 (starter) and Prof. Mosaddek Tushar
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the University nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE UNIVERSITY AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE UNIVERSITY OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+ 
+#include <stdio.h>
+#include <unistd.h>
+#include <poll.h>
+#include <syscall.h>
+#include <errno.h>
+#include <kmath.h>
+
+static uint8_t stdin_buf[BUFSIZ / 2];
+static uint8_t stdout_buf[BUFSIZ];
+
+FILE __sF[3] = {
+	FILE_INIT(STDIN_FILENO, stdin_buf, sizeof(stdin_buf), _IOFBF),
+	FILE_INIT(STDOUT_FILENO, stdout_buf, sizeof(stdout_buf), _IOLBF),
+	FILE_INIT(STDERR_FILENO, &__sF[2].ch, 1, _IONBF),
+};
+
+static uint32_t __slen(const char *s)
+{
+	const char *p = s;
+	while(*p) p++;
+	return (uint32_t)(p - s);
+}
+
+/* a stream declared without a buffer writes and reads through ch */
+static void __setup(FILE *f, uint8_t dir)
+{
+	if(f->buf == NULL || f->size == 0)
+	{
+		f->buf = &f->ch;
+		f->size = 1;
+	}
+	f->flags = (uint8_t)((f->flags & ~(__SRD | __SWR)) | dir);
+	f->pos = f->len = 0;
+	f->unget = -1;
+}
+
+static int __write_all(FILE *f, const uint8_t *p, uint32_t len)
+{
+	while(len > 0)
+	{
+		int32_t n = write(f->fd, p, len);
+		if(n <= 0)
+		{
+			f->flags |= __SERR;
+			return EOF;
+		}
+		p += n;
+		len -= (uint32_t)n;
+	}
+	return 0;
+}
+
+/* the buffered output in one write; a memory stream keeps it */
+static int __flush(FILE *f)
+{
+	uint32_t len = f->pos;
+	if(!(f->flags & __SWR) || f->fd < 0) return 0;
+	f->pos = 0;
+	return __write_all(f, f->buf, len);
+}
+
+/* switching from input to output drops what was read ahead */
+static __inline void __wrsetup(FILE *f)
+{
+	if(!(f->flags & __SWR)) __setup(f, __SWR);
+}
+
+static __inline void __rdsetup(FILE *f)
+{
+	if(!(f->flags & __SRD))
+	{
+		__flush(f);
+		__setup(f, __SRD);
+	}
+}
+
+int setvbuf(FILE *f, char *buf, int mode, size_t size)
+{
+	if(mode != _IOFBF && mode != _IOLBF && mode != _IONBF) return EOF;
+	if(__flush(f) == EOF) return EOF;
+	if(mode == _IONBF)
+	{
+		f->buf = &f->ch;
+		f->size = 1;
+	}else if(buf != NULL && size != 0)
+	{
+		f->buf = (uint8_t*)buf;
+		f->size = (uint32_t)size;
+	}else if(f->buf == &f->ch)
+	{
+		return EOF; // nothing to buffer in
+	}
+	f->mode = (uint8_t)mode;
+	f->flags &= ~(__SRD | __SWR);
+	return 0;
+}
+
+int fflush(FILE *f)
+{
+	if(f == NULL)
+		return (__flush(stdout) | __flush(stderr)) != 0 ? EOF : 0;
+	return __flush(f);
+}
+
+int ferror(FILE *f) { return (f->flags & __SERR) != 0; }
+int feof(FILE *f) { return (f->flags & __SEOF) != 0; }
+void clearerr(FILE *f) { f->flags &= ~(__SERR | __SEOF); }
+
+int fputc(int c, FILE *f)
+{
+	__wrsetup(f);
+	if(f->pos == f->size)
+	{
+		if(f->fd < 0) return (uint8_t)c; // memory stream full: cut, not an error
+		if(__flush(f) == EOF) return EOF;
+	}
+	f->buf[f->pos++] = (uint8_t)c;
+	if(f->mode == _IONBF || (f->mode == _IOLBF && c == '\n'))
+	{
+		if(__flush(f) == EOF) return EOF;
+	}
+	return (uint8_t)c;
+}
+
+size_t fwrite(const void *p, size_t size, size_t n, FILE *f)
+{
+	const uint8_t *s = (const uint8_t*)p;
+	uint32_t total = (uint32_t)(size * n), nl = 0;
+	if(total == 0) return 0;
+	__wrsetup(f);
+	if(f->fd >= 0 && (f->mode == _IONBF || total >= f->size))
+	{
+		/* would not fit: what is buffered, then straight from the caller */
+		if(__flush(f) == EOF || __write_all(f, s, total) == EOF) return 0;
+		return n;
+	}
+	for(uint32_t i = 0; i < total; i++)
+	{
+		if(f->pos == f->size)
+		{
+			if(f->fd < 0) break;
+			if(__flush(f) == EOF) return i / size;
+		}
+		f->buf[f->pos++] = s[i];
+		nl |= s[i] == '\n';
+	}
+	if(nl && f->mode == _IOLBF && __flush(f) == EOF) return 0;
+	return n;
+}
+
+int fputs(const char *s, FILE *f)
+{
+	uint32_t len = __slen(s);
+	if(len == 0) return 0;
+	return fwrite(s, 1, len, f) == len ? (int)len : EOF;
+}
+
+int putchar(int c)
+{
+	return fputc(c, stdout);
+}
+
+int puts(const char *s)
+{
+	if(fputs(s, stdout) == EOF) return EOF;
+	return fputc('\n', stdout) == EOF ? EOF : 1;
+}
+
+/* refills the input buffer; waits while the device has nothing yet */
+static int __fill(FILE *f)
+{
+	if(f->fd < 0)
+	{
+		f->flags |= __SEOF;
+		return EOF;
+	}
+	for(;;)
+	{
+		int32_t n = read(f->fd, f->buf, f->size);
+		if(n > 0)
+		{
+			f->pos = 0;
+			f->len = (uint32_t)n;
+			return 0;
+		}
+		if(n == 0)
+		{
+			f->flags |= __SEOF;
+			return EOF;
+		}
+		if(*__errno() != EAGAIN)
+		{
+			f->flags |= __SERR;
+			return EOF;
+		}
+		__flush(stdout); // a prompt goes out before the wait for its answer
+		if(poll(&(struct pollfd){ f->fd, POLLIN, 0 }, 1, -1) < 0)
+		{
+			f->flags |= __SERR;
+			return EOF;
+		}
+	}
+}
+
+int fgetc(FILE *f)
+{
+	int c;
+	__rdsetup(f);
+	if(f->unget >= 0)
+	{
+		c = f->unget;
+		f->unget = -1;
+		return c;
+	}
+	if(f->pos == f->len && __fill(f) == EOF) return EOF;
+	return f->buf[f->pos++];
+}
+
+int ungetc(int c, FILE *f)
+{
+	if(c == EOF) return EOF;
+	__rdsetup(f);
+	f->unget = (int16_t)(uint8_t)c;
+	f->flags &= ~__SEOF;
+	return (uint8_t)c;
+}
+
+int getchar(void)
+{
+	return fgetc(stdin);
+}
+
+char *fgets(char *s, int n, FILE *f)
+{
+	int i = 0, c = 0;
+	if(n <= 0) return NULL;
+	while(i < n - 1 && c != '\n')
+	{
+		c = fgetc(f);
+		if(c == EOF) break;
+		s[i++] = (char)c;
+	}
+	s[i] = '\0';
+	return i == 0 ? NULL : s;
+}
+
+size_t fread(void *p, size_t size, size_t n, FILE *f)
+{
+	uint8_t *d = (uint8_t*)p;
+	uint32_t total = (uint32_t)(size * n), got = 0;
+	if(total == 0) return 0;
+	__rdsetup(f);
+	if(f->unget >= 0)
+	{
+		d[got++] = (uint8_t)f->unget;
+		f->unget = -1;
+	}
+	while(got < total)
+	{
+		uint32_t k;
+		if(f->pos == f->len && __fill(f) == EOF) break;
+		k = f->len - f->pos;
+		if(k > total - got) k = total - got;
+		for(uint32_t i = 0; i < k; i++)
+			d[got + i] = f->buf[f->pos + i];
+		f->pos += k;
+		got += k;
+	}
+	return got / size;
+}
+
+/* printf */
+#define FL_LEFT     0x01U
+#define FL_PLUS     0x02U
+#define FL_SPACE    0x04U
+#define FL_ZERO     0x08U
+#define FL_ALT      0x10U
+
+static uint32_t __pad(FILE *f, int c, int n)
+{
+	for(int i = 0; i < n; i++)
+		fputc(c, f);
+	return n > 0 ? (uint32_t)n : 0;
+}
+
+/* head (sign, 0x), zeros, body, padded to width */
+static uint32_t __field(FILE *f, const char *head, uint32_t hlen, uint32_t zeros,
+	const char *body, uint32_t blen, int width, uint32_t flags)
+{
+	int fill = width - (int)(hlen + zeros + blen);
+	uint32_t n = 0;
+	if(!(flags & FL_LEFT) && !(flags & FL_ZERO)) n += __pad(f, ' ', fill);
+	for(uint32_t i = 0; i < hlen; i++) fputc(head[i], f);
+	if(!(flags & FL_LEFT) && (flags & FL_ZERO)) n += __pad(f, '0', fill);
+	n += __pad(f, '0', (int)zeros);
+	for(uint32_t i = 0; i < blen; i++) fputc(body[i], f);
+	if(flags & FL_LEFT) n += __pad(f, ' ', fill);
+	return n + hlen + blen;
+}
+
+/* digits of v, most significant first, at the end of buf[24]; returns the count */
+static uint32_t __digits(char *buf, uint64_t v, uint32_t base, const char *set)
+{
+	uint32_t n = 0;
+	while(v > 0xFFFFFFFFULL)
+	{
+		uint64_t q = __udiv64(v, base);
+		buf[23 - n++] = set[(uint32_t)(v - q * base)];
+		v = q;
+	}
+	for(uint32_t w = (uint32_t)v; w != 0; w /= base)
+		buf[23 - n++] = set[w % base];
+	return n;
+}
+
+static uint32_t __number(FILE *f, uint64_t v, uint8_t neg, uint32_t base, uint8_t upper,
+	uint32_t flags, int width, int prec)
+{
+	char buf[24], head[3];
+	const char *set = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+	uint32_t hlen = 0, len = __digits(buf, v, base, set), zeros = 0;
+	if(neg) head[hlen++] = '-';
+	else if(flags & FL_PLUS) head[hlen++] = '+';
+	else if(flags & FL_SPACE) head[hlen++] = ' ';
+	if((flags & FL_ALT) && base == 16 && v != 0)
+	{
+		head[hlen++] = '0';
+		head[hlen++] = upper ? 'X' : 'x';
+	}
+	if(prec < 0) prec = 1;
+	else flags &= ~FL_ZERO; // a precision turns the 0 flag off
+	if((uint32_t)prec > len) zeros = (uint32_t)prec - len;
+	if((flags & FL_ALT) && base == 8 && zeros == 0 && (len == 0 || buf[24 - len] != '0')) zeros = 1;
+	return __field(f, head, hlen, zeros, &buf[24 - len], len, width, flags);
+}
+
+static uint32_t __float(FILE *f, double v, uint32_t flags, int width, int prec)
+{
+	char buf[24], body[36], head[1];
+	uint32_t hlen = 0, blen = 0, len, scale = 1;
+	uint64_t ip;
+	uint32_t frac;
+	if(prec < 0) prec = 6;
+	if(prec > 9) prec = 9;
+	for(int i = 0; i < prec; i++) scale *= 10U;
+	if(v < 0)
+	{
+		head[hlen++] = '-';
+		v = -v;
+	}else if(flags & (FL_PLUS | FL_SPACE))
+	{
+		head[hlen++] = (flags & FL_PLUS) ? '+' : ' ';
+	}
+	v += 0.5 / (double)scale;
+	if(v >= 18446744073709551615.0) v = 18446744073709551615.0;
+	ip = (uint64_t)v;
+	frac = (uint32_t)((v - (double)ip) * (double)scale);
+	if(frac >= scale) frac = scale - 1U;
+	len = __digits(buf, ip, 10, "0123456789");
+	if(len == 0) body[blen++] = '0';
+	for(uint32_t i = 0; i < len; i++) body[blen++] = buf[24 - len + i];
+	if(prec > 0 || (flags & FL_ALT)) body[blen++] = '.';
+	for(int i = prec - 1; i >= 0; i--, frac /= 10U)
+		body[blen + (uint32_t)i] = (char)('0' + frac % 10U);
+	blen += (uint32_t)prec;
+	return __field(f, head, hlen, 0, body, blen, width, flags);
+}
+
+static int __vfprintf(FILE *f, const char *fmt, va_list ap)
+{
+	uint32_t n = 0;
+	while(*fmt)
+	{
+		uint32_t flags = 0;
+		int width = 0, prec = -1, lng = 0;
+		const char *s;
+		if(*fmt != '%')
+		{
+			fputc(*fmt++, f);
+			n++;
+			continue;
+		}
+		fmt++;
+		for(;; fmt++)
+		{
+			if(*fmt == '-') flags |= FL_LEFT;
+			else if(*fmt == '+') flags |= FL_PLUS;
+			else if(*fmt == ' ') flags |= FL_SPACE;
+			else if(*fmt == '0') flags |= FL_ZERO;
+			else if(*fmt == '#') flags |= FL_ALT;
+			else break;
+		}
+		if(*fmt == '*')
+		{
+			width = va_arg(ap, int);
+			if(width < 0)
+			{
+				flags |= FL_LEFT;
+				width = -width;
+			}
+			fmt++;
+		}
+		while(*fmt >= '0' && *fmt <= '9')
+			width = width * 10 + (*fmt++ - '0');
+		if(*fmt == '.')
+		{
+			fmt++;
+			prec = 0;
+			if(*fmt == '*')
+			{
+				prec = va_arg(ap, int);
+				fmt++;
+			}
+			while(*fmt >= '0' && *fmt <= '9')
+				prec = prec * 10 + (*fmt++ - '0');
+		}
+		if(flags & FL_LEFT) flags &= ~FL_ZERO;
+		/* lng: -2 hh, -1 h, 1 l, 2 ll, 3 z */
+		if(*fmt == 'h') { lng = -1; if(*++fmt == 'h') { lng = -2; fmt++; } }
+		else if(*fmt == 'l') { lng = 1; if(*++fmt == 'l') { lng = 2; fmt++; } }
+		else if(*fmt == 'z') { lng = 3; fmt++; }
+		switch(*fmt)
+		{
+		case 'd':
+		case 'i':
+		{
+			int64_t v;
+			if(lng == 2) v = va_arg(ap, long long);
+			else if(lng == 1) v = va_arg(ap, long);
+			else if(lng == 3) v = (int64_t)va_arg(ap, size_t);
+			else v = va_arg(ap, int);
+			if(lng == -1) v = (short)v;
+			if(lng == -2) v = (signed char)v;
+			n += __number(f, v < 0 ? (uint64_t)0 - (uint64_t)v : (uint64_t)v, v < 0, 10, 0, flags, width, prec);
+			break;
+		}
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'o':
+		{
+			uint64_t v;
+			if(lng == 2) v = va_arg(ap, unsigned long long);
+			else if(lng == 1) v = va_arg(ap, unsigned long);
+			else if(lng == 3) v = va_arg(ap, size_t);
+			else v = va_arg(ap, unsigned int);
+			if(lng == -1) v = (unsigned short)v;
+			if(lng == -2) v = (unsigned char)v;
+			n += __number(f, v, 0, *fmt == 'u' ? 10 : *fmt == 'o' ? 8 : 16, *fmt == 'X',
+				flags & ~(FL_PLUS | FL_SPACE), width, prec);
+			break;
+		}
+		case 'p':
+			n += __number(f, (uintptr_t)va_arg(ap, void*), 0, 16, 0, FL_ALT, width, prec);
+			break;
+		case 'f':
+		case 'F':
+			n += __float(f, va_arg(ap, double), flags, width, prec);
+			break;
+		case 'c':
+		{
+			char c = (char)va_arg(ap, int);
+			n += __field(f, NULL, 0, 0, &c, 1, width, flags & FL_LEFT);
+			break;
+		}
+		case 's':
+		{
+			uint32_t len = 0;
+			s = va_arg(ap, const char*);
+			if(s == NULL) s = "(null)";
+			while(s[len] && (prec < 0 || len < (uint32_t)prec)) len++;
+			n += __field(f, NULL, 0, 0, s, len, width, flags & FL_LEFT);
+			break;
+		}
+		case '%':
+			fputc('%', f);
+			n++;
+			break;
+		case '\0':
+			return (int)n;
+		default: // unknown conversion: printed as it stands
+			fputc('%', f);
+			fputc(*fmt, f);
+			n += 2;
+			break;
+		}
+		fmt++;
+	}
+	return (int)n;
+}
+
+int vfprintf(FILE *f, const char *fmt, va_list ap)
+{
+	int n;
+	if(f->mode == _IONBF && f->fd >= 0)
+	{
+		/* unbuffered still means one write per call, not one per character */
+		uint8_t buf[64];
+		FILE tmp = FILE_INIT(f->fd, buf, sizeof(buf), _IOFBF);
+		if(__flush(f) == EOF) return EOF;
+		n = __vfprintf(&tmp, fmt, ap);
+		if(__flush(&tmp) == EOF || ferror(&tmp))
+		{
+			f->flags |= __SERR;
+			return EOF;
+		}
+		return n;
+	}
+	n = __vfprintf(f, fmt, ap);
+	return ferror(f) ? EOF : n;
+}
+
+int fprintf(FILE *f, const char *fmt, ...)
+{
+	va_list ap;
+	int n;
+	va_start(ap, fmt);
+	n = vfprintf(f, fmt, ap);
+	va_end(ap);
+	return n;
+}
+
+int printf(const char *fmt, ...)
+{
+	va_list ap;
+	int n;
+	va_start(ap, fmt);
+	n = vfprintf(stdout, fmt, ap);
+	va_end(ap);
+	return n;
+}
+
+int vsnprintf(char *s, size_t n, const char *fmt, va_list ap)
+{
+	FILE mem = FILE_INIT(-1, s, n != 0 ? n - 1U : 0, _IOFBF);
+	int len;
+	mem.flags = __SWR;
+	if(n == 0) mem.buf = &mem.ch; // counts only
+	len = __vfprintf(&mem, fmt, ap);
+	if(n != 0) s[mem.pos] = '\0';
+	return len;
+}
+
+int snprintf(char *s, size_t n, const char *fmt, ...)
+{
+	va_list ap;
+	int len;
+	va_start(ap, fmt);
+	len = vsnprintf(s, n, fmt, ap);
+	va_end(ap);
+	return len;
+}
+
+/* scanf */
+typedef struct
+{
+	FILE *f;
+	uint32_t count;             /* characters consumed, for %n */
+}scan_in;
+
+static int __sget(scan_in *in)
+{
+	int c = fgetc(in->f);
+	if(c != EOF) in->count++;
+	return c;
+}
+
+static void __sunget(scan_in *in, int c)
+{
+	if(c == EOF) return;
+	ungetc(c, in->f);
+	in->count--;
+}
+
+static __inline int __isspace(int c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+/* the next character that is not white space, EOF at the end */
+static int __sskip(scan_in *in)
+{
+	int c;
+	do
+	{
+		c = __sget(in);
+	}while(c != EOF && __isspace(c));
+	return c;
+}
+
+static int __digit(int c, uint32_t base)
+{
+	int d = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 :
+		c >= 'A' && c <= 'F' ? c - 'A' + 10 : 99;
+	return d < (int)base ? d : -1;
+}
+
+static void __store(void *p, int lng, uint64_t v)
+{
+	if(lng == -2) *(signed char*)p = (signed char)v;
+	else if(lng == -1) *(short*)p = (short)v;
+	else if(lng == 1) *(long*)p = (long)v;
+	else if(lng == 2) *(long long*)p = (long long)v;
+	else *(int*)p = (int)v;
+}
+
+int vfscanf(FILE *f, const char *fmt, va_list ap)
+{
+	scan_in in = { f, 0 };
+	int assigned = 0, c;
+	while(*fmt)
+	{
+		int skip = 0, lng = 0;
+		uint32_t width = 0;
+		if(__isspace(*fmt))
+		{
+			while(__isspace(*fmt)) fmt++;
+			__sunget(&in, __sskip(&in));
+			continue;
+		}
+		if(*fmt != '%' || fmt[1] == '%')
+		{
+			if(*fmt == '%') fmt++;
+			c = __sget(&in);
+			if(c != *fmt)
+			{
+				__sunget(&in, c);
+				return c == EOF && assigned == 0 ? EOF : assigned;
+			}
+			fmt++;
+			continue;
+		}
+		fmt++;
+		if(*fmt == '*')
+		{
+			skip = 1;
+			fmt++;
+		}
+		while(*fmt >= '0' && *fmt <= '9')
+			width = width * 10U + (uint32_t)(*fmt++ - '0');
+		if(*fmt == 'h') { lng = -1; if(*++fmt == 'h') { lng = -2; fmt++; } }
+		else if(*fmt == 'l') { lng = 1; if(*++fmt == 'l') { lng = 2; fmt++; } }
+		switch(*fmt++)
+		{
+		case 'n':
+			if(!skip) __store(va_arg(ap, void*), lng, in.count);
+			break;
+		case 'c':
+		{
+			char *p = skip ? NULL : va_arg(ap, char*);
+			if(width == 0) width = 1;
+			for(uint32_t i = 0; i < width; i++)
+			{
+				c = __sget(&in);
+				if(c == EOF) return assigned == 0 ? EOF : assigned;
+				if(p != NULL) p[i] = (char)c;
+			}
+			if(!skip) assigned++;
+			break;
+		}
+		case 's':
+		{
+			char *p = skip ? NULL : va_arg(ap, char*);
+			uint32_t i = 0;
+			c = __sskip(&in);
+			if(c == EOF) return assigned == 0 ? EOF : assigned;
+			while(c != EOF && !__isspace(c) && (width == 0 || i < width))
+			{
+				if(p != NULL) p[i] = (char)c;
+				i++;
+				c = width == 0 || i < width ? __sget(&in) : EOF;
+			}
+			if(c != EOF) __sunget(&in, c);
+			if(p != NULL)
+			{
+				p[i] = '\0';
+				assigned++;
+			}
+			break;
+		}
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'o':
+		{
+			char conv = fmt[-1];
+			uint32_t base = conv == 'o' ? 8U : (conv == 'x' || conv == 'X') ? 16U : 10U, nd = 0, i = 0;
+			uint64_t v = 0;
+			uint8_t neg = 0;
+			int d;
+			if(width == 0) width = 0xFFFFFFFFUL;
+			c = __sskip(&in);
+			if(c == EOF) return assigned == 0 ? EOF : assigned;
+			if((c == '-' || c == '+') && i < width)
+			{
+				neg = c == '-';
+				c = ++i < width ? __sget(&in) : EOF;
+			}
+			if(conv == 'i' && c == '0' && i < width)
+			{
+				/* 0x... hex, 0... octal; the 0 is a digit in either case */
+				nd = 1;
+				base = 8;
+				c = ++i < width ? __sget(&in) : EOF;
+				if((c == 'x' || c == 'X') && i < width)
+				{
+					base = 16;
+					nd = 0;
+					c = ++i < width ? __sget(&in) : EOF;
+				}
+			}
+			while(i < width && (d = __digit(c, base)) >= 0)
+			{
+				v = v * base + (uint32_t)d;
+				nd++;
+				c = ++i < width ? __sget(&in) : EOF;
+			}
+			__sunget(&in, c);
+			if(nd == 0) return assigned; // matching failure
+			if(!skip)
+			{
+				__store(va_arg(ap, void*), lng, neg ? (uint64_t)0 - v : v);
+				assigned++;
+			}
+			break;
+		}
+		default:
+			return assigned;
+		}
+	}
+	return assigned;
+}
+
+int fscanf(FILE *f, const char *fmt, ...)
+{
+	va_list ap;
+	int n;
+	va_start(ap, fmt);
+	n = vfscanf(f, fmt, ap);
+	va_end(ap);
+	return n;
+}
+
+int scanf(const char *fmt, ...)
+{
+	va_list ap;
+	int n;
+	va_start(ap, fmt);
+	n = vfscanf(stdin, fmt, ap);
+	va_end(ap);
+	return n;
+}
+
+int sscanf(const char *s, const char *fmt, ...)
+{
+	FILE mem = FILE_INIT(-1, s, __slen(s), _IOFBF);
+	va_list ap;
+	int n;
+	mem.flags = __SRD;
+	mem.len = mem.size;
+	va_start(ap, fmt);
+	n = vfscanf(&mem, fmt, ap);
+	va_end(ap);
+	return n;
+}
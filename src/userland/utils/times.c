@@ -29,5 +29,48 @@
  */
  
 #include <times.h>
-/* Define you function details here */
+#include <kdata.h>
+#include <kmain.h>
+
+#define BCD2(v, pos)    ((((v) >> ((pos) + 4)) & 0xFU) * 10U + (((v) >> (pos)) & 0xFU))
+
+uint32_t __time(uint32_t *sec, uint32_t *nsec)
+{
+	uint32_t ticks = kdata_ticks();
+	uint32_t s = ticks / TICK_HZ;
+	if(sec != NULL) *sec = s;
+	if(nsec != NULL) *nsec = (ticks % TICK_HZ) * KDATA->us_per_tick * 1000U;
+	return s;
+}
+
+uint32_t get_ticks(void)
+{
+	return kdata_ticks();
+}
+
+uint64_t get_time_us(void)
+{
+	return kdata_us();
+}
+
+int32_t get_walltime(walltime *wt)
+{
+	uint32_t s, valid, tr, dr;
+	do
+	{
+		s = kdata_read_begin();
+		valid = KDATA->rtc_valid;
+		tr = KDATA->rtc_time;
+		dr = KDATA->rtc_date;
+	}while(kdata_read_retry(s));
+	if(!valid) return -1;
+	wt->sec = (uint8_t)BCD2(tr & 0x7FU, 0);
+	wt->min = (uint8_t)BCD2(tr & 0x7F00U, 8);
+	wt->hour = (uint8_t)BCD2(tr & 0x3F0000U, 16);
+	wt->day = (uint8_t)BCD2(dr & 0x3FU, 0);
+	wt->month = (uint8_t)BCD2(dr & 0x1F00U, 8);
+	wt->weekday = (uint8_t)((dr >> 13) & 0x7U);
+	wt->year = (uint16_t)(2000U + BCD2(dr, 16));
+	return 0;
+}
 
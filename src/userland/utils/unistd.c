@@ -29,5 +29,67 @@
  */
  
 #include <unistd.h>
+#include <fcntl.h>
+#include <kdata.h>
+#include <syscall.h>
 /* Write your highlevel I/O details */
 
+uint32_t getpid(void)
+{
+	return kdata_pid();
+}
+
+int32_t read(int32_t fd, void *buf, uint32_t len)
+{
+	return (int32_t)SYSCALL3(SYS_read, fd, buf, len);
+}
+
+int32_t write(int32_t fd, const void *buf, uint32_t len)
+{
+	return (int32_t)SYSCALL3(SYS_write, fd, buf, len);
+}
+
+int32_t pread(int32_t fd, void *buf, uint32_t len, uint32_t off)
+{
+	return (int32_t)SYSCALL(SYS_pread, fd, buf, len, off);
+}
+
+int32_t pwrite(int32_t fd, const void *buf, uint32_t len, uint32_t off)
+{
+	return (int32_t)SYSCALL(SYS_pwrite, fd, buf, len, off);
+}
+
+int32_t lseek(int32_t fd, int32_t off, uint32_t whence)
+{
+	return (int32_t)SYSCALL3(SYS_lseek, fd, off, whence);
+}
+
+int32_t close(int32_t fd)
+{
+	return (int32_t)SYSCALL1(SYS_close, fd);
+}
+
+int32_t dup(int32_t fd)
+{
+	return (int32_t)SYSCALL1(SYS_dup, fd);
+}
+
+int32_t dup2(int32_t fd, int32_t fd2)
+{
+	return (int32_t)SYSCALL2(SYS_dup2, fd, fd2);
+}
+
+int32_t ioctl(int32_t fd, uint32_t req, void *arg)
+{
+	return (int32_t)SYSCALL3(SYS_ioctl, fd, req, arg);
+}
+
+int32_t open(const char *path, uint32_t flags)
+{
+	return (int32_t)SYSCALL2(SYS_open, path, flags);
+}
+
+int32_t msleep(uint32_t ms)
+{
+	return (int32_t)SYSCALL2(SYS_nanosleep, ms / 1000U, (ms % 1000U) * 1000000U);
+}